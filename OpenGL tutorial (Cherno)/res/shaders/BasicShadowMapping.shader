@@ -38,6 +38,9 @@ void main() {
 #shader fragment
 #version 330 core
 
+#include "include/Lighting.glsl"
+#include "include/Shadows.glsl"
+
 out vec4 FragColour;
 
 uniform vec3 viewPos;
@@ -57,50 +60,9 @@ struct Material {
 };
 uniform Material u_Material;
 
-struct PointLight {
-	bool isActive;
-	vec3 position;
-
-	vec3 ambient;
-	vec3 diffuse;
-	vec3 specular;
-
-	// Implementing attenuation: f_att = 1.0 / (constant + linear*distance + quadratic*distance^2)
-	float constant;
-	float linear;
-	float quadratic;
-};
-#define MAX_NUM_POINT_LIGHTS 100
 uniform int numPointLights;
 uniform PointLight pointLights[MAX_NUM_POINT_LIGHTS];
-
-struct SpotLight {
-	bool on;
-	vec3 position;
-	vec3 direction;
-
-	vec3 ambient;
-	vec3 diffuse;
-	vec3 specular;
-
-	// Attenuation variables
-	float constant;
-	float linear;
-	float quadratic;
-
-	// Angle of spotlight
-	float cutOff;
-	float outerCutOff;
-};
 uniform SpotLight u_Flashlight;
-
-struct DirLight {
-	vec3 direction;
-
-	vec3 ambient;
-	vec3 diffuse;
-	vec3 specular;
-};
 uniform DirLight u_DirLight;
 
 in VS_OUT{
@@ -111,13 +73,6 @@ in VS_OUT{
 	vec4 FragPosLightSpacePerspective;
 } fs_in;
 
-// Function declarations
-vec3 CalcPointLight(PointLight pointLight, vec3 normal, vec3 fragPos, vec3 viewDir, bool blinnPhongEnabled, float shadow);
-vec3 CalcSpotLight(vec3 normal, vec3 fragPos, vec3 viewDir, float shadow);
-vec3 CalcDirLight(DirLight dirLight, vec3 normal, vec3 viewDir, float shadow);
-float ShadowCalculationOrthographic(DirLight dirLight, vec4 FragPosLightSpaceOrthographic, vec3 normal);
-float ShadowCalculationPerspective(vec4 FragPosLightSpacePerspective, vec3 normal);
-
 void main() {
 
 	// Phong lighting (using directional, point lights, spotlights)
@@ -125,25 +80,28 @@ void main() {
 	vec3 norm = normalize(fs_in.Normal);
 	vec3 viewDir = normalize(viewPos - fs_in.FragPosition);
 	vec3 result = vec3(0.0f);
+	Surface surface = Surface(texture(u_Material.diffuse, fs_in.TexCoords).rgb, u_Material.specular, u_Material.shininess);
 
 	// Shadow mapping calculation
 	float orthographicShadow = 1.0;
 	if (u_UsingOrthographicShadowMapping)
 	{
-		orthographicShadow -= ShadowCalculationOrthographic(u_DirLight, fs_in.FragPosLightSpaceOrthographic, norm);
+		float bias = max(0.08 * (1.0 - dot(norm, u_DirLight.direction)), 0.007);
+		orthographicShadow -= ShadowCalculationPCF(shadowMapOrthographic, fs_in.FragPosLightSpaceOrthographic, bias);
 		// Directional lighting
-		result += CalcDirLight(u_DirLight, norm, viewDir, orthographicShadow);
+		result += CalcDirLight(u_DirLight, surface, norm, viewDir, orthographicShadow);
 	}
 	float perspectiveShadow = 1.0;
 	if (u_UsingPerspectiveShadowMapping)
 	{
-		perspectiveShadow -= ShadowCalculationPerspective(fs_in.FragPosLightSpacePerspective, norm);
+		// No bias needed for perspective projection
+		perspectiveShadow -= ShadowCalculationPCF(shadowMapPerspective, fs_in.FragPosLightSpacePerspective, 0.0);
 		// Flashlight (spot light)
-		result += CalcSpotLight(norm, fs_in.FragPosition, viewDir, perspectiveShadow);
+		result += CalcSpotLight(u_Flashlight, surface, norm, fs_in.FragPosition, viewDir, perspectiveShadow);
 		// Point lights
 		//for (int i = 0; i < numPointLights; i++) {
 		//	if (pointLights[i].isActive)
-		//		result += CalcPointLight(pointLights[i], norm, fs_in.FragPosition, viewDir, true, perspectiveShadow);
+		//		result += CalcPointLight(pointLights[i], surface, norm, fs_in.FragPosition, viewDir, true, perspectiveShadow);
 		//}
 	}
 
@@ -154,158 +112,3 @@ void main() {
 	// Set fragment colour to combined result
 	FragColour = vec4(result, 1.0);
 }
-
-float ShadowCalculationOrthographic(DirLight dirLight, vec4 fragPosLightSpace, vec3 normal)
-{
-	// Perform perspective division
-	// (not neccesary for orthographic projection)
-	vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
-	// Depth map is in the range [0,1] and projCoords is in NDC which is [-1,1]
-	projCoords = projCoords * 0.5 + 0.5;
-	// Get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-	float closestDepth = texture(shadowMapOrthographic, projCoords.xy).r;
-	// Get depth of current fragment from light's perspective
-	float currentDepth = projCoords.z;
-	// Check whether current fragment is in shadow
-	float bias = max(0.08 * (1.0 - dot(normal, dirLight.direction)), 0.007);
-	//float shadow = currentDepth - bias > closestDepth ? 1.0 : 0.0;
-	// PCF (Percentage-closer filtering)
-	// Takes average of nearest depth buffer locations for smoother shadow edges
-	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(shadowMapOrthographic, 0);
-	for (int x = -1; x <= 1; ++x)
-	{
-		for (int y = -1; y <= 1; ++y)
-		{
-			float pcfDepth = texture(shadowMapOrthographic, projCoords.xy + vec2(x, y) * texelSize).r;
-			shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
-		}
-	}
-	shadow /= 9.0;
-
-	if (projCoords.z > 1.0)
-		shadow = 0.0;
-	return shadow;
-}
-
-float ShadowCalculationPerspective(vec4 fragPosLightSpace, vec3 normal)
-{
-	// Perform perspective division
-	// (not neccesary for orthographic projection)
-	vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
-	// Depth map is in the range [0,1] and projCoords is in NDC which is [-1,1]
-	projCoords = projCoords * 0.5 + 0.5;
-	// Get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-	float closestDepth = texture(shadowMapPerspective, projCoords.xy).r;
-	// Get depth of current fragment from light's perspective
-	float currentDepth = projCoords.z;
-	// Check whether current fragment is in shadow
-	float bias = 0.0; // for perspective projection
-	//float shadow = currentDepth - bias > closestDepth ? 1.0 : 0.0;
-	// PCF (Percentage-closer filtering)
-	// Takes average of nearest depth buffer locations for smoother shadow edges
-	float shadow = 0.0;
-	vec2 texelSize = 1.0 / textureSize(shadowMapPerspective, 0);
-	for (int x = -1; x <= 1; ++x)
-	{
-		for (int y = -1; y <= 1; ++y)
-		{
-			float pcfDepth = texture(shadowMapPerspective, projCoords.xy + vec2(x, y) * texelSize).r;
-			shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
-		}
-	}
-	shadow /= 9.0;
-
-	if (projCoords.z > 1.0)
-		shadow = 0.0;
-	return shadow;
-}
-
-vec3 CalcDirLight(DirLight dirLight, vec3 normal, vec3 viewDir, float shadow)
-{
-	// Ambient
-	vec3 ambient = dirLight.ambient * vec3(texture(u_Material.diffuse, fs_in.TexCoords));
-	//
-	// Diffuse 
-	vec3 lightDir = dirLight.direction;
-	float diff = max(dot(normal, lightDir), 0.0);
-	vec3 diffuse = dirLight.diffuse * diff * vec3(texture(u_Material.diffuse, fs_in.TexCoords));
-	// Specular
-	vec3 reflectDir = reflect(-lightDir, normal);
-	float spec = pow(max(dot(viewDir, reflectDir), 0.0), u_Material.shininess);
-	vec3 specular = (spec * u_Material.specular) * dirLight.specular;
-
-	// Combine 
-	return (ambient + (diffuse * shadow) + (specular * shadow));
-}
-
-vec3 CalcPointLight(PointLight pointLight, vec3 normal, vec3 fragPos, vec3 viewDir, bool blinnPhongEnabled, float shadow)
-{
-	// Ambient
-	vec3 ambient = pointLight.ambient * vec3(texture(u_Material.diffuse, fs_in.TexCoords));
-	//
-	// Diffuse 
-	vec3 lightDir = normalize(pointLight.position - fragPos);
-	float diff = max(dot(normal, lightDir), 0.0);
-	vec3 diffuse = pointLight.diffuse * diff * vec3(texture(u_Material.diffuse, fs_in.TexCoords));
-	//
-	float spec = 0.0;
-	if (blinnPhongEnabled) {
-		// Blinn-Phong model specular correction
-		vec3 halfwayDir = normalize(lightDir + viewDir);
-		spec = pow(max(dot(normal, halfwayDir), 0.0), u_Material.shininess);
-	}
-	else {
-		// Specular (regular Phong model style)
-		vec3 reflectDir = reflect(-lightDir, normal);
-		spec = pow(max(dot(viewDir, reflectDir), 0.0), u_Material.shininess);
-	}
-	vec3 specular = pointLight.specular * spec * u_Material.specular;
-
-	// Attenuation
-	float distance = length(pointLight.position - fragPos);
-	float attenuation = 1.0 / (pointLight.constant + pointLight.linear * distance + pointLight.quadratic * (distance * distance));
-	ambient *= attenuation;
-	diffuse *= attenuation;
-	specular *= attenuation;
-	// Combine 
-	return (ambient + (diffuse * shadow) + (specular * shadow));
-
-}
-
-vec3 CalcSpotLight(vec3 norm, vec3 FragPos, vec3 viewDir, float shadow)
-{
-	// Flashlight
-	// 
-	vec3 fl_ambient = vec3(0.0f);
-	vec3 fl_diffuse = vec3(0.0f);
-	vec3 fl_specular = vec3(0.0f);
-	// Compare light angle to cutOff
-	if (u_Flashlight.on) {
-		vec3 flashlightDir = normalize(u_Flashlight.position - FragPos);
-		// flashlight ambient
-		fl_ambient = u_Flashlight.ambient * vec3(texture(u_Material.diffuse, fs_in.TexCoords));
-		// flashlight diffuse 
-		float fl_diff = max(0.0, dot(norm, flashlightDir));
-		fl_diffuse = u_Flashlight.diffuse * fl_diff * vec3(texture(u_Material.diffuse, fs_in.TexCoords));
-		// flashlight specular 
-		vec3 fl_reflectDir = reflect(-flashlightDir, norm);
-		float fl_spec = pow(max(dot(viewDir, fl_reflectDir), 0.0), u_Material.shininess);
-		fl_specular = (fl_spec * u_Material.specular) * u_Flashlight.specular;
-		// Flashlight attenuation
-		float flashlightDistance = length(u_Flashlight.position - FragPos);
-		float fl_attenuation = 2.6 / (u_Flashlight.constant + u_Flashlight.linear * flashlightDistance + u_Flashlight.quadratic * (flashlightDistance * flashlightDistance));
-		fl_ambient *= fl_attenuation;
-		fl_diffuse *= fl_attenuation;
-		fl_specular *= fl_attenuation;
-		// Smooth flashlight edge transition
-		float theta = dot(flashlightDir, normalize(-u_Flashlight.direction));
-		float epsilon = u_Flashlight.cutOff - u_Flashlight.outerCutOff;
-		float fl_intensity = clamp((theta - u_Flashlight.outerCutOff) / epsilon, 0.0, 1.0);
-		fl_ambient *= fl_intensity;
-		fl_diffuse *= fl_intensity;
-		fl_specular *= fl_intensity;
-	}
-	// Combine 
-	return (fl_ambient + (fl_diffuse * shadow) + (fl_specular * shadow));
-}
\ No newline at end of file
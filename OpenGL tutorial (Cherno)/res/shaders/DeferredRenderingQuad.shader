@@ -19,7 +19,6 @@ in vec2 v_TexCoords;
 uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
-uniform vec3 viewPos;
 
 out vec4 FragColour;
 
@@ -30,8 +29,21 @@ struct PointLight {
     float Linear;
     float Quadratic;
 };
-const int NUM_POINTLIGHTS = 200;
-uniform PointLight pointLights[NUM_POINTLIGHTS];
+const int NUM_POINTLIGHTS = 256; // MAX_POINT_LIGHTS in FrameUniforms.h
+
+// Shared per-frame camera and light data (see FrameUniforms.h)
+layout(std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 proj;
+    vec4 viewPos;
+};
+
+layout(std140) uniform LightBlock
+{
+    PointLight pointLights[NUM_POINTLIGHTS];
+    int numPointLights;
+};
 
 void main()
 {
@@ -44,8 +56,8 @@ void main()
 
     // Then use to calculate the lighting as usual
     vec3 lighting = Diffuse * 0.1; // hard-coded ambient component
-    vec3 viewDir = normalize(viewPos - FragPos);
-    for (int i = 0; i < NUM_POINTLIGHTS; ++i)
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
+    for (int i = 0; i < numPointLights; ++i)
     {
         // diffuse
         vec3 lightDir = normalize(pointLights[i].Position - FragPos);
@@ -1,26 +1,39 @@
 #shader vertex
 #version 330 core
-layout(location = 0) in vec3 a_Position;
-layout(location = 1) in vec3 a_Normal;
-layout(location = 2) in vec2 a_TextureCoords;
+#include "include/Vertex.glsl"
+#ifdef TEXTURE_ARRAY
+// Layer of the model's texture array (see Model::UseTextureArray and MESH_TEXTURE_LAYER_LOCATION)
+layout(location = 7) in float a_TextureLayer;
+flat out float TextureLayer;
+#endif
 
 out vec2 TexCoords;
 out vec3 Normal;
 out vec3 FragPosition;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 proj;
+
+// Shared per-frame camera data (see FrameUniforms.h)
+layout(std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 proj;
+	vec4 viewPos;
+};
 
 void main() {
 	// TODO: should pass this as a uniform to optimize (costly to perform matrix inverse in shaders)
 	mat3 normalMatrix = mat3(transpose(inverse(model)));
-	Normal = normalMatrix * a_Normal;
+	Normal = normalMatrix * GetVertexNormal();
 	
 	// Want to pass FragPosition in world coordinates for lighting purposes
-	FragPosition = (model * vec4(a_Position, 1.0)).xyz;
-	TexCoords = a_TextureCoords;
-	gl_Position = proj * view * model * vec4(a_Position, 1.0);
+	vec3 position = GetVertexPosition();
+	FragPosition = (model * vec4(position, 1.0)).xyz;
+	TexCoords = GetVertexTexCoords();
+#ifdef TEXTURE_ARRAY
+	TextureLayer = a_TextureLayer;
+#endif
+	gl_Position = proj * view * model * vec4(position, 1.0);
 }
 
 
@@ -35,7 +48,12 @@ in vec3 FragPosition;
 in vec2 TexCoords;
 in vec3 Normal;
 
+#ifdef TEXTURE_ARRAY
+flat in float TextureLayer;
+uniform sampler2DArray texture_diffuse_array;
+#else
 uniform sampler2D texture_diffuse0;
+#endif
 uniform sampler2D texture_specular0;
 
 void main()
@@ -45,7 +63,11 @@ void main()
 	// Store the per-fragment normals into the second gbuffer texture
 	gNormal = normalize(Normal);
 	// Store the diffuse per-fragment colour into the rgb components of the third gbuffer texture
+#ifdef TEXTURE_ARRAY
+	gAlbedoSpec.rgb = texture(texture_diffuse_array, vec3(TexCoords, TextureLayer)).rgb;
+#else
 	gAlbedoSpec.rgb = texture(texture_diffuse0, TexCoords).rgb;
+#endif
 	// Store specular intensity in gAlbedoSpec's alpha component
 	gAlbedoSpec.a = texture(texture_specular0, TexCoords).r;
 
@@ -9,8 +9,14 @@ out vec3 Normal;
 out vec3 FragPosition;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 proj;
+
+// Shared per-frame camera data (see FrameUniforms.h)
+layout(std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 proj;
+	vec4 viewPos;
+};
 
 void main() {
 	// TODO: should pass this as a uniform to optimize (costly to perform matrix inverse in shaders)
@@ -18,10 +24,10 @@ void main() {
 	Normal = normalMatrix * a_Normal;
 
 	// Want to pass FragPosition in view space since SSAO is a screen-space algorithm
-	vec4 viewPos = view * model * vec4(a_Position, 1.0);
-	FragPosition = viewPos.xyz;
+	vec4 viewSpacePosition = view * model * vec4(a_Position, 1.0);
+	FragPosition = viewSpacePosition.xyz;
 	TexCoords = a_TextureCoords;
-	gl_Position = proj * viewPos;
+	gl_Position = proj * viewSpacePosition;
 }
 
 
@@ -39,6 +39,9 @@ void main()
 
 #shader fragment
 #version 330 core
+
+#include "include/NormalMaps.glsl"
+
 out vec4 FragColour;
 
 in VS_OUT{
@@ -54,7 +57,6 @@ uniform sampler2D normalMap;
 uniform sampler2D depthMap;
 
 uniform float height_scale;
-uniform bool u_UsingParallaxMapping;
 
 vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir);
 
@@ -62,11 +64,12 @@ void main()
 {
     // Offset texture coordinates using Parallax Mapping
     vec3 viewDir = normalize(fs_in.TangentViewPos - fs_in.TangentFragPos);
-    vec2 texCoords;
-    if(u_UsingParallaxMapping)
-        texCoords = ParallaxMapping(fs_in.TexCoords, viewDir);
-    else
-        texCoords = fs_in.TexCoords;
+    // Parallax mapping is a compile time variant (PARALLAX keyword) rather than a uniform bool
+#ifdef PARALLAX
+    vec2 texCoords = ParallaxMapping(fs_in.TexCoords, viewDir);
+#else
+    vec2 texCoords = fs_in.TexCoords;
+#endif
     if (texCoords.x > 1.0 || texCoords.y > 1.0 || texCoords.x < 0.0 || texCoords.y < 0.0)
         discard;
     //vec2 texCoords = fs_in.TexCoords;
@@ -75,7 +78,7 @@ void main()
     vec3 diffuse = texture(diffuseMap, texCoords).rgb;
 
     // Get normal from normal map then scale within range [-1.0, 1.0]
-    vec3 normal = texture(normalMap, texCoords).rgb;
+    vec3 normal = SampleNormalMap(normalMap, texCoords);
     normal = normalize(normal * 2.0 - 1.0);
 
     //FragColour = vec4(diffuse, 1.0);
@@ -0,0 +1,139 @@
+// Light types and the Phong/Blinn-Phong lighting shared by the forward lit shaders.
+// The light functions take the surface's already sampled colours, so the diffuse map is read once per fragment
+// rather than once per light term.
+
+struct PointLight {
+	bool isActive;
+	vec3 position;
+
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+
+	// Implementing attenuation: f_att = 1.0 / (constant + linear*distance + quadratic*distance^2)
+	float constant;
+	float linear;
+	float quadratic;
+};
+#define MAX_NUM_POINT_LIGHTS 100
+
+struct SpotLight {
+	bool on;
+	vec3 position;
+	vec3 direction;
+
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+
+	// Attenuation variables
+	float constant;
+	float linear;
+	float quadratic;
+
+	// Angle of spotlight
+	float cutOff;
+	float outerCutOff;
+};
+
+struct DirLight {
+	vec3 direction;
+
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+};
+
+struct Surface {
+	vec3 albedo;		// Diffuse colour
+	vec3 specular;
+	float shininess;
+};
+
+// 'shadow' is the fraction of light reaching the fragment (1.0 = fully lit), ambient light ignores it
+vec3 CalcDirLight(DirLight dirLight, Surface surface, vec3 normal, vec3 viewDir, float shadow)
+{
+	// Ambient
+	vec3 ambient = dirLight.ambient * surface.albedo;
+	//
+	// Diffuse 
+	vec3 lightDir = dirLight.direction;
+	float diff = max(dot(normal, lightDir), 0.0);
+	vec3 diffuse = dirLight.diffuse * diff * surface.albedo;
+	// Specular
+	vec3 reflectDir = reflect(-lightDir, normal);
+	float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
+	vec3 specular = (spec * surface.specular) * dirLight.specular;
+
+	// Combine 
+	return (ambient + (diffuse * shadow) + (specular * shadow));
+}
+
+vec3 CalcPointLight(PointLight pointLight, Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir, bool blinnPhongEnabled, float shadow)
+{
+	// Ambient
+	vec3 ambient = pointLight.ambient * surface.albedo;
+	//
+	// Diffuse 
+	vec3 lightDir = normalize(pointLight.position - fragPos);
+	float diff = max(dot(normal, lightDir), 0.0);
+	vec3 diffuse = pointLight.diffuse * diff * surface.albedo;
+	//
+	float spec = 0.0;
+	if (blinnPhongEnabled) {
+		// Blinn-Phong model specular correction
+		vec3 halfwayDir = normalize(lightDir + viewDir);
+		spec = pow(max(dot(normal, halfwayDir), 0.0), surface.shininess);
+	} else {
+		// Specular (regular Phong model style)
+		vec3 reflectDir = reflect(-lightDir, normal);
+		spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
+	}
+	vec3 specular = pointLight.specular * spec * surface.specular;
+
+	// Attenuation
+	float distance = length(pointLight.position - fragPos);
+	float attenuation = 1.0 / (pointLight.constant + pointLight.linear * distance + pointLight.quadratic * (distance * distance));
+	ambient *= attenuation;
+	diffuse *= attenuation;
+	specular *= attenuation;
+	// Combine 
+	return (ambient + (diffuse * shadow) + (specular * shadow));
+}
+
+vec3 CalcSpotLight(SpotLight spotLight, Surface surface, vec3 norm, vec3 FragPos, vec3 viewDir, float shadow)
+{
+	// Flashlight
+	// 
+	vec3 fl_ambient = vec3(0.0f);
+	vec3 fl_diffuse = vec3(0.0f);
+	vec3 fl_specular = vec3(0.0f);
+	// Compare light angle to cutOff
+	if (spotLight.on) {
+		vec3 flashlightDir = normalize(spotLight.position - FragPos);
+		// flashlight ambient
+		fl_ambient = spotLight.ambient * surface.albedo;
+		// flashlight diffuse 
+		float fl_diff = max(0.0, dot(norm, flashlightDir));
+		fl_diffuse = spotLight.diffuse * fl_diff * surface.albedo;
+		// flashlight specular 
+		vec3 fl_reflectDir = reflect(-flashlightDir, norm);
+		float fl_spec = pow(max(dot(viewDir, fl_reflectDir), 0.0), surface.shininess);
+		fl_specular = (fl_spec * surface.specular) * spotLight.specular;
+		// Flashlight attenuation
+		float flashlightDistance = length(spotLight.position - FragPos);
+		float fl_attenuation = 2.6 / (spotLight.constant + spotLight.linear * flashlightDistance + spotLight.quadratic * (flashlightDistance * flashlightDistance));
+		fl_ambient *= fl_attenuation;
+		fl_diffuse *= fl_attenuation;
+		fl_specular *= fl_attenuation;
+		// Smooth flashlight edge transition
+		float theta = dot(flashlightDir, normalize(-spotLight.direction));
+		float epsilon = spotLight.cutOff - spotLight.outerCutOff;
+		float fl_intensity = clamp((theta - spotLight.outerCutOff) / epsilon, 0.0, 1.0);
+		fl_ambient *= fl_intensity;
+		fl_diffuse *= fl_intensity;
+		fl_specular *= fl_intensity;
+	}
+	// Combine 
+	return (fl_ambient + (fl_diffuse * shadow) + (fl_specular * shadow));
+}
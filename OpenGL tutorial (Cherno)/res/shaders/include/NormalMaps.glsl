@@ -0,0 +1,10 @@
+// Normal map lookups shared by the normal mapping shaders.
+// Cooked normal maps only keep X and Y (BC5), so Z is always rebuilt from them, which also works for plain RGB maps.
+
+// Returns the tangent space normal encoded in [0,1] like an RGB normal map (callers still apply * 2.0 - 1.0)
+vec3 SampleNormalMap(sampler2D normalMap, vec2 texCoords)
+{
+	vec2 xy = texture(normalMap, texCoords).rg * 2.0 - 1.0;
+	float z = sqrt(max(1.0 - dot(xy, xy), 0.0));
+	return vec3(xy, z) * 0.5 + 0.5;
+}
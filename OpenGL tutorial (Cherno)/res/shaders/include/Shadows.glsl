@@ -0,0 +1,38 @@
+// Shadow map lookups shared by the shadow mapping shaders.
+// The PCF kernel is (2 * PCF_RADIUS + 1)^2 taps: 3x3 by default, 5x5 with the PCF_5x5 keyword.
+
+#ifndef PCF_RADIUS
+#ifdef PCF_5x5
+#define PCF_RADIUS 2
+#else
+#define PCF_RADIUS 1
+#endif
+#endif
+
+// Returns how much of the fragment is in shadow (1.0 = fully shadowed)
+float ShadowCalculationPCF(sampler2D shadowMap, vec4 fragPosLightSpace, float bias)
+{
+	// Perform perspective division
+	// (not neccesary for orthographic projection)
+	vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+	// Depth map is in the range [0,1] and projCoords is in NDC which is [-1,1]
+	projCoords = projCoords * 0.5 + 0.5;
+	// Beyond the light's far plane, don't bother sampling
+	if (projCoords.z > 1.0)
+		return 0.0;
+	// Get depth of current fragment from light's perspective
+	float currentDepth = projCoords.z;
+	// PCF (Percentage-closer filtering)
+	// Takes average of nearest depth buffer locations for smoother shadow edges
+	float shadow = 0.0;
+	vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+	for (int x = -PCF_RADIUS; x <= PCF_RADIUS; ++x)
+	{
+		for (int y = -PCF_RADIUS; y <= PCF_RADIUS; ++y)
+		{
+			float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+			shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
+		}
+	}
+	return shadow / float((2 * PCF_RADIUS + 1) * (2 * PCF_RADIUS + 1));
+}
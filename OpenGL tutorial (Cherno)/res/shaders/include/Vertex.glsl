@@ -0,0 +1,74 @@
+// Mesh vertex attributes in either of its formats (see MeshVertexFormat in Vertex.h), read through the GetVertex*()
+// functions so the rest of the vertex shader is the same for both. Shaders drawing MESH_VERTEX_COMPACT meshes are
+// built with COMPACT_VERTEX, which decodes the quantized attributes (Mesh sets u_MeshDequantize for each draw).
+// Define VERTEX_TANGENTS before including this to read the tangent frame too.
+
+#ifdef COMPACT_VERTEX
+layout(location = 0) in vec4 a_Position;		// Unsigned normalized within the mesh's bounding cube
+layout(location = 1) in vec2 a_Normal;			// Octahedral
+layout(location = 2) in vec2 a_TextureCoords;	// Half floats
+
+uniform vec4 u_MeshDequantize;	// Offset in xyz, scale in w
+
+vec3 GetVertexPosition()
+{
+	return u_MeshDequantize.xyz + a_Position.xyz * u_MeshDequantize.w;
+}
+
+vec3 GetVertexNormal()
+{
+	// Unfold the octahedron, the lower half was folded over the diagonals
+	vec3 n = vec3(a_Normal, 1.0 - abs(a_Normal.x) - abs(a_Normal.y));
+	float fold = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -fold : fold, n.y >= 0.0 ? -fold : fold);
+	return normalize(n);
+}
+#else
+layout(location = 0) in vec3 a_Position;
+layout(location = 1) in vec3 a_Normal;
+layout(location = 2) in vec2 a_TextureCoords;
+
+vec3 GetVertexPosition()
+{
+	return a_Position;
+}
+
+vec3 GetVertexNormal()
+{
+	return a_Normal;
+}
+#endif
+
+vec2 GetVertexTexCoords()
+{
+	return a_TextureCoords;
+}
+
+#ifdef VERTEX_TANGENTS
+#ifdef COMPACT_VERTEX
+layout(location = 3) in vec4 a_Tangent;		// 10 bits per component, the bitangent's handedness in the sign of w
+
+vec3 GetVertexTangent()
+{
+	return normalize(a_Tangent.xyz);
+}
+
+vec3 GetVertexBitangent()
+{
+	return cross(GetVertexNormal(), GetVertexTangent()) * (a_Tangent.w < 0.0 ? -1.0 : 1.0);
+}
+#else
+layout(location = 3) in vec3 a_Tangent;
+layout(location = 4) in vec3 a_Bitangent;
+
+vec3 GetVertexTangent()
+{
+	return a_Tangent;
+}
+
+vec3 GetVertexBitangent()
+{
+	return a_Bitangent;
+}
+#endif
+#endif
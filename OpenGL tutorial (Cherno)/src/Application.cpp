@@ -14,6 +14,16 @@
 #include "VertexArray.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "Benchmark.h"
+#include "GPUProfiler.h"
+#include "ShaderCache.h"
+#include "ShaderBatch.h"
+#include "ShaderHotReload.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
+#include "TextureCooker.h"
+#include "CookedModel.h"
+#include "MeshOptimizer.h"
 
 #include "glm\glm.hpp"
 #include "glm\gtc\matrix_transform.hpp"
@@ -47,16 +57,85 @@ static void processInput(GLFWwindow* window);
 test::Test* activeTest;
 test::TestMenu* testMenu;
 
-int main(void)
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
 
+    // Command line options
+    // --benchmark             Run every registered test headlessly and exit
+    // --frames <N>            Number of measured frames per test (default 300)
+    // --output <file.json>    Where to write the benchmark results (default benchmark_results.json)
+    // --no-shader-cache       Always compile shaders from source instead of loading cached program binaries
+    // --sync-textures         Load textures inside their constructors instead of in the background
+    // --anisotropy <N>        Anisotropic filtering for textures loaded from files (default 1, i.e. off)
+    // --compare-mipmaps       Benchmark every test without mipmaps first (written to <output>_no_mipmaps.json), then with them
+    // --cook-textures         Block compress every image under res/textures and res/models (see TextureCooker) and exit
+    // --bc7                   With --cook-textures, use BC7 instead of BC1/BC3 for colour images
+    // --raw                   With --cook-textures, store uncompressed RGBA8 (no decode or mip generation when loading)
+    // --no-cooked-textures    Always load the source images, even where a cooked texture exists
+    // --no-model-cache        Always import models with assimp, without reading or writing cooked models (see CookedModel)
+    // --no-mesh-optimize      Keep imported meshes in the order of their file (see MeshOptimizer)
+    // --no-overdraw-optimize  Optimize imported meshes for the vertex caches only, without sorting for overdraw
+    bool benchmarkMode = false;
+    unsigned int benchmarkFrames = 300;
+    std::string benchmarkOutput = "benchmark_results.json";
+    bool compareMipmaps = false;
+    bool cookTextures = false;
+    TextureCookMode cookMode = COOK_BC;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--benchmark")
+            benchmarkMode = true;
+        else if (arg == "--frames" && i + 1 < argc)
+            benchmarkFrames = std::stoi(argv[++i]);
+        else if (arg == "--output" && i + 1 < argc)
+            benchmarkOutput = argv[++i];
+        else if (arg == "--no-shader-cache")
+            ShaderCache::SetEnabled(false);
+        else if (arg == "--sync-textures")
+            TextureLoader::GetInstance()->SetEnabled(false);
+        else if (arg == "--anisotropy" && i + 1 < argc)
+            Texture::SetDefaultAnisotropy(std::stof(argv[++i]));
+        else if (arg == "--compare-mipmaps")
+            compareMipmaps = true;
+        else if (arg == "--cook-textures")
+            cookTextures = true;
+        else if (arg == "--bc7")
+            cookMode = COOK_BC7;
+        else if (arg == "--raw")
+            cookMode = COOK_RAW;
+        else if (arg == "--no-cooked-textures")
+            CookedTexture::SetEnabled(false);
+        else if (arg == "--no-model-cache")
+            CookedModel::SetEnabled(false);
+        else if (arg == "--no-mesh-optimize")
+            MeshOptimizer::SetFlags(0);
+        else if (arg == "--no-overdraw-optimize")
+            MeshOptimizer::SetFlags(MeshOptimizer::GetFlags() & ~MESH_OPTIMIZE_OVERDRAW);
+    }
+
+    // Cooking runs entirely on the CPU, no window or context needed
+    if (cookTextures)
+    {
+        unsigned int numCooked = TextureCooker::CookDirectories({ "res/textures", "res/models" }, cookMode);
+        return numCooked > 0 ? 0 : -1;
+    }
+
     /* Initialize glfw library */
     if (!glfwInit())
         return -1;
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef _DEBUG
+    // Debug contexts guarantee KHR_debug messages are generated (used by GLCall() in debug builds)
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
+    // Benchmarks render into a hidden window's default framebuffer, so no visible surface is needed
+    // (this also works with software implementations such as Mesa llvmpipe, e.g. LIBGL_ALWAYS_SOFTWARE=1)
+    if (benchmarkMode)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     /* Create a windowed mode window and its OpenGL context */
     window = glfwCreateWindow(960, 540, "OpenGL sandbox", NULL, NULL);
@@ -69,8 +148,8 @@ int main(void)
     /* Make the window's context current */
     glfwMakeContextCurrent(window);
 
-    // Clamp framerate 
-    GLCall(glfwSwapInterval(1));
+    // Clamp framerate (unless benchmarking, where vsync would hide the real frame time)
+    GLCall(glfwSwapInterval(benchmarkMode ? 0 : 1));
 
     // Use GLEW to initialize all our modern OpenGL declarations
     if (glewInit() != GLEW_OK)
@@ -79,6 +158,14 @@ int main(void)
     // Check OpenGL version
     std::cout << glGetString(GL_VERSION) << std::endl;
 
+#ifdef _DEBUG
+    // Report GL errors through the debug message callback instead of polling glGetError() after every call
+    InitGLDebugOutput();
+#endif
+
+    // Nothing has been bound through the state cache yet
+    GLStateCache::Invalidate();
+
     // Callback functions:
     //
     // Window being resized
@@ -98,7 +185,8 @@ int main(void)
         activeTest = nullptr;
         testMenu = new test::TestMenu(activeTest, window);
         activeTest = testMenu;
-        // Initialize test sandboxes
+        // Initialize test sandboxes, compiling all of their shaders as one batch
+        ShaderBatch::Begin();
         test::TestClearColour* clearColourTest  = new test::TestClearColour(window);
         test::TestTexture2D* texture2DTest      = new test::TestTexture2D(window);
         test::TestFPSCamera* cameraTest = new test::TestFPSCamera(window);
@@ -115,6 +203,7 @@ int main(void)
         test::TestDeferredRendering* deferredRenderingTest = new test::TestDeferredRendering(window);
         test::TestSSAO* ssaoTest = new test::TestSSAO(window);
         //test::TestTemplate* templateTest = new test::TestTemplate(window);
+        ShaderBatch::End();
         // Register all test sandboxes
         testMenu->RegisterTest<test::TestClearColour*>("Change background colour", (test::TestClearColour*) clearColourTest);
         testMenu->RegisterTest<test::TestTexture2D*>("Textured cube test", (test::TestTexture2D*) texture2DTest);
@@ -132,6 +221,29 @@ int main(void)
         testMenu->RegisterTest<test::TestDeferredRendering*>("Deferred Rendering", (test::TestDeferredRendering*) deferredRenderingTest);
         testMenu->RegisterTest<test::TestSSAO*>("Ambient Occlusion (SSAO)", (test::TestSSAO*) ssaoTest);
         //testMenu->RegisterTest<test::TestTemplate*>("Test Template", (test::TestTemplate*) templateTest);
+        if (ShaderCache::IsAvailable())
+            std::cout << "Shader cache: " << ShaderCache::GetNumHits() << " programs loaded, " << ShaderCache::GetNumMisses() << " compiled from source" << std::endl;
+        std::cout << "Texture cache: " << TextureCache::GetNumTextures() << " textures shared by " << TextureCache::GetNumHits() + TextureCache::GetNumMisses() << " requests" << std::endl;
+
+        if (benchmarkMode)
+        {
+            // Run every registered test for a fixed number of frames, write the results and exit
+            Benchmark benchmark(window, testMenu, benchmarkFrames);
+            if (compareMipmaps)
+            {
+                // Same scenes sampling only level 0, the difference is what the mip chains save in texture bandwidth
+                std::string noMipmapsOutput = benchmarkOutput.substr(0, benchmarkOutput.find_last_of('.')) + "_no_mipmaps.json";
+                TextureCache::SetMipmapsEnabled(false);
+                benchmark.Run();
+                benchmark.WriteJSON(noMipmapsOutput);
+                std::cout << "Benchmark results without mipmaps written to " << noMipmapsOutput << std::endl;
+                TextureCache::SetMipmapsEnabled(true);
+            }
+            benchmark.Run();
+            benchmark.WriteJSON(benchmarkOutput);
+            std::cout << "Benchmark results written to " << benchmarkOutput << std::endl;
+            glfwSetWindowShouldClose(window, true);
+        }
 
         /* Loop until the user closes the window */
         while (!glfwWindowShouldClose(window)) 
@@ -139,18 +251,28 @@ int main(void)
             /* User key input processing */
             processInput(window);
 
+            // Swap in the reloaded shaders the driver has finished linking, then
+            // rebuild any shader whose file has been saved since the last check
+            ShaderBatch::Update();
+            ShaderHotReload::Update(glfwGetTime());
+            // Upload textures that finished decoding in the background
+            TextureLoader::GetInstance()->Update();
+
             // Start each new frame by clearing
             float* clearColour = clearColourTest->GetClearColour();
             GLCall(glClearColor(clearColour[0], clearColour[1], clearColour[2], clearColour[3]));
             renderer.Clear();
 
             ImGui_ImplGlfwGL3_NewFrame();
+            GLStateCache::BeginFrame();
+            GPUProfiler::GetInstance()->BeginFrame();
             if (activeTest)
             {
                 activeTest->OnUpdate(0.0f);
                 //double timestampBeforeRender = glfwGetTime();
                 //std::cout << "LOG: Before OnRender" << std::endl;
                 activeTest->OnRender();
+                GPUProfiler::GetInstance()->EndFrame();
                 //double onRenderTime = (glfwGetTime() - timestampBeforeRender);
                 //std::cout << "LOG: After OnRender, took " << onRenderTime << " ms" <<std::endl;
                 //std::cout << std::endl << std::endl << std::endl;
@@ -161,6 +283,7 @@ int main(void)
                     activeTest->OnActivated();
                 }
                 activeTest->OnImGuiRender();
+                GLStateCache::OnImGuiRender();
                 ImGui::End();
             }
 
@@ -181,6 +304,7 @@ int main(void)
             delete testMenu;
         delete activeTest;*/
     }
+    TextureLoader::GetInstance()->Shutdown();
     ImGui_ImplGlfwGL3_Shutdown();
     ImGui::DestroyContext();
     glfwTerminate();
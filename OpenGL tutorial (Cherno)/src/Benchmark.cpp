@@ -0,0 +1,193 @@
+#include "Benchmark.h"
+
+#include "Renderer.h"
+#include "Globals.h"
+#include "GPUProfiler.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
+#include "tests\TestClearColour.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+// Returns the value at the given percentile [0, 100] using nearest-rank on a sorted copy
+static double Percentile(std::vector<double> values, double percentile)
+{
+	if (values.empty())
+		return 0.0;
+	std::sort(values.begin(), values.end());
+	size_t rank = (size_t)((percentile / 100.0) * (values.size() - 1) + 0.5);
+	return values[std::min(rank, values.size() - 1)];
+}
+
+static double Mean(const std::vector<double>& values)
+{
+	if (values.empty())
+		return 0.0;
+	double sum = 0.0;
+	for (double value : values)
+		sum += value;
+	return sum / values.size();
+}
+
+// Escape the few characters that can appear in test names
+static std::string EscapeJSON(const std::string& str)
+{
+	std::string escaped;
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+		escaped += c;
+	}
+	return escaped;
+}
+
+static void WriteTimingsJSON(std::ofstream& stream, const char* name, const std::vector<double>& values)
+{
+	stream << "      \"" << name << "\": { "
+		<< "\"mean\": " << Mean(values) << ", "
+		<< "\"min\": " << Percentile(values, 0.0) << ", "
+		<< "\"p50\": " << Percentile(values, 50.0) << ", "
+		<< "\"p90\": " << Percentile(values, 90.0) << ", "
+		<< "\"p95\": " << Percentile(values, 95.0) << ", "
+		<< "\"p99\": " << Percentile(values, 99.0) << ", "
+		<< "\"max\": " << Percentile(values, 100.0) << " }";
+}
+
+Benchmark::Benchmark(GLFWwindow* window, test::TestMenu* testMenu, unsigned int numFrames, unsigned int numWarmupFrames, float fixedDeltaTime)
+	: m_Window(window),
+	m_TestMenu(testMenu),
+	m_NumFrames(numFrames),
+	m_NumWarmupFrames(numWarmupFrames),
+	m_FixedDeltaTime(fixedDeltaTime)
+{
+}
+
+void Benchmark::Run()
+{
+	m_Results.clear();
+	for (auto& testPair : m_TestMenu->GetTests())
+	{
+		std::cout << "[Benchmark] Running: " << testPair.first << std::endl;
+		m_Results.push_back(RunTest(testPair.first, testPair.second));
+		// Return to the main menu so each test starts from the same GL state
+		m_TestMenu->OnActivated();
+	}
+}
+
+BenchmarkResult Benchmark::RunTest(const std::string& testName, test::Test* currentTest)
+{
+	BenchmarkResult result;
+	result.TestName = testName;
+	result.Frames = m_NumFrames;
+
+	// Restart the clock so time-based animations and random seeds match between runs
+	glfwSetTime(0.0);
+	lastFrameTime = 0.0f;
+	deltaTime = m_FixedDeltaTime;
+
+	// Activation is timed separately since it includes model and texture loading
+	GLCall(glFinish());
+	auto activationStart = std::chrono::high_resolution_clock::now();
+	currentTest->OnActivated();
+	// Don't measure frames that still show placeholder textures
+	TextureLoader::GetInstance()->Finish();
+	GLCall(glFinish());
+	auto activationEnd = std::chrono::high_resolution_clock::now();
+	result.ActivationMs = std::chrono::duration<double, std::milli>(activationEnd - activationStart).count();
+
+	unsigned int frameIndex = 0;
+	for (unsigned int i = 0; i < m_NumWarmupFrames; i++)
+		RenderFrame(currentTest, ++frameIndex);
+	GLCall(glFinish());
+
+	// One query object per frame, read back once all frames have been submitted so the benchmark never stalls on the GPU
+	std::vector<unsigned int> timerQueries(m_NumFrames);
+	GLCall(glGenQueries(m_NumFrames, timerQueries.data()));
+
+	result.CpuFrameMs.reserve(m_NumFrames);
+	for (unsigned int i = 0; i < m_NumFrames; i++)
+	{
+		auto frameStart = std::chrono::high_resolution_clock::now();
+		GLCall(glBeginQuery(GL_TIME_ELAPSED, timerQueries[i]));
+		RenderFrame(currentTest, ++frameIndex);
+		GLCall(glEndQuery(GL_TIME_ELAPSED));
+		auto frameEnd = std::chrono::high_resolution_clock::now();
+		result.CpuFrameMs.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+	}
+	GLCall(glFinish());
+	result.StateCacheCounters = GLStateCache::GetLastFrameCounters();
+
+	result.GpuFrameMs.reserve(m_NumFrames);
+	for (unsigned int i = 0; i < m_NumFrames; i++)
+	{
+		GLuint64 elapsedNs = 0;
+		GLCall(glGetQueryObjectui64v(timerQueries[i], GL_QUERY_RESULT, &elapsedNs));
+		result.GpuFrameMs.push_back(elapsedNs / 1000000.0);
+	}
+	GLCall(glDeleteQueries(m_NumFrames, timerQueries.data()));
+
+	return result;
+}
+
+void Benchmark::RenderFrame(test::Test* currentTest, unsigned int frameIndex)
+{
+	// Tests compute their own deltaTime from glfwGetTime(), so advancing the clock by a fixed step makes it deterministic
+	glfwSetTime(frameIndex * (double)m_FixedDeltaTime);
+
+	// Match the per-frame work done by the interactive loop in Application.cpp
+	float* clearColour = test::TestClearColour::GetClearColour();
+	GLCall(glClearColor(clearColour[0], clearColour[1], clearColour[2], clearColour[3]));
+	GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+	GLStateCache::BeginFrame();
+	GPUProfiler::GetInstance()->BeginFrame();
+	currentTest->OnUpdate(m_FixedDeltaTime);
+	currentTest->OnRender();
+	GPUProfiler::GetInstance()->EndFrame();
+
+	glfwSwapBuffers(m_Window);
+	glfwPollEvents();
+}
+
+bool Benchmark::WriteJSON(const std::string& filepath) const
+{
+	std::ofstream stream(filepath);
+	if (!stream.is_open())
+	{
+		std::cout << "[ERROR] Could not open benchmark output file: " << filepath << std::endl;
+		return false;
+	}
+
+	stream << "{\n";
+	stream << "  \"renderer\": \"" << EscapeJSON((const char*)glGetString(GL_RENDERER)) << "\",\n";
+	stream << "  \"version\": \"" << EscapeJSON((const char*)glGetString(GL_VERSION)) << "\",\n";
+	stream << "  \"fixedDeltaTime\": " << m_FixedDeltaTime << ",\n";
+	stream << "  \"mipmaps\": " << (TextureCache::AreMipmapsEnabled() ? "true" : "false") << ",\n";
+	stream << "  \"tests\": [\n";
+	for (unsigned int i = 0; i < m_Results.size(); i++)
+	{
+		const BenchmarkResult& result = m_Results[i];
+		stream << "    {\n";
+		stream << "      \"name\": \"" << EscapeJSON(result.TestName) << "\",\n";
+		stream << "      \"frames\": " << result.Frames << ",\n";
+		stream << "      \"activationMs\": " << result.ActivationMs << ",\n";
+		const GLStateCounters& counters = result.StateCacheCounters;
+		stream << "      \"stateCacheElided\": { "
+			<< "\"program\": [" << counters.ProgramElided << ", " << counters.ProgramCalls << "], "
+			<< "\"vertexArray\": [" << counters.VertexArrayElided << ", " << counters.VertexArrayCalls << "], "
+			<< "\"texture\": [" << counters.TextureElided << ", " << counters.TextureCalls << "], "
+			<< "\"framebuffer\": [" << counters.FramebufferElided << ", " << counters.FramebufferCalls << "], "
+			<< "\"state\": [" << counters.StateElided << ", " << counters.StateCalls << "] },\n";
+		WriteTimingsJSON(stream, "cpuFrameMs", result.CpuFrameMs);
+		stream << ",\n";
+		WriteTimingsJSON(stream, "gpuFrameMs", result.GpuFrameMs);
+		stream << "\n    }" << (i + 1 < m_Results.size() ? "," : "") << "\n";
+	}
+	stream << "  ]\n";
+	stream << "}\n";
+	return true;
+}
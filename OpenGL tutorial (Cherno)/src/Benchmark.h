@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include "GLFW\glfw3.h"
+
+#include "tests\Test.h"
+#include "GLStateCache.h"
+
+// Timing results gathered for a single test sandbox
+struct BenchmarkResult
+{
+	std::string TestName;
+	unsigned int Frames;
+	double ActivationMs;
+	std::vector<double> CpuFrameMs;
+	std::vector<double> GpuFrameMs;
+	GLStateCounters StateCacheCounters; // From the second to last measured frame
+};
+
+// Runs every registered test for a fixed number of frames without any user input.
+// Time is driven through glfwSetTime() so every test sees the same deterministic deltaTime,
+// which keeps camera movement and animations identical between runs.
+class Benchmark
+{
+private:
+	GLFWwindow* m_Window;
+	test::TestMenu* m_TestMenu;
+	unsigned int m_NumFrames;
+	unsigned int m_NumWarmupFrames;
+	float m_FixedDeltaTime;
+	std::vector<BenchmarkResult> m_Results;
+
+public:
+	Benchmark(GLFWwindow* window, test::TestMenu* testMenu, unsigned int numFrames = 300, unsigned int numWarmupFrames = 10, float fixedDeltaTime = 1.0f / 60.0f);
+
+	// Activates each test in registration order and records its frame timings
+	void Run();
+	// Writes all results (with percentiles) to a JSON file, returns false if the file could not be opened
+	bool WriteJSON(const std::string& filepath) const;
+
+	inline const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+
+private:
+	BenchmarkResult RunTest(const std::string& testName, test::Test* currentTest);
+	void RenderFrame(test::Test* currentTest, unsigned int frameIndex);
+};
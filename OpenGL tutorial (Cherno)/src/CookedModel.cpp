@@ -0,0 +1,216 @@
+#include "CookedModel.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+bool CookedModel::s_Enabled = true;
+
+static unsigned long long AlignOffset(unsigned long long offset)
+{
+	return (offset + COOKED_MODEL_ALIGNMENT - 1) / COOKED_MODEL_ALIGNMENT * COOKED_MODEL_ALIGNMENT;
+}
+
+static unsigned long long HashBytes(unsigned long long hash, const char* data, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+		hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+	return hash;
+}
+
+static bool IsObjFile(const std::string& path)
+{
+	if (path.size() < 4)
+		return false;
+	std::string extension = path.substr(path.size() - 4);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return extension == ".obj";
+}
+
+// Names on the "mtllib" lines of an OBJ file, the materials (and so the texture paths) come from those files
+static void FindMaterialLibraries(const char* data, size_t size, std::vector<std::string>& libraries)
+{
+	static const char KEYWORD[] = "mtllib";
+	const size_t keywordLength = sizeof(KEYWORD) - 1;
+	const char* end = data + size;
+	for (const char* line = data; line < end; )
+	{
+		const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+		if (lineEnd == nullptr)
+			lineEnd = end;
+		if ((size_t)(lineEnd - line) > keywordLength && memcmp(line, KEYWORD, keywordLength) == 0 && (line[keywordLength] == ' ' || line[keywordLength] == '\t'))
+		{
+			const char* name = line + keywordLength;
+			const char* nameEnd = lineEnd;
+			while (name < nameEnd && std::isspace((unsigned char)*name))
+				name++;
+			while (nameEnd > name && std::isspace((unsigned char)nameEnd[-1]))
+				nameEnd--;
+			if (name < nameEnd)
+				libraries.push_back(std::string(name, nameEnd));
+		}
+		line = lineEnd + 1;
+	}
+}
+
+CookedModel::CookedModel(const std::string& sourcePath, unsigned int importFlags, unsigned int optimizeFlags, unsigned int vertexSize)
+	: m_SourcePath(sourcePath), m_File(GetPath(sourcePath)), m_Header(nullptr)
+{
+	if (m_File.GetSize() >= sizeof(CookedModelHeader) && Validate(*(const CookedModelHeader*)m_File.GetData(), importFlags, optimizeFlags, vertexSize))
+		m_Header = (const CookedModelHeader*)m_File.GetData();
+}
+
+bool CookedModel::Validate(const CookedModelHeader& header, unsigned int importFlags, unsigned int optimizeFlags, unsigned int vertexSize) const
+{
+	if (memcmp(header.Magic, "CMDL", 4) != 0 || header.Version != COOKED_MODEL_VERSION
+		|| header.ImportFlags != importFlags || header.OptimizeFlags != optimizeFlags || header.VertexSize != vertexSize)
+		return false;
+
+	// Every section must lie inside the file
+	unsigned long long fileSize = m_File.GetSize();
+	if (header.MeshesOffset + (unsigned long long)header.NumMeshes * sizeof(CookedModelMesh) > fileSize
+		|| header.TexturesOffset + (unsigned long long)header.NumTextures * sizeof(CookedModelTexture) > fileSize
+		|| header.VerticesOffset + (unsigned long long)header.NumVertices * vertexSize > fileSize
+		|| header.IndicesOffset + (unsigned long long)header.NumIndices * sizeof(unsigned int) > fileSize
+		|| header.StringsOffset + header.StringsSize > fileSize
+		|| header.StringsSize == 0 || m_File.GetData()[header.StringsOffset + header.StringsSize - 1] != '\0')
+		return false;
+
+	// And every range inside its section
+	const CookedModelMesh* meshes = (const CookedModelMesh*)(m_File.GetData() + header.MeshesOffset);
+	for (unsigned int i = 0; i < header.NumMeshes; i++)
+	{
+		const CookedModelMesh& mesh = meshes[i];
+		if ((unsigned long long)mesh.FirstVertex + mesh.NumVertices > header.NumVertices
+			|| (unsigned long long)mesh.FirstIndex + mesh.NumIndices > header.NumIndices
+			|| (unsigned long long)mesh.FirstTexture + mesh.NumTextures > header.NumTextures)
+			return false;
+	}
+	const CookedModelTexture* textures = (const CookedModelTexture*)(m_File.GetData() + header.TexturesOffset);
+	for (unsigned int i = 0; i < header.NumTextures; i++)
+	{
+		if (textures[i].Type >= header.StringsSize || textures[i].Path >= header.StringsSize)
+			return false;
+	}
+
+	// Import the model again after editing it, rather than showing the old one
+	unsigned long long sourceHash = 0, sourceSize = 0;
+	if (HashSource(m_SourcePath, sourceHash, sourceSize) && (sourceHash != header.SourceHash || sourceSize != header.SourceSize))
+		return false;
+	return true;
+}
+
+bool CookedModel::HashSource(const std::string& sourcePath, unsigned long long& hash, unsigned long long& size)
+{
+	MappedFile source(sourcePath);
+	if (!source.IsOpen())
+		return false;
+	hash = HashBytes(14695981039346656037ull, source.GetData(), source.GetSize());
+	size = source.GetSize();
+
+	if (IsObjFile(sourcePath))
+	{
+		std::vector<std::string> libraries;
+		FindMaterialLibraries(source.GetData(), source.GetSize(), libraries);
+		std::string directory = sourcePath.substr(0, sourcePath.find_last_of("/\\") + 1);
+		for (const std::string& library : libraries)
+		{
+			// A missing library still counts, so adding it later invalidates the file
+			MappedFile material(directory + library);
+			hash = (hash ^ 0xFF) * 1099511628211ull;
+			hash = HashBytes(hash, material.GetData(), material.GetSize());
+			size += material.GetSize();
+		}
+	}
+	return true;
+}
+
+bool CookedModel::Write(const std::string& sourcePath, unsigned int importFlags, unsigned int optimizeFlags, unsigned int vertexSize,
+	const float boundsMin[3], const float boundsMax[3], const std::vector<CookedModelMeshSource>& meshes)
+{
+	CookedModelHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.Magic, "CMDL", 4);
+	header.Version = COOKED_MODEL_VERSION;
+	header.ImportFlags = importFlags;
+	header.OptimizeFlags = optimizeFlags;
+	header.VertexSize = vertexSize;
+	if (!HashSource(sourcePath, header.SourceHash, header.SourceSize))
+		return false;
+	memcpy(header.BoundsMin, boundsMin, sizeof(header.BoundsMin));
+	memcpy(header.BoundsMax, boundsMax, sizeof(header.BoundsMax));
+
+	std::vector<CookedModelMesh> meshRanges;
+	std::vector<CookedModelTexture> textures;
+	std::string strings;
+	for (const CookedModelMeshSource& source : meshes)
+	{
+		CookedModelMesh mesh;
+		mesh.FirstVertex = header.NumVertices;
+		mesh.NumVertices = source.NumVertices;
+		mesh.FirstIndex = header.NumIndices;
+		mesh.NumIndices = source.NumIndices;
+		mesh.FirstTexture = textures.size();
+		mesh.NumTextures = source.TexturePaths.size();
+		meshRanges.push_back(mesh);
+		header.NumVertices += source.NumVertices;
+		header.NumIndices += source.NumIndices;
+
+		for (unsigned int i = 0; i < source.TexturePaths.size(); i++)
+		{
+			CookedModelTexture texture;
+			texture.Type = strings.size();
+			strings.append(source.TextureTypes[i].c_str(), source.TextureTypes[i].size() + 1);
+			texture.Path = strings.size();
+			strings.append(source.TexturePaths[i].c_str(), source.TexturePaths[i].size() + 1);
+			textures.push_back(texture);
+		}
+	}
+	// Never empty, so a valid file always ends its string table with a null
+	strings.push_back('\0');
+	header.NumMeshes = meshRanges.size();
+	header.NumTextures = textures.size();
+	header.StringsSize = strings.size();
+
+	header.MeshesOffset = AlignOffset(sizeof(header));
+	header.TexturesOffset = AlignOffset(header.MeshesOffset + meshRanges.size() * sizeof(CookedModelMesh));
+	header.VerticesOffset = AlignOffset(header.TexturesOffset + textures.size() * sizeof(CookedModelTexture));
+	header.IndicesOffset = AlignOffset(header.VerticesOffset + (unsigned long long)header.NumVertices * vertexSize);
+	header.StringsOffset = AlignOffset(header.IndicesOffset + (unsigned long long)header.NumIndices * sizeof(unsigned int));
+
+	std::ofstream stream(GetPath(sourcePath), std::ios::binary | std::ios::trunc);
+	if (!stream.is_open())
+	{
+		std::cout << "[ERROR] Could not write cooked model " << GetPath(sourcePath) << std::endl;
+		return false;
+	}
+	// Each section is padded out to its aligned offset, the vertices and indices of every mesh go one after the other
+	const char padding[COOKED_MODEL_ALIGNMENT] = {};
+	unsigned long long position = 0;
+	auto append = [&stream, &position](const void* data, size_t size)
+	{
+		stream.write((const char*)data, (std::streamsize)size);
+		position += size;
+	};
+	auto padTo = [&stream, &position, &padding](unsigned long long offset)
+	{
+		stream.write(padding, (std::streamsize)(offset - position));
+		position = offset;
+	};
+	append(&header, sizeof(header));
+	padTo(header.MeshesOffset);
+	append(meshRanges.data(), meshRanges.size() * sizeof(CookedModelMesh));
+	padTo(header.TexturesOffset);
+	append(textures.data(), textures.size() * sizeof(CookedModelTexture));
+	padTo(header.VerticesOffset);
+	for (const CookedModelMeshSource& source : meshes)
+		append(source.Vertices, (size_t)source.NumVertices * vertexSize);
+	padTo(header.IndicesOffset);
+	for (const CookedModelMeshSource& source : meshes)
+		append(source.Indices, source.NumIndices * sizeof(unsigned int));
+	padTo(header.StringsOffset);
+	append(strings.data(), strings.size());
+	return stream.good();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// Cooked models are written next to their source file, e.g. res/models/planet/planet.obj.cmodel
+#define COOKED_MODEL_EXTENSION ".cmodel"
+// Bump whenever the file layout changes, so old files are ignored (and the model imported again)
+#define COOKED_MODEL_VERSION 2
+// Every section of the file starts on this boundary
+#define COOKED_MODEL_ALIGNMENT 16
+
+// One mesh of the model: ranges of the shared vertex, index and texture arrays.
+// Indices are relative to the mesh's first vertex, as assimp produces them.
+struct CookedModelMesh
+{
+	unsigned int FirstVertex, NumVertices;
+	unsigned int FirstIndex, NumIndices;
+	unsigned int FirstTexture, NumTextures;
+};
+
+// A material texture, both strings are offsets of null terminated strings in the string table
+struct CookedModelTexture
+{
+	unsigned int Type;	// e.g. "texture_diffuse"
+	unsigned int Path;	// Relative to the model's directory, as written in its material
+};
+
+struct CookedModelHeader
+{
+	char Magic[4];					// "CMDL"
+	unsigned int Version;
+	unsigned int ImportFlags;		// aiPostProcessSteps the model was imported with
+	unsigned int VertexSize;		// sizeof(Vertex) when it was cooked
+	// Hash and size of the source file (and of an OBJ's material libraries), a file that no longer matches is stale
+	unsigned long long SourceHash;
+	unsigned long long SourceSize;
+	unsigned int NumMeshes, NumTextures;
+	unsigned int NumVertices, NumIndices;
+	unsigned int StringsSize;
+	unsigned int OptimizeFlags;		// MeshOptimizeFlags the meshes were optimized with
+	float BoundsMin[3], BoundsMax[3];	// Of every vertex position, in model space
+	// From the start of the file
+	unsigned long long MeshesOffset, TexturesOffset, VerticesOffset, IndicesOffset, StringsOffset;
+};
+
+// What Write() stores for one mesh
+struct CookedModelMeshSource
+{
+	const void* Vertices;			// NumVertices * vertexSize bytes
+	unsigned int NumVertices;
+	const unsigned int* Indices;
+	unsigned int NumIndices;
+	std::vector<std::string> TextureTypes;
+	std::vector<std::string> TexturePaths;
+};
+
+// Binary copy of everything Model takes from an assimp import: the vertices and indices of every mesh,
+// their material texture paths and the model's bounds. Model writes one after importing a file and loads it
+// instead of running assimp from then on, memory mapped so the geometry is copied once, straight from the OS
+// file cache. It is keyed by a hash of the source file, the import flags and the mesh optimizer flags, so editing
+// the model (or its .mtl file) or changing either set of flags makes Model import it again and rewrite it.
+class CookedModel
+{
+private:
+	std::string m_SourcePath;
+	MappedFile m_File;
+	const CookedModelHeader* m_Header;	// Points into the mapping, nullptr if the file is missing, invalid or stale
+
+public:
+	// Maps the cooked file of sourcePath and validates it against the source and the caller's flags and vertex size
+	CookedModel(const std::string& sourcePath, unsigned int importFlags, unsigned int optimizeFlags, unsigned int vertexSize);
+
+	inline bool IsValid() const { return m_Header != nullptr; }
+	inline const CookedModelHeader& GetHeader() const { return *m_Header; }
+	inline const CookedModelMesh& GetMesh(unsigned int mesh) const { return ((const CookedModelMesh*)(m_File.GetData() + m_Header->MeshesOffset))[mesh]; }
+	inline const CookedModelTexture& GetTexture(unsigned int texture) const { return ((const CookedModelTexture*)(m_File.GetData() + m_Header->TexturesOffset))[texture]; }
+	inline const char* GetString(unsigned int offset) const { return m_File.GetData() + m_Header->StringsOffset + offset; }
+	inline const void* GetVertices() const { return m_File.GetData() + m_Header->VerticesOffset; }
+	inline const unsigned int* GetIndices() const { return (const unsigned int*)(m_File.GetData() + m_Header->IndicesOffset); }
+
+	static std::string GetPath(const std::string& sourcePath) { return sourcePath + COOKED_MODEL_EXTENSION; }
+	static bool Write(const std::string& sourcePath, unsigned int importFlags, unsigned int optimizeFlags, unsigned int vertexSize,
+		const float boundsMin[3], const float boundsMax[3], const std::vector<CookedModelMeshSource>& meshes);
+
+	// FNV-1a of the source file followed by the material libraries an OBJ file names, false if it doesn't exist
+	static bool HashSource(const std::string& sourcePath, unsigned long long& hash, unsigned long long& size);
+
+	// Disabled by --no-model-cache, to compare against importing with assimp every time
+	static void SetEnabled(bool enabled) { s_Enabled = enabled; }
+	static bool IsEnabled() { return s_Enabled; }
+
+private:
+	bool Validate(const CookedModelHeader& header, unsigned int importFlags, unsigned int optimizeFlags, unsigned int vertexSize) const;
+
+	static bool s_Enabled;
+};
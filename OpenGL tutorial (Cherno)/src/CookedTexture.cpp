@@ -0,0 +1,163 @@
+#include "CookedTexture.h"
+
+#include "Renderer.h"
+#include "MipmapGenerator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+bool CookedTexture::s_Enabled = true;
+
+static unsigned long long AlignOffset(unsigned long long offset)
+{
+	return (offset + COOKED_TEXTURE_ALIGNMENT - 1) / COOKED_TEXTURE_ALIGNMENT * COOKED_TEXTURE_ALIGNMENT;
+}
+
+CookedTexture::CookedTexture(const std::string& sourcePath)
+	: m_SourcePath(sourcePath), m_File(GetPath(sourcePath)), m_Header(nullptr)
+{
+	if (m_File.GetSize() >= sizeof(CookedTextureHeader) && Validate(*(const CookedTextureHeader*)m_File.GetData()))
+		m_Header = (const CookedTextureHeader*)m_File.GetData();
+}
+
+bool CookedTexture::Validate(const CookedTextureHeader& header) const
+{
+	if (memcmp(header.Magic, "CTEX", 4) != 0 || header.Version != COOKED_TEXTURE_VERSION)
+		return false;
+
+	if (header.Format > COOKED_TEXTURE_BC7 || header.Width == 0 || header.Height == 0
+		|| header.NumLevels != MipmapGenerator::GetNumLevels(header.Width, header.Height) || header.NumLevels > COOKED_TEXTURE_MAX_LEVELS)
+		return false;
+
+	// Every level must lie inside the file, with the size its dimensions imply
+	for (unsigned int i = 0; i < header.NumLevels; i++)
+	{
+		const CookedTextureLevel& level = header.Levels[i];
+		if (level.Width != std::max(header.Width >> i, 1u) || level.Height != std::max(header.Height >> i, 1u)
+			|| level.Size != ComputeLevelSize((CookedTextureFormat)header.Format, level.Width, level.Height)
+			|| level.Offset < sizeof(header) || level.Offset + level.Size > m_File.GetSize())
+			return false;
+	}
+
+	// Re-cook after editing the image, rather than showing the old one
+	unsigned long long sourceSize = 0;
+	long long sourceModifiedTime = 0;
+	if (GetSourceInfo(m_SourcePath, sourceSize, sourceModifiedTime)
+		&& (sourceSize != header.SourceSize || sourceModifiedTime != header.SourceModifiedTime))
+	{
+		std::cout << "[Warning] Cooked texture is out of date, loading the source image instead: " << m_SourcePath << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void CookedTexture::Prefetch(unsigned int numLevels) const
+{
+	numLevels = std::min(numLevels, m_Header->NumLevels);
+	for (unsigned int i = 0; i < numLevels; i++)
+		m_File.Prefetch((size_t)m_Header->Levels[i].Offset, GetLevelSize(i));
+}
+
+bool CookedTexture::GetSourceInfo(const std::string& sourcePath, unsigned long long& size, long long& modifiedTime)
+{
+#ifdef _WIN32
+	struct _stat64 info;
+	if (_stat64(sourcePath.c_str(), &info) != 0)
+		return false;
+#else
+	struct stat info;
+	if (stat(sourcePath.c_str(), &info) != 0)
+		return false;
+#endif
+	size = (unsigned long long)info.st_size;
+	modifiedTime = (long long)info.st_mtime;
+	return true;
+}
+
+bool CookedTexture::Write(const std::string& sourcePath, CookedTextureHeader& header, const std::vector<std::vector<unsigned char>>& levels)
+{
+	memcpy(header.Magic, "CTEX", 4);
+	header.Version = COOKED_TEXTURE_VERSION;
+	header.NumLevels = levels.size();
+	header.Reserved = 0;
+	// The header gets a page to itself, then each level of a page or more starts on the next page boundary
+	unsigned long long offset = AlignOffset(sizeof(header));
+	for (unsigned int i = 0; i < COOKED_TEXTURE_MAX_LEVELS; i++)
+	{
+		CookedTextureLevel& level = header.Levels[i];
+		if (i < levels.size())
+		{
+			level.Width = std::max(header.Width >> i, 1u);
+			level.Height = std::max(header.Height >> i, 1u);
+			level.Size = levels[i].size();
+			level.Offset = level.Size >= COOKED_TEXTURE_ALIGNMENT ? AlignOffset(offset) : offset;
+			offset = level.Offset + level.Size;
+		}
+		else
+		{
+			memset(&level, 0, sizeof(level));
+		}
+	}
+
+	std::ofstream stream(GetPath(sourcePath), std::ios::binary | std::ios::trunc);
+	if (!stream.is_open())
+	{
+		std::cout << "[ERROR] Could not write cooked texture " << GetPath(sourcePath) << std::endl;
+		return false;
+	}
+	stream.write((const char*)&header, sizeof(header));
+	unsigned long long position = sizeof(header);
+	const std::vector<char> padding(COOKED_TEXTURE_ALIGNMENT, 0);
+	for (unsigned int i = 0; i < levels.size(); i++)
+	{
+		stream.write(padding.data(), (std::streamsize)(header.Levels[i].Offset - position));
+		stream.write((const char*)levels[i].data(), levels[i].size());
+		position = header.Levels[i].Offset + header.Levels[i].Size;
+	}
+	return stream.good();
+}
+
+size_t CookedTexture::ComputeLevelSize(CookedTextureFormat format, int width, int height)
+{
+	if (format == COOKED_TEXTURE_RGBA8)
+		return (size_t)width * height * 4;
+	return TextureCompressor::GetCompressedSize((CompressedFormat)format, width, height);
+}
+
+unsigned int CookedTexture::GetGLFormat(CookedTextureFormat format, bool srgb)
+{
+	switch (format)
+	{
+	// Same as the images decoded at runtime
+	case COOKED_TEXTURE_RGBA8: return srgb ? GL_SRGB8 : GL_RGBA8;
+	case COOKED_TEXTURE_BC1: return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case COOKED_TEXTURE_BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case COOKED_TEXTURE_BC5: return GL_COMPRESSED_RG_RGTC2;
+	case COOKED_TEXTURE_BC7: return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+	return 0;
+}
+
+bool CookedTexture::IsFormatSupported(CookedTextureFormat format, bool srgb)
+{
+	switch (format)
+	{
+	case COOKED_TEXTURE_RGBA8:
+		return true;
+	// S3TC is an extension even in core profiles, but every desktop driver has it. The sRGB variants come from EXT_texture_sRGB.
+	case COOKED_TEXTURE_BC1:
+	case COOKED_TEXTURE_BC3:
+		return GLEW_EXT_texture_compression_s3tc && (!srgb || GLEW_EXT_texture_sRGB);
+	// RGTC is core since 3.0
+	case COOKED_TEXTURE_BC5:
+		return true;
+	case COOKED_TEXTURE_BC7:
+		return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+	}
+	return false;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "TextureCompressor.h"
+
+// Cooked textures are written next to their source image, e.g. res/textures/brick_texture.png.ctex
+#define COOKED_TEXTURE_EXTENSION ".ctex"
+// Bump whenever the file layout changes, so old files are ignored (and the source image loaded instead)
+#define COOKED_TEXTURE_VERSION 2
+#define COOKED_TEXTURE_MAX_LEVELS 16
+// Levels of at least this size start on a page boundary of the file, and so of its mapping
+#define COOKED_TEXTURE_ALIGNMENT MAPPED_FILE_PAGE_SIZE
+
+// Header flags
+#define COOKED_TEXTURE_FLAG_FLIPPED 1		// Rows are stored bottom to top, as loaded with flipOnLoad
+#define COOKED_TEXTURE_FLAG_SRGB_MIPS 2		// Mips were filtered in linear light (colour textures, not normal maps)
+
+// Payload of a cooked texture, the block compressed formats share their values with CompressedFormat
+enum CookedTextureFormat {
+	COOKED_TEXTURE_RGBA8 = 0,					// Uncompressed, tightly packed rows
+	COOKED_TEXTURE_BC1 = COMPRESSED_BC1,
+	COOKED_TEXTURE_BC3 = COMPRESSED_BC3,
+	COOKED_TEXTURE_BC5 = COMPRESSED_BC5,
+	COOKED_TEXTURE_BC7 = COMPRESSED_BC7
+};
+
+struct CookedTextureLevel
+{
+	unsigned int Width, Height;
+	unsigned long long Offset;	// From the start of the file
+	unsigned long long Size;
+};
+
+struct CookedTextureHeader
+{
+	char Magic[4];				// "CTEX"
+	unsigned int Version;
+	unsigned int Format;		// CookedTextureFormat
+	unsigned int Flags;
+	unsigned int Width, Height;
+	unsigned int NumLevels;		// Always the complete chain down to 1x1
+	unsigned int Reserved;
+	// Size and modification time of the source image when it was cooked, a file that no longer matches is stale
+	unsigned long long SourceSize;
+	long long SourceModifiedTime;
+	CookedTextureLevel Levels[COOKED_TEXTURE_MAX_LEVELS];
+};
+
+// GPU-ready texture files written offline by TextureCooker: a header followed by every level of a precomputed mip
+// chain, largest first, either block compressed or as raw RGBA8. Nothing is left to decode, so a level's bytes are
+// handed to glCompressedTexImage2D/glTexImage2D exactly as they are stored.
+// The file is memory mapped rather than read, so loading copies the data once, from the OS file cache to the driver.
+// The header takes a whole page and every level of a page or more starts on a page boundary (the small levels
+// at the end of the chain are packed together), so level data is always page aligned in the mapping.
+// Texture's file constructor checks for a cooked file next to the image first and uses it if the driver supports
+// its format; the Texture(const CookedTexture&) constructor uploads one straight away.
+class CookedTexture
+{
+private:
+	std::string m_SourcePath;
+	MappedFile m_File;
+	const CookedTextureHeader* m_Header;	// Points into the mapping, nullptr if the file is missing, invalid or stale
+
+public:
+	// Maps the cooked file of sourcePath and validates it
+	CookedTexture(const std::string& sourcePath);
+
+	inline bool IsValid() const { return m_Header != nullptr; }
+	inline const std::string& GetSourcePath() const { return m_SourcePath; }
+	inline const CookedTextureHeader& GetHeader() const { return *m_Header; }
+	inline CookedTextureFormat GetFormat() const { return (CookedTextureFormat)m_Header->Format; }
+	inline bool IsFlipped() const { return (m_Header->Flags & COOKED_TEXTURE_FLAG_FLIPPED) != 0; }
+	inline const unsigned char* GetLevelData(unsigned int level) const { return (const unsigned char*)m_File.GetData() + m_Header->Levels[level].Offset; }
+	inline size_t GetLevelSize(unsigned int level) const { return (size_t)m_Header->Levels[level].Size; }
+
+	// Pages in the first numLevels levels, so uploading them later doesn't wait for the disk
+	void Prefetch(unsigned int numLevels) const;
+
+	static std::string GetPath(const std::string& sourcePath) { return sourcePath + COOKED_TEXTURE_EXTENSION; }
+	// Fills in the header's level offsets and sizes, then writes it followed by the levels
+	static bool Write(const std::string& sourcePath, CookedTextureHeader& header, const std::vector<std::vector<unsigned char>>& levels);
+
+	// Size and modification time of a file, false if it doesn't exist
+	static bool GetSourceInfo(const std::string& sourcePath, unsigned long long& size, long long& modifiedTime);
+
+	// Bytes taken by a width x height level
+	static size_t ComputeLevelSize(CookedTextureFormat format, int width, int height);
+	// GL internal format for the payload (BC5 has no sRGB variant, so it is always linear)
+	static unsigned int GetGLFormat(CookedTextureFormat format, bool srgb);
+	// Whether the context can sample format, otherwise the source image is loaded instead
+	static bool IsFormatSupported(CookedTextureFormat format, bool srgb);
+
+	// Disabled by --no-cooked-textures, to compare against loading the source images
+	static void SetEnabled(bool enabled) { s_Enabled = enabled; }
+	static bool IsEnabled() { return s_Enabled; }
+
+private:
+	bool Validate(const CookedTextureHeader& header) const;
+
+	static bool s_Enabled;
+};
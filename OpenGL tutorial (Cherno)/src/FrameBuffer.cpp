@@ -10,14 +10,15 @@ FrameBuffer::FrameBuffer()
 FrameBuffer::~FrameBuffer()
 {
 	glDeleteFramebuffers(1, &m_RendererID);
+	GLStateCache::OnFramebufferDeleted(m_RendererID);
 }
 
 void FrameBuffer::Bind() const
 {
-	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
 }
 
 void FrameBuffer::Unbind() const
 {
-	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
@@ -0,0 +1,41 @@
+#include "FrameUniforms.h"
+
+#include <iostream>
+
+FrameUniforms::FrameUniforms()
+	: m_CameraBuffer(sizeof(CameraBlockData), CAMERA_BLOCK_BINDING),
+	m_LightBuffer(sizeof(LightBlockData), LIGHT_BLOCK_BINDING)
+{
+}
+
+FrameUniforms* FrameUniforms::GetInstance()
+{
+	// Created on first use, once a GL context is current. Never destroyed, since the
+	// GL context (and with it the buffers) is already gone by the time statics are torn down.
+	static FrameUniforms* instance = new FrameUniforms();
+	return instance;
+}
+
+void FrameUniforms::SetCamera(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& viewPos)
+{
+	CameraBlockData data;
+	data.View = view;
+	data.Proj = proj;
+	data.ViewPos = glm::vec4(viewPos, 1.0f);
+	m_CameraBuffer.SetData(&data, sizeof(data));
+}
+
+void FrameUniforms::SetPointLights(const PointLightData* lights, unsigned int count)
+{
+	if (count > MAX_POINT_LIGHTS)
+	{
+		std::cout << "[Warning] " << count << " point lights given, only the first " << MAX_POINT_LIGHTS << " are used" << std::endl;
+		count = MAX_POINT_LIGHTS;
+	}
+
+	// Upload the used lights and the count, the unused tail of the array is never read
+	int numPointLights = count;
+	if (count > 0)
+		m_LightBuffer.SetData(lights, count * sizeof(PointLightData), offsetof(LightBlockData, PointLights));
+	m_LightBuffer.SetData(&numPointLights, sizeof(numPointLights), offsetof(LightBlockData, NumPointLights));
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "glm\glm.hpp"
+
+#include "UniformBuffer.h"
+
+#include <cstddef>
+
+// Uniform block binding points and names. A program that declares a block with one of these names
+// is attached to its binding point when it is linked, so it never needs per-program uniform calls for this data.
+#define CAMERA_BLOCK_NAME "CameraBlock"
+#define CAMERA_BLOCK_BINDING 0
+#define LIGHT_BLOCK_NAME "LightBlock"
+#define LIGHT_BLOCK_BINDING 1
+
+// Must match NUM_POINTLIGHTS in the shaders that declare the light block
+#define MAX_POINT_LIGHTS 256
+
+// C++ mirrors of the shader uniform blocks. These follow the std140 rules: vec3 is aligned like vec4,
+// a scalar may follow a vec3 in the same 16 bytes, and array elements and structs are padded to 16 bytes.
+//
+// layout(std140) uniform CameraBlock
+// {
+//     mat4 view;
+//     mat4 proj;
+//     vec4 viewPos;   // xyz: camera position
+// };
+struct CameraBlockData
+{
+	glm::mat4 View;
+	glm::mat4 Proj;
+	glm::vec4 ViewPos;
+};
+
+// struct PointLight
+// {
+//     vec3 Position;
+//     vec3 Colour;
+//     float Linear;
+//     float Quadratic;
+// };
+struct PointLightData
+{
+	glm::vec3 Position;
+	float Padding0;
+	glm::vec3 Colour;
+	float Linear;		// packed into the last 4 bytes of Colour's 16 byte slot
+	float Quadratic;
+	float Padding1[3];
+};
+
+// layout(std140) uniform LightBlock
+// {
+//     PointLight pointLights[NUM_POINTLIGHTS];
+//     int numPointLights;
+// };
+struct LightBlockData
+{
+	PointLightData PointLights[MAX_POINT_LIGHTS];
+	int NumPointLights;
+	int Padding[3];
+};
+
+static_assert(sizeof(CameraBlockData) == 144, "CameraBlockData does not match the std140 layout");
+static_assert(offsetof(PointLightData, Colour) == 16 && offsetof(PointLightData, Linear) == 28 && offsetof(PointLightData, Quadratic) == 32, "PointLightData does not match the std140 layout");
+static_assert(sizeof(PointLightData) == 48, "PointLightData does not match the std140 layout");
+static_assert(offsetof(LightBlockData, NumPointLights) == 48 * MAX_POINT_LIGHTS, "LightBlockData does not match the std140 layout");
+
+// Owns the uniform buffers shared by every program. Tests upload the camera once per frame
+// and the lights whenever they change, instead of setting the same uniforms on each shader.
+class FrameUniforms
+{
+private:
+	UniformBuffer m_CameraBuffer;
+	UniformBuffer m_LightBuffer;
+
+	FrameUniforms();
+
+public:
+	static FrameUniforms* GetInstance();
+
+	void SetCamera(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& viewPos);
+	// Uploads up to MAX_POINT_LIGHTS lights, only the used part of the block is written
+	void SetPointLights(const PointLightData* lights, unsigned int count);
+};
@@ -0,0 +1,306 @@
+#include "GLStateCache.h"
+
+#include "Renderer.h"
+#include "imgui\imgui.h"
+
+// Value used for state that hasn't been set through the cache yet
+static const unsigned int UNKNOWN = 0xFFFFFFFF;
+
+// Tracked capabilities and texture targets
+static const unsigned int TRACKED_CAPABILITIES[] = { GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE };
+static const unsigned int NUM_CAPABILITIES = sizeof(TRACKED_CAPABILITIES) / sizeof(TRACKED_CAPABILITIES[0]);
+static const unsigned int TRACKED_TEXTURE_TARGETS[] = { GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_2D_ARRAY };
+static const unsigned int NUM_TEXTURE_TARGETS = sizeof(TRACKED_TEXTURE_TARGETS) / sizeof(TRACKED_TEXTURE_TARGETS[0]);
+
+// Shadowed context state
+static unsigned int s_Program = UNKNOWN;
+static unsigned int s_VertexArray = UNKNOWN;
+static unsigned int s_ActiveTextureUnit = UNKNOWN;
+static unsigned int s_BoundTextures[GL_STATE_CACHE_MAX_TEXTURE_UNITS][NUM_TEXTURE_TARGETS];
+static unsigned int s_DrawFramebuffer = UNKNOWN;
+static unsigned int s_ReadFramebuffer = UNKNOWN;
+static unsigned int s_Capabilities[NUM_CAPABILITIES]; // UNKNOWN, GL_TRUE or GL_FALSE
+static unsigned int s_DepthFunc = UNKNOWN;
+static unsigned int s_BlendSrc = UNKNOWN;
+static unsigned int s_BlendDst = UNKNOWN;
+static unsigned int s_CullFaceMode = UNKNOWN;
+static bool s_Initialized = false;
+
+GLStateCounters GLStateCache::s_Counters = {};
+GLStateCounters GLStateCache::s_LastFrameCounters = {};
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+	s_Counters.ProgramCalls++;
+	if (s_Program == program)
+	{
+		s_Counters.ProgramElided++;
+		return;
+	}
+	GLCall(glUseProgram(program));
+	s_Program = program;
+}
+
+void GLStateCache::BindVertexArray(unsigned int vertexArray)
+{
+	s_Counters.VertexArrayCalls++;
+	if (s_VertexArray == vertexArray)
+	{
+		s_Counters.VertexArrayElided++;
+		return;
+	}
+	GLCall(glBindVertexArray(vertexArray));
+	s_VertexArray = vertexArray;
+}
+
+void GLStateCache::ActiveTexture(unsigned int unit)
+{
+	if (!s_Initialized)
+		Invalidate();
+
+	s_Counters.TextureCalls++;
+	if (s_ActiveTextureUnit == unit)
+	{
+		s_Counters.TextureElided++;
+		return;
+	}
+	GLCall(glActiveTexture(unit));
+	s_ActiveTextureUnit = unit;
+}
+
+unsigned int GLStateCache::GetActiveTexture()
+{
+	if (!s_Initialized)
+		Invalidate();
+
+	if (s_ActiveTextureUnit == UNKNOWN)
+	{
+		int unit = GL_TEXTURE0;
+		GLCall(glGetIntegerv(GL_ACTIVE_TEXTURE, &unit));
+		s_ActiveTextureUnit = unit;
+	}
+	return s_ActiveTextureUnit;
+}
+
+void GLStateCache::BindTexture(unsigned int target, unsigned int texture)
+{
+	if (!s_Initialized)
+		Invalidate();
+
+	s_Counters.TextureCalls++;
+	unsigned int slot = s_ActiveTextureUnit - GL_TEXTURE0;
+	int targetIndex = TextureTargetIndex(target);
+	if (s_ActiveTextureUnit == UNKNOWN || slot >= GL_STATE_CACHE_MAX_TEXTURE_UNITS || targetIndex < 0)
+	{
+		// Untracked unit or target, always pass through
+		GLCall(glBindTexture(target, texture));
+		return;
+	}
+	if (s_BoundTextures[slot][targetIndex] == texture)
+	{
+		s_Counters.TextureElided++;
+		return;
+	}
+	GLCall(glBindTexture(target, texture));
+	s_BoundTextures[slot][targetIndex] = texture;
+}
+
+void GLStateCache::BindTextureUnit(unsigned int slot, unsigned int target, unsigned int texture)
+{
+	// Check the binding first, so a texture that is already bound doesn't even change the active unit
+	int targetIndex = TextureTargetIndex(target);
+	if (s_Initialized && slot < GL_STATE_CACHE_MAX_TEXTURE_UNITS && targetIndex >= 0 && s_BoundTextures[slot][targetIndex] == texture)
+	{
+		s_Counters.TextureCalls += 2;
+		s_Counters.TextureElided += 2;
+		return;
+	}
+	ActiveTexture(GL_TEXTURE0 + slot);
+	BindTexture(target, texture);
+}
+
+void GLStateCache::BindFramebuffer(unsigned int target, unsigned int framebuffer)
+{
+	s_Counters.FramebufferCalls++;
+	bool setsDraw = (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER);
+	bool setsRead = (target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER);
+	if ((!setsDraw || s_DrawFramebuffer == framebuffer) && (!setsRead || s_ReadFramebuffer == framebuffer))
+	{
+		s_Counters.FramebufferElided++;
+		return;
+	}
+	GLCall(glBindFramebuffer(target, framebuffer));
+	if (setsDraw)
+		s_DrawFramebuffer = framebuffer;
+	if (setsRead)
+		s_ReadFramebuffer = framebuffer;
+}
+
+void GLStateCache::Enable(unsigned int capability)
+{
+	SetCapability(capability, true);
+}
+
+void GLStateCache::Disable(unsigned int capability)
+{
+	SetCapability(capability, false);
+}
+
+void GLStateCache::SetCapability(unsigned int capability, bool enabled)
+{
+	if (!s_Initialized)
+		Invalidate();
+
+	s_Counters.StateCalls++;
+	int index = CapabilityIndex(capability);
+	unsigned int value = enabled ? GL_TRUE : GL_FALSE;
+	if (index >= 0 && s_Capabilities[index] == value)
+	{
+		s_Counters.StateElided++;
+		return;
+	}
+	// Braces needed since GLCall() expands to several statements
+	if (enabled)
+	{
+		GLCall(glEnable(capability));
+	}
+	else
+	{
+		GLCall(glDisable(capability));
+	}
+	if (index >= 0)
+		s_Capabilities[index] = value;
+}
+
+void GLStateCache::DepthFunc(unsigned int func)
+{
+	s_Counters.StateCalls++;
+	if (s_DepthFunc == func)
+	{
+		s_Counters.StateElided++;
+		return;
+	}
+	GLCall(glDepthFunc(func));
+	s_DepthFunc = func;
+}
+
+void GLStateCache::BlendFunc(unsigned int sfactor, unsigned int dfactor)
+{
+	s_Counters.StateCalls++;
+	if (s_BlendSrc == sfactor && s_BlendDst == dfactor)
+	{
+		s_Counters.StateElided++;
+		return;
+	}
+	GLCall(glBlendFunc(sfactor, dfactor));
+	s_BlendSrc = sfactor;
+	s_BlendDst = dfactor;
+}
+
+void GLStateCache::CullFace(unsigned int mode)
+{
+	s_Counters.StateCalls++;
+	if (s_CullFaceMode == mode)
+	{
+		s_Counters.StateElided++;
+		return;
+	}
+	GLCall(glCullFace(mode));
+	s_CullFaceMode = mode;
+}
+
+void GLStateCache::OnProgramDeleted(unsigned int program)
+{
+	// A deleted program stays in use until another one is bound, so just stop trusting the cache
+	if (s_Program == program)
+		s_Program = UNKNOWN;
+}
+
+void GLStateCache::OnVertexArrayDeleted(unsigned int vertexArray)
+{
+	if (s_VertexArray == vertexArray)
+		s_VertexArray = 0;
+}
+
+void GLStateCache::OnTextureDeleted(unsigned int texture)
+{
+	if (!s_Initialized)
+		return;
+	for (unsigned int slot = 0; slot < GL_STATE_CACHE_MAX_TEXTURE_UNITS; slot++)
+	{
+		for (unsigned int target = 0; target < NUM_TEXTURE_TARGETS; target++)
+		{
+			if (s_BoundTextures[slot][target] == texture)
+				s_BoundTextures[slot][target] = 0;
+		}
+	}
+}
+
+void GLStateCache::OnFramebufferDeleted(unsigned int framebuffer)
+{
+	if (s_DrawFramebuffer == framebuffer)
+		s_DrawFramebuffer = 0;
+	if (s_ReadFramebuffer == framebuffer)
+		s_ReadFramebuffer = 0;
+}
+
+void GLStateCache::Invalidate()
+{
+	s_Program = UNKNOWN;
+	s_VertexArray = UNKNOWN;
+	s_ActiveTextureUnit = UNKNOWN;
+	for (unsigned int slot = 0; slot < GL_STATE_CACHE_MAX_TEXTURE_UNITS; slot++)
+	{
+		for (unsigned int target = 0; target < NUM_TEXTURE_TARGETS; target++)
+			s_BoundTextures[slot][target] = UNKNOWN;
+	}
+	s_DrawFramebuffer = UNKNOWN;
+	s_ReadFramebuffer = UNKNOWN;
+	for (unsigned int i = 0; i < NUM_CAPABILITIES; i++)
+		s_Capabilities[i] = UNKNOWN;
+	s_DepthFunc = UNKNOWN;
+	s_BlendSrc = UNKNOWN;
+	s_BlendDst = UNKNOWN;
+	s_CullFaceMode = UNKNOWN;
+	s_Initialized = true;
+}
+
+void GLStateCache::BeginFrame()
+{
+	s_LastFrameCounters = s_Counters;
+	s_Counters = {};
+}
+
+void GLStateCache::OnImGuiRender()
+{
+	if (!ImGui::CollapsingHeader("GL state cache"))
+		return;
+
+	const GLStateCounters& counters = s_LastFrameCounters;
+	ImGui::Text("Elided calls last frame:");
+	ImGui::Text("  Programs:      %u / %u", counters.ProgramElided, counters.ProgramCalls);
+	ImGui::Text("  Vertex arrays: %u / %u", counters.VertexArrayElided, counters.VertexArrayCalls);
+	ImGui::Text("  Textures:      %u / %u", counters.TextureElided, counters.TextureCalls);
+	ImGui::Text("  Framebuffers:  %u / %u", counters.FramebufferElided, counters.FramebufferCalls);
+	ImGui::Text("  Other state:   %u / %u", counters.StateElided, counters.StateCalls);
+}
+
+int GLStateCache::CapabilityIndex(unsigned int capability)
+{
+	for (unsigned int i = 0; i < NUM_CAPABILITIES; i++)
+	{
+		if (TRACKED_CAPABILITIES[i] == capability)
+			return i;
+	}
+	return -1;
+}
+
+int GLStateCache::TextureTargetIndex(unsigned int target)
+{
+	for (unsigned int i = 0; i < NUM_TEXTURE_TARGETS; i++)
+	{
+		if (TRACKED_TEXTURE_TARGETS[i] == target)
+			return i;
+	}
+	return -1;
+}
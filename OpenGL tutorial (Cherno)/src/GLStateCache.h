@@ -0,0 +1,67 @@
+#pragma once
+
+#include <GL\glew.h>
+
+// Maximum number of texture units tracked by the cache (GL guarantees at least 16 per stage, 48 combined)
+#define GL_STATE_CACHE_MAX_TEXTURE_UNITS 32
+
+// Number of calls made/skipped through the cache
+struct GLStateCounters
+{
+	unsigned int ProgramCalls, ProgramElided;
+	unsigned int VertexArrayCalls, VertexArrayElided;
+	unsigned int TextureCalls, TextureElided;		// glActiveTexture + glBindTexture
+	unsigned int FramebufferCalls, FramebufferElided;
+	unsigned int StateCalls, StateElided;			// glEnable/glDisable, depth, blend and cull functions
+};
+
+// Shadows the bindings and fixed-function state that are changed most often, and skips any GL call
+// that would set a value which is already current. All wrappers (Shader, VertexArray, Texture, FrameBuffer,
+// Mesh) and the tests go through here, so the shadowed values stay in sync with the real context.
+// Anything that changes this state behind the cache's back (e.g. third party code) must call Invalidate().
+class GLStateCache
+{
+public:
+	// Programs and vertex arrays
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vertexArray);
+
+	// Textures (unit is a GL_TEXTUREi enum, like glActiveTexture)
+	static void ActiveTexture(unsigned int unit);
+	// Current unit, asked of GL only while the cache doesn't know it yet
+	static unsigned int GetActiveTexture();
+	static void BindTexture(unsigned int target, unsigned int texture);
+	static void BindTextureUnit(unsigned int slot, unsigned int target, unsigned int texture);
+
+	// Framebuffers (target is GL_FRAMEBUFFER, GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER)
+	static void BindFramebuffer(unsigned int target, unsigned int framebuffer);
+
+	// Capabilities (GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, anything else is passed straight through)
+	static void Enable(unsigned int capability);
+	static void Disable(unsigned int capability);
+	static void DepthFunc(unsigned int func);
+	static void BlendFunc(unsigned int sfactor, unsigned int dfactor);
+	static void CullFace(unsigned int mode);
+
+	// Object deletion: GL reverts bindings of deleted objects, so the cache has to forget them too
+	static void OnProgramDeleted(unsigned int program);
+	static void OnVertexArrayDeleted(unsigned int vertexArray);
+	static void OnTextureDeleted(unsigned int texture);
+	static void OnFramebufferDeleted(unsigned int framebuffer);
+
+	// Forget everything, the next call of each kind always reaches the driver
+	static void Invalidate();
+
+	// Starts a new counting period, keeping the previous frame's counters for display
+	static void BeginFrame();
+	static const GLStateCounters& GetLastFrameCounters() { return s_LastFrameCounters; }
+	static void OnImGuiRender();
+
+private:
+	static int CapabilityIndex(unsigned int capability);
+	static int TextureTargetIndex(unsigned int target);
+	static void SetCapability(unsigned int capability, bool enabled);
+
+	static GLStateCounters s_Counters;
+	static GLStateCounters s_LastFrameCounters;
+};
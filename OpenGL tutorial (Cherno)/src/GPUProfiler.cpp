@@ -0,0 +1,180 @@
+#include "GPUProfiler.h"
+
+#include "Renderer.h"
+#include "imgui\imgui.h"
+
+#include <fstream>
+#include <iostream>
+
+GPUProfiler::GPUProfiler()
+	: m_CurrentFrame(0),
+	m_FrameActive(false),
+	m_Enabled(true)
+{
+	for (unsigned int i = 0; i < GPU_PROFILER_FRAME_LATENCY; i++)
+	{
+		m_Frames[i].NumQueriesUsed = 0;
+		m_Frames[i].Pending = false;
+	}
+}
+
+GPUProfiler::~GPUProfiler()
+{
+	for (unsigned int i = 0; i < GPU_PROFILER_FRAME_LATENCY; i++)
+	{
+		if (!m_Frames[i].QueryPool.empty())
+			glDeleteQueries(m_Frames[i].QueryPool.size(), m_Frames[i].QueryPool.data());
+	}
+}
+
+GPUProfiler* GPUProfiler::GetInstance()
+{
+	// Created on first use, once a GL context is current. Never destroyed, since the
+	// GL context (and with it the queries) is already gone by the time statics are torn down.
+	static GPUProfiler* instance = new GPUProfiler();
+	return instance;
+}
+
+void GPUProfiler::BeginFrame()
+{
+	m_FrameActive = m_Enabled;
+	if (!m_FrameActive)
+		return;
+
+	m_CurrentFrame = (m_CurrentFrame + 1) % GPU_PROFILER_FRAME_LATENCY;
+	FrameQueries& frame = m_Frames[m_CurrentFrame];
+	// This slot was last used GPU_PROFILER_FRAME_LATENCY frames ago, so its queries should be ready by now
+	if (frame.Pending)
+		ResolveFrame(frame);
+
+	frame.NumQueriesUsed = 0;
+	frame.Scopes.clear();
+	m_OpenScopes.clear();
+}
+
+void GPUProfiler::EndFrame()
+{
+	if (!m_FrameActive)
+		return;
+
+	// Close any scopes left open so the frame can still be resolved
+	while (!m_OpenScopes.empty())
+		EndScope();
+
+	FrameQueries& frame = m_Frames[m_CurrentFrame];
+	frame.Pending = !frame.Scopes.empty();
+	m_FrameActive = false;
+}
+
+void GPUProfiler::BeginScope(const std::string& name)
+{
+	if (!m_FrameActive)
+		return;
+
+	FrameQueries& frame = m_Frames[m_CurrentFrame];
+	ScopeRecord scope;
+	scope.Name = name;
+	scope.Depth = m_OpenScopes.size();
+	scope.StartQuery = AcquireQuery(frame);
+	scope.EndQuery = AcquireQuery(frame);
+	GLCall(glQueryCounter(scope.StartQuery, GL_TIMESTAMP));
+
+	m_OpenScopes.push_back(frame.Scopes.size());
+	frame.Scopes.push_back(scope);
+}
+
+void GPUProfiler::EndScope()
+{
+	if (!m_FrameActive || m_OpenScopes.empty())
+		return;
+
+	FrameQueries& frame = m_Frames[m_CurrentFrame];
+	ScopeRecord& scope = frame.Scopes[m_OpenScopes.back()];
+	GLCall(glQueryCounter(scope.EndQuery, GL_TIMESTAMP));
+	m_OpenScopes.pop_back();
+}
+
+unsigned int GPUProfiler::AcquireQuery(FrameQueries& frame)
+{
+	// Grow the pool the first time a frame needs more queries than any previous frame
+	if (frame.NumQueriesUsed == frame.QueryPool.size())
+	{
+		unsigned int query;
+		GLCall(glGenQueries(1, &query));
+		frame.QueryPool.push_back(query);
+	}
+	return frame.QueryPool[frame.NumQueriesUsed++];
+}
+
+void GPUProfiler::ResolveFrame(FrameQueries& frame)
+{
+	frame.Pending = false;
+
+	// Queries complete in order, so if the last one is available then all of them are.
+	// If the GPU is somehow still behind, drop this frame's results instead of stalling.
+	int available = 0;
+	GLCall(glGetQueryObjectiv(frame.Scopes.back().EndQuery, GL_QUERY_RESULT_AVAILABLE, &available));
+	if (!available)
+		return;
+
+	// Only smooth against the previous results if the scope layout hasn't changed (e.g. switching tests)
+	bool sameLayout = m_Results.size() == frame.Scopes.size();
+	for (unsigned int i = 0; sameLayout && i < frame.Scopes.size(); i++)
+		sameLayout = m_Results[i].Name == frame.Scopes[i].Name;
+	if (!sameLayout)
+		m_Results.resize(frame.Scopes.size());
+
+	for (unsigned int i = 0; i < frame.Scopes.size(); i++)
+	{
+		const ScopeRecord& scope = frame.Scopes[i];
+		GLuint64 startNs = 0, endNs = 0;
+		GLCall(glGetQueryObjectui64v(scope.StartQuery, GL_QUERY_RESULT, &startNs));
+		GLCall(glGetQueryObjectui64v(scope.EndQuery, GL_QUERY_RESULT, &endNs));
+		double timeMs = (endNs - startNs) / 1000000.0;
+
+		GPUProfileResult& result = m_Results[i];
+		result.Name = scope.Name;
+		result.Depth = scope.Depth;
+		result.TimeMs = timeMs;
+		result.AverageTimeMs = sameLayout ? (0.95 * result.AverageTimeMs + 0.05 * timeMs) : timeMs;
+	}
+}
+
+void GPUProfiler::OnImGuiRender()
+{
+	if (!ImGui::CollapsingHeader("GPU timings"))
+		return;
+
+	ImGui::Columns(3, "GPUTimings");
+	ImGui::Text("Pass"); ImGui::NextColumn();
+	ImGui::Text("GPU ms"); ImGui::NextColumn();
+	ImGui::Text("Avg ms"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (const GPUProfileResult& result : m_Results)
+	{
+		ImGui::Text("%*s%s", (int)result.Depth * 2, "", result.Name.c_str()); ImGui::NextColumn();
+		ImGui::Text("%.3f", result.TimeMs); ImGui::NextColumn();
+		ImGui::Text("%.3f", result.AverageTimeMs); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+
+	if (ImGui::Button("Dump GPU timings"))
+		DumpToFile("gpu_timings.txt");
+}
+
+bool GPUProfiler::DumpToFile(const std::string& filepath) const
+{
+	std::ofstream stream(filepath, std::ios::app);
+	if (!stream.is_open())
+	{
+		std::cout << "[ERROR] Could not open GPU timings file: " << filepath << std::endl;
+		return false;
+	}
+
+	stream << "Pass, GPU ms, Avg ms" << std::endl;
+	for (const GPUProfileResult& result : m_Results)
+		stream << std::string(result.Depth * 2, ' ') << result.Name << ", " << result.TimeMs << ", " << result.AverageTimeMs << std::endl;
+	stream << std::endl;
+	std::cout << "GPU timings written to " << filepath << std::endl;
+	return true;
+}
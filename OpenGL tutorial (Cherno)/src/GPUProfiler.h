@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Number of frames of queries kept in flight before their results are read back.
+// Results are only read once the GPU has had this many frames to finish, so readbacks never stall the pipeline.
+#define GPU_PROFILER_FRAME_LATENCY 4
+
+// A single timed scope within a frame (scopes may be nested)
+struct GPUProfileResult
+{
+	std::string Name;
+	unsigned int Depth;
+	double TimeMs;			// GPU time of the most recently resolved frame
+	double AverageTimeMs;	// Exponentially smoothed GPU time
+};
+
+// Hierarchical GPU profiler built on GL_TIMESTAMP queries.
+// Each scope records a timestamp at its start and end with glQueryCounter(), which (unlike GL_TIME_ELAPSED)
+// allows scopes to nest. Queries are recycled from a ring of GPU_PROFILER_FRAME_LATENCY per-frame pools.
+class GPUProfiler
+{
+private:
+	struct ScopeRecord
+	{
+		std::string Name;
+		unsigned int Depth;
+		unsigned int StartQuery;
+		unsigned int EndQuery;
+	};
+
+	struct FrameQueries
+	{
+		std::vector<unsigned int> QueryPool;
+		unsigned int NumQueriesUsed;
+		std::vector<ScopeRecord> Scopes;
+		bool Pending;
+	};
+
+	FrameQueries m_Frames[GPU_PROFILER_FRAME_LATENCY];
+	unsigned int m_CurrentFrame;
+	std::vector<unsigned int> m_OpenScopes; // indices into the current frame's Scopes
+	std::vector<GPUProfileResult> m_Results;
+	bool m_FrameActive;
+	bool m_Enabled;
+
+public:
+	GPUProfiler();
+	~GPUProfiler();
+
+	static GPUProfiler* GetInstance();
+
+	// Called once per frame around all rendering (see Application.cpp)
+	void BeginFrame();
+	void EndFrame();
+
+	void BeginScope(const std::string& name);
+	void EndScope();
+
+	// Draws the latest resolved timings as an indented table in the current ImGui window
+	void OnImGuiRender();
+	// Writes the latest resolved timings to a text file, returns false if the file could not be opened
+	bool DumpToFile(const std::string& filepath) const;
+
+	inline const std::vector<GPUProfileResult>& GetResults() const { return m_Results; }
+	inline void SetEnabled(bool enabled) { m_Enabled = enabled; }
+	inline bool IsEnabled() const { return m_Enabled; }
+
+private:
+	unsigned int AcquireQuery(FrameQueries& frame);
+	void ResolveFrame(FrameQueries& frame);
+};
+
+// Times everything until the end of the enclosing C++ scope
+class GPUProfileScope
+{
+public:
+	GPUProfileScope(const std::string& name) { GPUProfiler::GetInstance()->BeginScope(name); }
+	~GPUProfileScope() { GPUProfiler::GetInstance()->EndScope(); }
+};
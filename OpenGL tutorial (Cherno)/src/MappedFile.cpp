@@ -0,0 +1,92 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filepath)
+	: m_Data(nullptr), m_Size(0), m_IsOpen(false)
+{
+	// The file and mapping handles can be closed straight away, the view keeps the file mapped
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size))
+	{
+		m_Size = (size_t)size.QuadPart;
+		// Empty files can't be mapped, but are still valid
+		m_IsOpen = m_Size == 0;
+		if (m_Size > 0)
+		{
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping != nullptr)
+			{
+				m_Data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				m_IsOpen = m_Data != nullptr;
+				CloseHandle(mapping);
+			}
+		}
+	}
+	CloseHandle(file);
+#else
+	int file = open(filepath.c_str(), O_RDONLY);
+	if (file == -1)
+		return;
+	struct stat fileInfo;
+	if (fstat(file, &fileInfo) == 0)
+	{
+		m_Size = (size_t)fileInfo.st_size;
+		m_IsOpen = m_Size == 0;
+		if (m_Size > 0)
+		{
+			void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (data != MAP_FAILED)
+			{
+				m_Data = data;
+				m_IsOpen = true;
+			}
+		}
+	}
+	close(file);
+#endif
+	if (!m_IsOpen)
+		m_Size = 0;
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_Data == nullptr)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(m_Data);
+#else
+	munmap(m_Data, m_Size);
+#endif
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size) const
+{
+	if (m_Data == nullptr || offset >= m_Size)
+		return;
+	size = std::min(size, m_Size - offset);
+#ifndef _WIN32
+	// Ask for read-ahead of the whole range first, so the reads below mostly find the pages already there
+	size_t pageOffset = offset - offset % MAPPED_FILE_PAGE_SIZE;
+	madvise((char*)m_Data + pageOffset, size + offset - pageOffset, MADV_WILLNEED);
+#endif
+	const volatile char* data = (const volatile char*)m_Data + offset;
+	for (size_t i = 0; i < size; i += MAPPED_FILE_PAGE_SIZE)
+		(void)data[i];
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+// Granularity the OS pages mapped files in at (4 KB on every platform the project targets)
+#define MAPPED_FILE_PAGE_SIZE 4096
+
+// Read-only memory mapping of a whole file. The contents are paged in straight from the OS file cache
+// on first access, with no read() into an intermediate buffer. The mapping lasts as long as the object.
+class MappedFile
+{
+private:
+	void* m_Data;
+	size_t m_Size;
+	bool m_IsOpen;
+
+public:
+	MappedFile(const std::string& filepath);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// False if the file doesn't exist or couldn't be mapped (an empty file is open, with no data)
+	inline bool IsOpen() const { return m_IsOpen; }
+	inline const char* GetData() const { return (const char*)m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+
+	// Faults a range in now (one read per page), so a later access on another thread doesn't stall on the disk
+	void Prefetch(size_t offset, size_t size) const;
+};
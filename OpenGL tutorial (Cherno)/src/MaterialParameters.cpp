@@ -0,0 +1,123 @@
+#include "MaterialParameters.h"
+
+#include "Renderer.h"
+
+#include <iostream>
+
+// Whether a value set as setType can be uploaded to a uniform declared as uniformType
+static bool TypesMatch(unsigned int setType, unsigned int uniformType)
+{
+	if (setType == uniformType)
+		return true;
+	// glUniform1i is used for ints, bools and samplers alike
+	return setType == GL_INT && (uniformType == GL_BOOL || uniformType == GL_SAMPLER_2D || uniformType == GL_SAMPLER_CUBE || uniformType == GL_SAMPLER_2D_ARRAY);
+}
+
+MaterialParameters::MaterialParameters(Shader* shader)
+	: m_Shader(shader),
+	m_ShaderGeneration(shader->GetGeneration())
+{
+}
+
+void MaterialParameters::SetInt(const char* name, int value)
+{
+	SetValue(name, GL_INT, glm::mat4(glm::vec4((float)value, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f)));
+}
+
+void MaterialParameters::SetBool(const char* name, bool value)
+{
+	SetInt(name, (int)value);
+}
+
+void MaterialParameters::SetFloat(const char* name, float value)
+{
+	SetValue(name, GL_FLOAT, glm::mat4(glm::vec4(value, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f)));
+}
+
+void MaterialParameters::SetVec3(const char* name, const glm::vec3& value)
+{
+	SetValue(name, GL_FLOAT_VEC3, glm::mat4(glm::vec4(value, 0.0f), glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f)));
+}
+
+void MaterialParameters::SetVec4(const char* name, const glm::vec4& value)
+{
+	SetValue(name, GL_FLOAT_VEC4, glm::mat4(value, glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f)));
+}
+
+void MaterialParameters::SetMatrix4f(const char* name, const glm::mat4& value)
+{
+	SetValue(name, GL_FLOAT_MAT4, value);
+}
+
+void MaterialParameters::SetValue(const char* name, unsigned int type, const glm::mat4& value)
+{
+	UniformHandle handle = m_Shader->GetUniformHandle(name);
+	if (!handle.IsValid())
+	{
+		ReportOnce(name, "is not an active uniform");
+		return;
+	}
+	const ShaderUniform& uniform = m_Shader->GetUniform(handle);
+	if (!TypesMatch(type, uniform.Type))
+	{
+		ReportOnce(name, "is set with a different type than it is declared with");
+		return;
+	}
+
+	for (Parameter& parameter : m_Parameters)
+	{
+		if (parameter.Handle.Index == handle.Index)
+		{
+			if (parameter.Value != value)
+			{
+				parameter.Value = value;
+				parameter.Dirty = true;
+			}
+			return;
+		}
+	}
+	m_Parameters.push_back({ handle, uniform.Type, value, true });
+}
+
+void MaterialParameters::Apply()
+{
+	// A reloaded program starts with default uniform values
+	if (m_ShaderGeneration != m_Shader->GetGeneration())
+	{
+		Invalidate();
+		m_ShaderGeneration = m_Shader->GetGeneration();
+	}
+
+	for (Parameter& parameter : m_Parameters)
+	{
+		if (!parameter.Dirty)
+			continue;
+
+		switch (parameter.Type)
+		{
+			case GL_FLOAT:		m_Shader->SetFloat(parameter.Handle, parameter.Value[0][0]); break;
+			case GL_FLOAT_VEC3:	m_Shader->SetVec3(parameter.Handle, glm::vec3(parameter.Value[0])); break;
+			case GL_FLOAT_VEC4:	m_Shader->SetVec4(parameter.Handle, parameter.Value[0]); break;
+			case GL_FLOAT_MAT4:	m_Shader->SetMatrix4f(parameter.Handle, parameter.Value); break;
+			default:			m_Shader->SetInt(parameter.Handle, (int)parameter.Value[0][0]); break; // ints, bools and samplers
+		}
+		parameter.Dirty = false;
+	}
+}
+
+void MaterialParameters::Invalidate()
+{
+	for (Parameter& parameter : m_Parameters)
+		parameter.Dirty = true;
+}
+
+void MaterialParameters::ReportOnce(const char* name, const std::string& message)
+{
+	for (const std::string& reported : m_ReportedNames)
+	{
+		if (reported == name)
+			return;
+	}
+	m_ReportedNames.push_back(name);
+	std::cout << "[Warning] Material parameter " << name << " " << message << " in " << m_Shader->GetFilepath() << std::endl;
+}
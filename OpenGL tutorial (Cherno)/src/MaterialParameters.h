@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "glm\glm.hpp"
+
+#include "Shader.h"
+
+// Typed uniform values for one shader, uploaded lazily.
+// Every Set call is checked against the shader's reflection data, so a misspelt name or wrong type is reported
+// once when it is first set instead of silently doing nothing every frame. Values are only marked dirty when
+// they actually change, and Apply() uploads just the dirty ones, so constants set each frame cost nothing on the GL side.
+// The parameters own their uniforms: setting the same uniforms directly on the shader would bypass the dirty tracking.
+class MaterialParameters
+{
+private:
+	struct Parameter
+	{
+		UniformHandle Handle;
+		unsigned int Type;		// GL type of the uniform, taken from reflection
+		glm::mat4 Value;		// Large enough for every supported type, smaller types use the first column
+		bool Dirty;
+	};
+
+	Shader* m_Shader;
+	unsigned int m_ShaderGeneration;	// Shader::GetGeneration() when the values were last uploaded
+	std::vector<Parameter> m_Parameters;
+	std::vector<std::string> m_ReportedNames; // names already warned about
+
+public:
+	MaterialParameters(Shader* shader);
+
+	void SetInt(const char* name, int value);
+	void SetBool(const char* name, bool value);
+	void SetFloat(const char* name, float value);
+	void SetVec3(const char* name, const glm::vec3& value);
+	void SetVec4(const char* name, const glm::vec4& value);
+	void SetMatrix4f(const char* name, const glm::mat4& value);
+
+	// Uploads the values changed since the last Apply() (or all of them if the shader was reloaded), the shader must be bound
+	void Apply();
+	// Marks every value dirty, e.g. after the program has been relinked
+	void Invalidate();
+
+	inline Shader* GetShader() const { return m_Shader; }
+
+private:
+	void SetValue(const char* name, unsigned int type, const glm::mat4& value);
+	void ReportOnce(const char* name, const std::string& message);
+};
@@ -12,15 +12,16 @@
 #include <string>
 #include <vector>
 #include <Shader.h>
+#include <GLStateCache.h>
+#include <Renderer.h>
+#include <Span.h>
+#include <Vertex.h>
+#include <VertexCompressor.h>
 using namespace std;
 
-struct Vertex {
-	glm::vec3 Position;
-	glm::vec3 Normal;
-	glm::vec2 TexCoords;
-	glm::vec3 Tangent;
-	glm::vec3 Bitangent;
-};
+// Attribute holding the mesh's layer of its model's texture array (see Model::UseTextureArray).
+// Locations 3 to 6 are taken by the instance matrix in TestInstancedRendering.
+#define MESH_TEXTURE_LAYER_LOCATION 7
 
 struct ModelTexture {
 	unsigned int id;
@@ -32,20 +33,84 @@ struct ModelTexture {
 class Mesh {
 public:
 
-	// Mesh Data 
-	vector<Vertex> vertices;
-	vector<unsigned int> indices;
-	vector<ModelTexture> textures;
+	// Constructor: takes ownership of the vertices, their indices and the textures (move them in, nothing is copied)
+	// and keeps the geometry on the CPU as well as uploading it, until ReleaseGeometry().
+	// The CPU copy is always a Vertex, vertexFormat only changes what is uploaded.
+	Mesh(vector<Vertex>&& vertices, vector<unsigned int>&& indices, vector<ModelTexture>&& textures, MeshVertexFormat vertexFormat = MESH_VERTEX_FULL)
+		: vertices(move(vertices)), indices(move(indices)), textures(move(textures)),
+		numVertices(this->vertices.size()), numIndices(this->indices.size()), vertexFormat(vertexFormat), layerVBO(0),
+		dequantizeShader(nullptr), dequantizeProgram(0)
+	{
+		// Using the given parameters, set the OpenGL vertex buffers and attribute pointers
+		setupMesh(this->vertices.data(), this->indices.data());
+	}
 
-	// Constructor: takes a vector of vertices and their corresponding indices and texture data vectors
-	Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<ModelTexture> textures)
+	// Uploads geometry owned by someone else (e.g. a cooked model's mapping) without keeping a CPU copy of it
+	Mesh(Span<const Vertex> vertices, Span<const unsigned int> indices, vector<ModelTexture>&& textures, MeshVertexFormat vertexFormat = MESH_VERTEX_FULL)
+		: textures(move(textures)), numVertices(vertices.GetSize()), numIndices(indices.GetSize()), vertexFormat(vertexFormat), layerVBO(0),
+		dequantizeShader(nullptr), dequantizeProgram(0)
 	{
-		this->vertices = vertices;
-		this->indices = indices;
-		this->textures = textures;
+		setupMesh(vertices.GetData(), indices.GetData());
+	}
 
-		// Using the given parameters, set the OpenGL vertex buffers and attribute pointers
-		setupMesh();
+	// Meshes own their geometry and GL objects, so they're moved (into the model's vector) and never copied
+	Mesh(const Mesh&) = delete;
+	Mesh& operator=(const Mesh&) = delete;
+	// A moved from mesh owns no GL objects anymore, so only the mesh it was moved into deletes them
+	Mesh(Mesh&& other) noexcept
+		: vertices(move(other.vertices)), indices(move(other.indices)), textures(move(other.textures)),
+		numVertices(other.numVertices), numIndices(other.numIndices), vertexFormat(other.vertexFormat), dequantize(other.dequantize),
+		VAO(other.VAO), VBO(other.VBO), EBO(other.EBO), layerVBO(other.layerVBO),
+		dequantizeShader(other.dequantizeShader), dequantizeProgram(other.dequantizeProgram), dequantizeHandle(other.dequantizeHandle)
+	{
+		other.VAO = other.VBO = other.EBO = other.layerVBO = 0;
+	}
+	Mesh& operator=(Mesh&& other) noexcept
+	{
+		if (this != &other)
+		{
+			deleteObjects();
+			vertices = move(other.vertices);
+			indices = move(other.indices);
+			textures = move(other.textures);
+			numVertices = other.numVertices;
+			numIndices = other.numIndices;
+			vertexFormat = other.vertexFormat;
+			dequantize = other.dequantize;
+			VAO = other.VAO;
+			VBO = other.VBO;
+			EBO = other.EBO;
+			layerVBO = other.layerVBO;
+			dequantizeShader = other.dequantizeShader;
+			dequantizeProgram = other.dequantizeProgram;
+			dequantizeHandle = other.dequantizeHandle;
+			other.VAO = other.VBO = other.EBO = other.layerVBO = 0;
+		}
+		return *this;
+	}
+
+	// The textures belong to the model (see Model::textures_loaded) and aren't deleted here
+	~Mesh()
+	{
+		deleteObjects();
+	}
+
+	// The CPU copy of the geometry, empty once released
+	Span<const Vertex> GetVertices() const { return Span<const Vertex>(vertices); }
+	Span<const unsigned int> GetIndices() const { return Span<const unsigned int>(indices); }
+	const vector<ModelTexture>& GetTextures() const { return textures; }
+	bool HasGeometry() const { return vertices.size() == numVertices && indices.size() == numIndices; }
+	unsigned int GetNumVertices() const { return numVertices; }
+	unsigned int GetNumIndices() const { return numIndices; }
+	MeshVertexFormat GetVertexFormat() const { return vertexFormat; }
+	// Offset and scale of the quantized positions (see VertexCompressor::GetDequantize), for MESH_VERTEX_COMPACT
+	const glm::vec4& GetDequantize() const { return dequantize; }
+
+	// Frees the CPU copy of the vertices and indices, the GPU buffers are all that drawing needs
+	void ReleaseGeometry()
+	{
+		vector<Vertex>().swap(vertices);
+		vector<unsigned int>().swap(indices);
 	}
 
 	void Draw(Shader* shaderProgram)
@@ -54,7 +119,7 @@ public:
 		unsigned int specularNum = 0;
 		for (unsigned int i = 0; i < textures.size(); i++)
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
+			GLStateCache::ActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
 				// retrieve texture number (the N in diffuse_textureN)
 			stringstream ss;
 			string number;
@@ -69,13 +134,14 @@ public:
 			number = ss.str();
 			// shaderProgram.setFloat(("material." + name + number).c_str(), i);
 			shaderProgram->SetInt((name + number).c_str(), i);
-			glBindTexture(GL_TEXTURE_2D, textures[i].id);
+			GLStateCache::BindTexture(GL_TEXTURE_2D, textures[i].id);
 		}
-		glActiveTexture(GL_TEXTURE0);
-		// draw mesh
-		glBindVertexArray(VAO);
-		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-		glBindVertexArray(0);
+		GLStateCache::ActiveTexture(GL_TEXTURE0);
+		setVertexUniforms(shaderProgram);
+		// draw mesh, then unbind the VAO since an IndexBuffer created or unbound later would replace its EBO
+		GLStateCache::BindVertexArray(VAO);
+		glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, 0);
+		GLStateCache::BindVertexArray(0);
 	}
 	
 	void DrawInstanced(Shader* shaderProgram, unsigned int instanceCount)
@@ -84,7 +150,7 @@ public:
 		unsigned int specularNum = 0;
 		for (unsigned int i = 0; i < textures.size(); i++)
 		{
-			glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
+			GLStateCache::ActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
 				// retrieve texture number (the N in diffuse_textureN)
 			stringstream ss;
 			string number;
@@ -99,59 +165,192 @@ public:
 			number = ss.str();
 			// shaderProgram.setFloat(("material." + name + number).c_str(), i);
 			shaderProgram->SetInt((name + number).c_str(), i);
-			glBindTexture(GL_TEXTURE_2D, textures[i].id);
+			GLStateCache::BindTexture(GL_TEXTURE_2D, textures[i].id);
 		}
-		glActiveTexture(GL_TEXTURE0);
+		GLStateCache::ActiveTexture(GL_TEXTURE0);
+		setVertexUniforms(shaderProgram);
 		// draw mesh
-		glBindVertexArray(VAO);
-		glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0, instanceCount);
-		glBindVertexArray(0);
+		GLStateCache::BindVertexArray(VAO);
+		glDrawElementsInstanced(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, 0, instanceCount);
+		GLStateCache::BindVertexArray(0);
+	}
+
+	// Queue the mesh on the renderer instead of drawing it straight away (see Renderer::Flush).
+	// fallbackTextureID is used for the diffuse sampler if the mesh has no diffuse texture, and for the specular sampler
+	void Submit(Renderer& renderer, Shader* shaderProgram, const glm::mat4& modelMatrix, RenderPass pass, float depth, unsigned int fallbackTextureID = 0)
+	{
+		static const char* diffuseNames[RENDERER_MAX_DRAW_TEXTURES] = { "texture_diffuse0", "texture_diffuse1", "texture_diffuse2", "texture_diffuse3" };
+
+		DrawCommand command;
+		command.Pass = pass;
+		command.Depth = depth;
+		command.Program = shaderProgram;
+		command.VertexArray = VAO;
+		command.IndexCount = numIndices;
+		command.ModelMatrix = modelMatrix;
+		unsigned int diffuseNum = 0;
+		for (unsigned int i = 0; i < textures.size() && diffuseNum < RENDERER_MAX_DRAW_TEXTURES - 1; i++)
+		{
+			// Specular maps aren't used, same as Draw()
+			if (textures[i].type == "texture_diffuse")
+			{
+				command.AddTexture(diffuseNum, GL_TEXTURE_2D, textures[i].id, diffuseNames[diffuseNum]);
+				diffuseNum++;
+			}
+		}
+		if (fallbackTextureID != 0)
+		{
+			if (diffuseNum == 0)
+				command.AddTexture(diffuseNum++, GL_TEXTURE_2D, fallbackTextureID, "texture_diffuse0");
+			command.AddTexture(diffuseNum, GL_TEXTURE_2D, fallbackTextureID, "texture_specular0");
+		}
+		if (vertexFormat == MESH_VERTEX_COMPACT)
+			command.AddUniform("u_MeshDequantize", dequantize);
+		renderer.Submit(command);
 	}
 
-	unsigned int GetVAO() { return VAO; }
+	// Queues the mesh with the textures already in command (the model's shared texture array),
+	// so every mesh of the model ends up with the same material and only the first one binds it
+	void Submit(Renderer& renderer, DrawCommand command)
+	{
+		command.VertexArray = VAO;
+		command.IndexCount = numIndices;
+		if (vertexFormat == MESH_VERTEX_COMPACT)
+			command.AddUniform("u_MeshDequantize", dequantize);
+		renderer.Submit(command);
+	}
+
+	// Draws without binding any textures, for when the model has bound its texture array once for all its meshes
+	void DrawUntextured(Shader* shaderProgram, unsigned int instanceCount = 1)
+	{
+		setVertexUniforms(shaderProgram);
+		GLStateCache::BindVertexArray(VAO);
+		if (instanceCount > 1)
+			glDrawElementsInstanced(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, 0, instanceCount);
+		else
+			glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, 0);
+		GLStateCache::BindVertexArray(0);
+	}
+
+	// Stores layer for every vertex at MESH_TEXTURE_LAYER_LOCATION. A buffer rather than a constant attribute value,
+	// since those aren't part of the VAO and would need setting before every draw.
+	void SetTextureLayer(float layer)
+	{
+		vector<float> layers(numVertices, layer);
+		if (layerVBO == 0)
+			glGenBuffers(1, &layerVBO);
+
+		GLStateCache::BindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, layerVBO);
+		glBufferData(GL_ARRAY_BUFFER, layers.size() * sizeof(float), layers.data(), GL_STATIC_DRAW);
+		glEnableVertexAttribArray(MESH_TEXTURE_LAYER_LOCATION);
+		glVertexAttribPointer(MESH_TEXTURE_LAYER_LOCATION, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+		GLStateCache::BindVertexArray(0);
+	}
+
+	unsigned int GetVAO() const { return VAO; }
 
 private:
 
+	// Mesh Data 
+	vector<Vertex> vertices;
+	vector<unsigned int> indices;
+	vector<ModelTexture> textures;
+	unsigned int numVertices, numIndices; // Still known once the CPU copy has been released
+	MeshVertexFormat vertexFormat;
+	glm::vec4 dequantize;
+
 	// Render data
 	unsigned int VAO, VBO, EBO;
+	unsigned int layerVBO; // 0 until SetTextureLayer()
+	// u_MeshDequantize of the shader (and its program) last drawn with, resolved again when either changes
+	Shader* dequantizeShader;
+	unsigned int dequantizeProgram;
+	UniformHandle dequantizeHandle;
 
 	// Functions
-	void setupMesh() 
+	void deleteObjects()
+	{
+		if (VAO != 0)
+		{
+			glDeleteVertexArrays(1, &VAO);
+			GLStateCache::OnVertexArrayDeleted(VAO);
+		}
+		// glDeleteBuffers ignores the names that are 0
+		glDeleteBuffers(1, &VBO);
+		glDeleteBuffers(1, &EBO);
+		glDeleteBuffers(1, &layerVBO);
+		VAO = VBO = EBO = layerVBO = 0;
+	}
+
+	void setVertexUniforms(Shader* shaderProgram)
+	{
+		if (vertexFormat != MESH_VERTEX_COMPACT)
+			return;
+		if (shaderProgram != dequantizeShader || shaderProgram->GetRendererID() != dequantizeProgram)
+		{
+			dequantizeShader = shaderProgram;
+			dequantizeProgram = shaderProgram->GetRendererID();
+			dequantizeHandle = shaderProgram->GetUniformHandle("u_MeshDequantize");
+		}
+		shaderProgram->SetVec4(dequantizeHandle, dequantize);
+	}
+
+	void setupMesh(const Vertex* vertexData, const unsigned int* indexData) 
 	{
 		// create buffers/arrays
 		glGenVertexArrays(1, &VAO);
 		glGenBuffers(1, &VBO);
 		glGenBuffers(1, &EBO);
 
-		glBindVertexArray(VAO);
+		GLStateCache::BindVertexArray(VAO);
 		// load data into vertex buffers
 		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		// A great thing about structs is that their memory layout is sequential for all its items.
-		// The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
-		// again translates to 3/2 floats which translates to a byte array.
-		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+		if (vertexFormat == MESH_VERTEX_COMPACT)
+		{
+			// Quantized in the mesh's own bounds, decoded by the shader's COMPACT_VERTEX variant
+			glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+			for (unsigned int i = 0; i < numVertices; i++)
+			{
+				boundsMin = i == 0 ? vertexData[i].Position : glm::min(boundsMin, vertexData[i].Position);
+				boundsMax = i == 0 ? vertexData[i].Position : glm::max(boundsMax, vertexData[i].Position);
+			}
+			dequantize = VertexCompressor::GetDequantize(boundsMin, boundsMax);
+			vector<CompactVertex> compactVertices;
+			VertexCompressor::Compress(vertexData, numVertices, dequantize, compactVertices);
+			glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(CompactVertex), compactVertices.data(), GL_STATIC_DRAW);
+			VertexArray::SetAttributes(VertexCompressor::GetLayout());
+		}
+		else
+		{
+			dequantize = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+			// A great thing about structs is that their memory layout is sequential for all its items.
+			// The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
+			// again translates to 3/2 floats which translates to a byte array.
+			glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vertex), vertexData, GL_STATIC_DRAW);
+
+			// set the vertex attribute pointers
+			// vertex Positions
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+			// vertex normals
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+			// vertex texture coords
+			glEnableVertexAttribArray(2);
+			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+			// vertex tangent
+			glEnableVertexAttribArray(3);
+			glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
+			// vertex bitangent
+			glEnableVertexAttribArray(4);
+			glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+		}
 
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-		// set the vertex attribute pointers
-		// vertex Positions
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-		// vertex normals
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-		// vertex texture coords
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-		// vertex tangent
-		glEnableVertexAttribArray(3);
-		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
-		// vertex bitangent
-		glEnableVertexAttribArray(4);
-		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndices * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
 		// Unbind VAO
-		glBindVertexArray(0);
+		GLStateCache::BindVertexArray(0);
 	}
 
 };
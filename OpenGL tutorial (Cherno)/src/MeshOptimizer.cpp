@@ -0,0 +1,334 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+unsigned int MeshOptimizer::s_Flags = MESH_OPTIMIZE_ALL;
+
+// Forsyth's LRU cache model and scoring constants, as given in his article
+static const unsigned int SCORING_CACHE_SIZE = 32;
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+static const unsigned int NO_TRIANGLE = ~0u;
+
+// cachePosition is -1 for a vertex outside the cache
+static float GetVertexScore(int cachePosition, unsigned int numTrianglesLeft)
+{
+	if (numTrianglesLeft == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// The vertices of the triangle just drawn all get the same score, whichever order they were in
+		if (cachePosition < 3)
+			score = LAST_TRIANGLE_SCORE;
+		else
+			score = powf(1.0f - (cachePosition - 3) / (float)(SCORING_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+	}
+	// Finishing off vertices with few triangles left avoids coming back for them once they've been evicted
+	return score + VALENCE_BOOST_SCALE * powf((float)numTrianglesLeft, -VALENCE_BOOST_POWER);
+}
+
+// FIFO post-transform cache, a vertex is still cached while fewer than size misses have happened since its own
+struct FifoCache
+{
+	std::vector<unsigned int> Timestamps;
+	unsigned int Time;
+	unsigned int Size;
+
+	FifoCache(size_t numVertices, unsigned int size)
+		: Timestamps(numVertices, 0), Time(size + 1), Size(size)
+	{
+	}
+
+	// Returns the number of vertices of the triangle that had to be transformed
+	unsigned int Draw(const unsigned int* triangle)
+	{
+		unsigned int misses = 0;
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			unsigned int vertex = triangle[i];
+			if (Time - Timestamps[vertex] > Size)
+			{
+				Timestamps[vertex] = Time++;
+				misses++;
+			}
+		}
+		return misses;
+	}
+
+	void Flush()
+	{
+		Time += Size + 1;
+	}
+};
+
+void MeshOptimizer::Optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, MeshOptimizeReport& report)
+{
+	report.NumTriangles = indices.size() / 3;
+	report.Before = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+
+	if (s_Flags & MESH_OPTIMIZE_VERTEX_CACHE)
+		OptimizeVertexCache(indices.data(), indices.size(), vertices.size());
+	if (s_Flags & MESH_OPTIMIZE_OVERDRAW)
+		OptimizeOverdraw(indices.data(), indices.size(), vertices.data(), vertices.size());
+	if (s_Flags & MESH_OPTIMIZE_VERTEX_FETCH)
+		vertices.resize(OptimizeVertexFetch(vertices.data(), vertices.size(), indices.data(), indices.size()));
+
+	report.After = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* indices, size_t numIndices, size_t numVertices)
+{
+	size_t numTriangles = numIndices / 3;
+	if (numTriangles == 0)
+		return;
+	std::vector<unsigned int> input(indices, indices + numTriangles * 3);
+
+	// The triangles using each vertex, as ranges of one array. The first trianglesLeft[v] of a vertex's range are
+	// the ones not drawn yet.
+	std::vector<unsigned int> trianglesLeft(numVertices, 0);
+	for (unsigned int index : input)
+		trianglesLeft[index]++;
+	std::vector<unsigned int> firstTriangle(numVertices + 1, 0);
+	for (size_t i = 0; i < numVertices; i++)
+		firstTriangle[i + 1] = firstTriangle[i] + trianglesLeft[i];
+	std::vector<unsigned int> vertexTriangles(input.size());
+	std::vector<unsigned int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+	for (size_t i = 0; i < input.size(); i++)
+		vertexTriangles[fill[input[i]]++] = i / 3;
+
+	std::vector<int> cachePositions(numVertices, -1);
+	std::vector<float> vertexScores(numVertices);
+	for (size_t i = 0; i < numVertices; i++)
+		vertexScores[i] = GetVertexScore(-1, trianglesLeft[i]);
+	std::vector<float> triangleScores(numTriangles);
+	for (size_t i = 0; i < numTriangles; i++)
+		triangleScores[i] = vertexScores[input[i * 3]] + vertexScores[input[i * 3 + 1]] + vertexScores[input[i * 3 + 2]];
+	std::vector<bool> drawn(numTriangles, false);
+
+	unsigned int bestTriangle = (unsigned int)(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+	size_t nextUndrawn = 0;
+	// Room for the three vertices pushing the rest of the cache back before the ones past its end are evicted
+	unsigned int cache[SCORING_CACHE_SIZE + 3];
+	unsigned int cacheSize = 0;
+	for (size_t i = 0; i < numTriangles; i++)
+	{
+		// Dead end, no cached vertex has a triangle left: carry on from the first triangle not drawn yet
+		if (bestTriangle == NO_TRIANGLE)
+		{
+			while (drawn[nextUndrawn])
+				nextUndrawn++;
+			bestTriangle = nextUndrawn;
+		}
+
+		const unsigned int* triangle = &input[bestTriangle * 3];
+		std::copy(triangle, triangle + 3, indices + i * 3);
+		drawn[bestTriangle] = true;
+
+		unsigned int newCache[SCORING_CACHE_SIZE + 3];
+		unsigned int newCacheSize = 0;
+		for (unsigned int j = 0; j < 3; j++)
+		{
+			unsigned int vertex = triangle[j];
+			unsigned int* begin = &vertexTriangles[firstTriangle[vertex]];
+			unsigned int* end = begin + trianglesLeft[vertex];
+			std::iter_swap(std::find(begin, end, bestTriangle), end - 1);
+			trianglesLeft[vertex]--;
+			// A degenerate triangle names a vertex twice, it only takes one cache entry
+			if (std::find(newCache, newCache + newCacheSize, vertex) == newCache + newCacheSize)
+				newCache[newCacheSize++] = vertex;
+		}
+		for (unsigned int j = 0; j < cacheSize; j++)
+		{
+			if (std::find(triangle, triangle + 3, cache[j]) == triangle + 3)
+				newCache[newCacheSize++] = cache[j];
+		}
+
+		// Rescore every vertex whose cache position changed, including the evicted ones, and their triangles
+		for (unsigned int j = 0; j < newCacheSize; j++)
+		{
+			unsigned int vertex = newCache[j];
+			cachePositions[vertex] = j < SCORING_CACHE_SIZE ? (int)j : -1;
+			float score = GetVertexScore(cachePositions[vertex], trianglesLeft[vertex]);
+			float change = score - vertexScores[vertex];
+			vertexScores[vertex] = score;
+			const unsigned int* triangles = &vertexTriangles[firstTriangle[vertex]];
+			for (unsigned int k = 0; k < trianglesLeft[vertex]; k++)
+				triangleScores[triangles[k]] += change;
+		}
+		cacheSize = std::min(newCacheSize, SCORING_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheSize, cache);
+
+		// Only the triangles of cached vertices are candidates, the rest score lower than they did before
+		bestTriangle = NO_TRIANGLE;
+		float bestScore = -1.0f;
+		for (unsigned int j = 0; j < cacheSize; j++)
+		{
+			unsigned int vertex = cache[j];
+			const unsigned int* triangles = &vertexTriangles[firstTriangle[vertex]];
+			for (unsigned int k = 0; k < trianglesLeft[vertex]; k++)
+			{
+				if (triangleScores[triangles[k]] > bestScore)
+				{
+					bestScore = triangleScores[triangles[k]];
+					bestTriangle = triangles[k];
+				}
+			}
+		}
+	}
+}
+
+void MeshOptimizer::OptimizeOverdraw(unsigned int* indices, size_t numIndices, const Vertex* vertices, size_t numVertices, float threshold)
+{
+	size_t numTriangles = numIndices / 3;
+	if (numTriangles == 0)
+		return;
+
+	// Hard boundaries, where every vertex of a triangle misses: the cache optimized order started over there, so
+	// moving what follows costs nothing
+	std::vector<size_t> hardStarts;
+	FifoCache cache(numVertices, MESH_OPTIMIZER_CACHE_SIZE);
+	for (size_t i = 0; i < numTriangles; i++)
+	{
+		if (cache.Draw(indices + i * 3) == 3 || i == 0)
+			hardStarts.push_back(i);
+	}
+	hardStarts.push_back(numTriangles);
+
+	// Soft boundaries split those further, wherever the ACMR since the last boundary (with the cache flushed
+	// there) is back within threshold of the whole cluster's
+	std::vector<size_t> clusterStarts;
+	for (size_t i = 0; i + 1 < hardStarts.size(); i++)
+	{
+		size_t start = hardStarts[i], end = hardStarts[i + 1];
+		cache.Flush();
+		unsigned int misses = 0;
+		for (size_t j = start; j < end; j++)
+			misses += cache.Draw(indices + j * 3);
+		float limit = threshold * misses / (end - start);
+
+		cache.Flush();
+		clusterStarts.push_back(start);
+		size_t clusterStart = start;
+		unsigned int clusterMisses = 0;
+		for (size_t j = start; j < end; j++)
+		{
+			clusterMisses += cache.Draw(indices + j * 3);
+			if (j + 1 < end && clusterMisses <= limit * (j + 1 - clusterStart))
+			{
+				cache.Flush();
+				clusterStarts.push_back(j + 1);
+				clusterStart = j + 1;
+				clusterMisses = 0;
+			}
+		}
+	}
+	clusterStarts.push_back(numTriangles);
+
+	// Area weighted centre and normal of each cluster (the cross product's length is twice the triangle's area)
+	struct Cluster
+	{
+		size_t Start, End;
+		glm::vec3 Centroid, Normal;
+		float Area;
+		float SortKey;
+	};
+	std::vector<Cluster> clusters(clusterStarts.size() - 1);
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	for (size_t i = 0; i < clusters.size(); i++)
+	{
+		Cluster& cluster = clusters[i];
+		cluster.Start = clusterStarts[i];
+		cluster.End = clusterStarts[i + 1];
+		cluster.Centroid = cluster.Normal = glm::vec3(0.0f);
+		cluster.Area = 0.0f;
+		for (size_t j = cluster.Start; j < cluster.End; j++)
+		{
+			const glm::vec3& a = vertices[indices[j * 3]].Position;
+			const glm::vec3& b = vertices[indices[j * 3 + 1]].Position;
+			const glm::vec3& c = vertices[indices[j * 3 + 2]].Position;
+			glm::vec3 normal = glm::cross(b - a, c - a);
+			float area = glm::length(normal);
+			cluster.Centroid += (a + b + c) * (area / 3.0f);
+			cluster.Normal += normal;
+			cluster.Area += area;
+		}
+		meshCentroid += cluster.Centroid;
+		meshArea += cluster.Area;
+		if (cluster.Area > 0.0f)
+			cluster.Centroid /= cluster.Area;
+	}
+	if (meshArea > 0.0f)
+		meshCentroid /= meshArea;
+
+	// Clusters facing away from the centre are on the outside of the mesh, drawing them first lets the depth test
+	// reject the clusters they cover
+	for (Cluster& cluster : clusters)
+	{
+		float normalLength = glm::length(cluster.Normal);
+		cluster.SortKey = normalLength > 0.0f ? glm::dot(cluster.Centroid - meshCentroid, cluster.Normal / normalLength) : 0.0f;
+	}
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.SortKey > b.SortKey; });
+
+	std::vector<unsigned int> input(indices, indices + numTriangles * 3);
+	unsigned int* output = indices;
+	for (const Cluster& cluster : clusters)
+		output = std::copy(input.begin() + cluster.Start * 3, input.begin() + cluster.End * 3, output);
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(Vertex* vertices, size_t numVertices, unsigned int* indices, size_t numIndices)
+{
+	// New position of each vertex: in the order of first use, then the unused ones
+	std::vector<unsigned int> remap(numVertices, ~0u);
+	unsigned int numUsed = 0;
+	for (size_t i = 0; i < numIndices; i++)
+	{
+		unsigned int& position = remap[indices[i]];
+		if (position == ~0u)
+			position = numUsed++;
+		indices[i] = position;
+	}
+	unsigned int numRemapped = numUsed;
+	for (unsigned int& position : remap)
+	{
+		if (position == ~0u)
+			position = numRemapped++;
+	}
+
+	std::vector<Vertex> input(vertices, vertices + numVertices);
+	for (size_t i = 0; i < numVertices; i++)
+		vertices[remap[i]] = input[i];
+	return numUsed;
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, size_t numIndices, size_t numVertices, unsigned int cacheSize)
+{
+	size_t numTriangles = numIndices / 3;
+	FifoCache cache(numVertices, cacheSize);
+	unsigned int misses = 0;
+	for (size_t i = 0; i < numTriangles; i++)
+		misses += cache.Draw(indices + i * 3);
+
+	// Vertices no triangle uses can't be transformed, they don't count
+	std::vector<bool> used(numVertices, false);
+	size_t numUsed = 0;
+	for (size_t i = 0; i < numTriangles * 3; i++)
+	{
+		if (!used[indices[i]])
+		{
+			used[indices[i]] = true;
+			numUsed++;
+		}
+	}
+
+	VertexCacheStats stats;
+	stats.ACMR = numTriangles > 0 ? (float)misses / numTriangles : 0.0f;
+	stats.ATVR = numUsed > 0 ? (float)misses / numUsed : 0.0f;
+	return stats;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include "Vertex.h"
+
+// Size of the FIFO post-transform cache simulated for the statistics and the overdraw clusters
+#define MESH_OPTIMIZER_CACHE_SIZE 16
+// How much worse than the cache optimized order the overdraw pass may make the ACMR
+#define MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+
+// Passes run by MeshOptimizer::Optimize(), in this order
+enum MeshOptimizeFlags {
+	MESH_OPTIMIZE_VERTEX_CACHE = 1 << 0,	// Triangle order for the post-transform vertex cache
+	MESH_OPTIMIZE_OVERDRAW = 1 << 1,		// Then clusters of those triangles, outward facing ones first
+	MESH_OPTIMIZE_VERTEX_FETCH = 1 << 2,	// Vertex order following the triangles
+	MESH_OPTIMIZE_ALL = MESH_OPTIMIZE_VERTEX_CACHE | MESH_OPTIMIZE_OVERDRAW | MESH_OPTIMIZE_VERTEX_FETCH
+};
+
+// How well an index order uses the post-transform cache
+struct VertexCacheStats
+{
+	float ACMR;	// Average cache miss ratio, vertices transformed per triangle (3 at worst, around 0.5 for a regular grid)
+	float ATVR;	// Average transform to vertex ratio, vertices transformed per vertex (1 at best)
+};
+
+// What Optimize() did to one mesh
+struct MeshOptimizeReport
+{
+	unsigned int NumTriangles;
+	VertexCacheStats Before, After;
+};
+
+// Reorders the triangles and vertices of an indexed triangle list so the GPU does less work drawing it, without
+// changing what is drawn. Model runs it on every mesh it imports (the cooked model stores the result):
+// - the vertex cache pass is Tom Forsyth's "Linear-Speed Vertex Cache Optimisation": triangles are emitted
+//   greedily by a score favouring vertices that are in a simulated LRU cache and those with few triangles left
+// - the overdraw pass follows Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw":
+//   the cache optimized order is cut into clusters wherever the cache starts over, and the clusters facing away
+//   from the mesh's centre are drawn first, so they hide what is behind them. Cuts are only made where they cost
+//   less than MESH_OPTIMIZER_OVERDRAW_THRESHOLD of the ACMR.
+// - the vertex fetch pass renumbers vertices in the order the triangles first use them, so the vertex shader reads
+//   the buffer front to back, and drops vertices no triangle uses
+class MeshOptimizer
+{
+public:
+	// Runs the passes of GetFlags() on a triangle list and measures the cache before and after
+	static void Optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, MeshOptimizeReport& report);
+
+	static void OptimizeVertexCache(unsigned int* indices, size_t numIndices, size_t numVertices);
+	// Expects indices already optimized for the vertex cache
+	static void OptimizeOverdraw(unsigned int* indices, size_t numIndices, const Vertex* vertices, size_t numVertices, float threshold = MESH_OPTIMIZER_OVERDRAW_THRESHOLD);
+	// Returns the number of vertices left, the unused ones having been moved past the end
+	static size_t OptimizeVertexFetch(Vertex* vertices, size_t numVertices, unsigned int* indices, size_t numIndices);
+
+	// Simulates a FIFO cache of cacheSize vertices drawing the triangles
+	static VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, size_t numIndices, size_t numVertices, unsigned int cacheSize = MESH_OPTIMIZER_CACHE_SIZE);
+
+	// MeshOptimizeFlags of the passes Model runs, all of them unless changed by --no-mesh-optimize or --no-overdraw-optimize.
+	// Part of the key of the cooked model, so changing them imports models again.
+	static void SetFlags(unsigned int flags) { s_Flags = flags; }
+	static unsigned int GetFlags() { return s_Flags; }
+
+private:
+	static unsigned int s_Flags;
+};
@@ -0,0 +1,254 @@
+#include "MipmapGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIPMAP_GENERATOR_SSE2
+#endif
+
+// Kaiser window: radius in destination pixels, and shape (larger alpha trades sharpness for less ringing)
+static const float KAISER_RADIUS = 3.0f;
+static const float KAISER_ALPHA = 4.0f;
+static const float PI = 3.14159265358979f;
+
+// Resolution of the linear light -> 8-bit sRGB table (fine enough to round correctly near black)
+static const int LINEAR_TO_SRGB_SIZE = 16384;
+
+// 8-bit <-> float conversions, built once (function local statics are initialized thread safely)
+struct ConversionTables
+{
+	float UnormToFloat[256];
+	float SRGBToLinear[256];
+	unsigned char LinearToSRGB[LINEAR_TO_SRGB_SIZE];
+
+	ConversionTables()
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			float value = i / 255.0f;
+			UnormToFloat[i] = value;
+			SRGBToLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int i = 0; i < LINEAR_TO_SRGB_SIZE; i++)
+		{
+			float value = i / (float)(LINEAR_TO_SRGB_SIZE - 1);
+			float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+			LinearToSRGB[i] = (unsigned char)(encoded * 255.0f + 0.5f);
+		}
+	}
+};
+
+static const ConversionTables& GetTables()
+{
+	static ConversionTables tables;
+	return tables;
+}
+
+// One RGBA pixel, the only type the resampling loops work with
+#ifdef MIPMAP_GENERATOR_SSE2
+typedef __m128 Pixel;
+static inline Pixel PixelZero() { return _mm_setzero_ps(); }
+static inline Pixel PixelLoad(const float* p) { return _mm_loadu_ps(p); }
+static inline void PixelStore(float* p, Pixel pixel) { _mm_storeu_ps(p, pixel); }
+static inline Pixel PixelMulAdd(Pixel sum, Pixel pixel, float weight) { return _mm_add_ps(sum, _mm_mul_ps(pixel, _mm_set1_ps(weight))); }
+#else
+struct Pixel { float r, g, b, a; };
+static inline Pixel PixelZero() { Pixel pixel = { 0.0f, 0.0f, 0.0f, 0.0f }; return pixel; }
+static inline Pixel PixelLoad(const float* p) { Pixel pixel = { p[0], p[1], p[2], p[3] }; return pixel; }
+static inline void PixelStore(float* p, Pixel pixel) { p[0] = pixel.r; p[1] = pixel.g; p[2] = pixel.b; p[3] = pixel.a; }
+static inline Pixel PixelMulAdd(Pixel sum, Pixel pixel, float weight)
+{
+	Pixel result = { sum.r + pixel.r * weight, sum.g + pixel.g * weight, sum.b + pixel.b * weight, sum.a + pixel.a * weight };
+	return result;
+}
+#endif
+
+// Source pixels and weights contributing to each destination pixel along one axis (NumTaps per pixel, clamped to the edge)
+struct FilterTaps
+{
+	int NumTaps;
+	std::vector<int> Indices;
+	std::vector<float> Weights;
+};
+
+// Zeroth order modified Bessel function of the first kind (series expansion)
+static float BesselI0(float x)
+{
+	float sum = 1.0f, term = 1.0f;
+	float halfX = x * 0.5f;
+	for (int k = 1; k < 20; k++)
+	{
+		term *= (halfX / k) * (halfX / k);
+		sum += term;
+	}
+	return sum;
+}
+
+static float KaiserSinc(float distance)
+{
+	float t = distance / KAISER_RADIUS;
+	if (t <= -1.0f || t >= 1.0f)
+		return 0.0f;
+	float sinc = distance == 0.0f ? 1.0f : std::sin(PI * distance) / (PI * distance);
+	return sinc * BesselI0(KAISER_ALPHA * std::sqrt(1.0f - t * t)) / BesselI0(KAISER_ALPHA);
+}
+
+static void ComputeTaps(int srcSize, int dstSize, MipmapFilter filter, FilterTaps& taps)
+{
+	// Footprint of a destination pixel in source pixels (exactly 2 for even sizes)
+	float scale = (float)srcSize / dstSize;
+	float radius = filter == MIPMAP_KAISER ? KAISER_RADIUS * scale : 0.5f * scale;
+	taps.NumTaps = (int)std::ceil(radius * 2.0f) + 1;
+	taps.Indices.assign(dstSize * taps.NumTaps, 0);
+	taps.Weights.assign(dstSize * taps.NumTaps, 0.0f);
+
+	for (int x = 0; x < dstSize; x++)
+	{
+		float center = (x + 0.5f) * scale;
+		int first = (int)std::floor(center - radius);
+		float totalWeight = 0.0f;
+		for (int i = 0; i < taps.NumTaps; i++)
+		{
+			int source = first + i;
+			float weight;
+			if (filter == MIPMAP_KAISER)
+			{
+				weight = KaiserSinc((source + 0.5f - center) / scale);
+			}
+			else
+			{
+				// Coverage of the source pixel by the destination pixel's footprint
+				float overlap = std::min(source + 1.0f, center + radius) - std::max((float)source, center - radius);
+				weight = std::max(overlap, 0.0f);
+			}
+			taps.Indices[x * taps.NumTaps + i] = std::min(std::max(source, 0), srcSize - 1);
+			taps.Weights[x * taps.NumTaps + i] = weight;
+			totalWeight += weight;
+		}
+		for (int i = 0; i < taps.NumTaps; i++)
+			taps.Weights[x * taps.NumTaps + i] /= totalWeight;
+	}
+}
+
+// Converts a row of 8-bit source pixels to linear float RGBA
+static void DecodeRow(const unsigned char* src, int width, bool srgb, float* dst)
+{
+	const ConversionTables& tables = GetTables();
+	const float* colourTable = srgb ? tables.SRGBToLinear : tables.UnormToFloat;
+	for (int i = 0; i < width * 4; i += 4)
+	{
+		dst[i + 0] = colourTable[src[i + 0]];
+		dst[i + 1] = colourTable[src[i + 1]];
+		dst[i + 2] = colourTable[src[i + 2]];
+		dst[i + 3] = tables.UnormToFloat[src[i + 3]]; // Alpha is always linear
+	}
+}
+
+static void EncodeLevel(const float* src, int numPixels, bool srgb, unsigned char* dst)
+{
+	const ConversionTables& tables = GetTables();
+	for (int i = 0; i < numPixels * 4; i++)
+	{
+		float value = std::min(std::max(src[i], 0.0f), 1.0f);
+		if (srgb && (i & 3) != 3)
+			dst[i] = tables.LinearToSRGB[(int)(value * (LINEAR_TO_SRGB_SIZE - 1) + 0.5f)];
+		else
+			dst[i] = (unsigned char)(value * 255.0f + 0.5f);
+	}
+}
+
+// Resamples one level to the next. The source is either the 8-bit image (level 0) or the previous float level.
+static void ResampleLevel(const unsigned char* srcBytes, const float* srcFloats, int srcWidth, int srcHeight, bool srgb,
+	int dstWidth, int dstHeight, MipmapFilter filter, std::vector<float>& dst)
+{
+	FilterTaps horizontal, vertical;
+	ComputeTaps(srcWidth, dstWidth, filter, horizontal);
+	ComputeTaps(srcHeight, dstHeight, filter, vertical);
+
+	// Rows first: every source row is filtered down to the destination width
+	std::vector<float> rows((size_t)dstWidth * srcHeight * 4);
+	std::vector<float> decodedRow(srcBytes ? (size_t)srcWidth * 4 : 0);
+	for (int y = 0; y < srcHeight; y++)
+	{
+		const float* srcRow;
+		if (srcBytes)
+		{
+			DecodeRow(srcBytes + (size_t)y * srcWidth * 4, srcWidth, srgb, decodedRow.data());
+			srcRow = decodedRow.data();
+		}
+		else
+		{
+			srcRow = srcFloats + (size_t)y * srcWidth * 4;
+		}
+
+		float* dstRow = rows.data() + (size_t)y * dstWidth * 4;
+		for (int x = 0; x < dstWidth; x++)
+		{
+			const int* indices = &horizontal.Indices[x * horizontal.NumTaps];
+			const float* weights = &horizontal.Weights[x * horizontal.NumTaps];
+			Pixel sum = PixelZero();
+			for (int i = 0; i < horizontal.NumTaps; i++)
+				sum = PixelMulAdd(sum, PixelLoad(srcRow + indices[i] * 4), weights[i]);
+			PixelStore(dstRow + x * 4, sum);
+		}
+	}
+
+	// Then columns, walking each row of the output so the loads stay sequential
+	dst.assign((size_t)dstWidth * dstHeight * 4, 0.0f);
+	for (int y = 0; y < dstHeight; y++)
+	{
+		const int* indices = &vertical.Indices[y * vertical.NumTaps];
+		const float* weights = &vertical.Weights[y * vertical.NumTaps];
+		float* dstRow = dst.data() + (size_t)y * dstWidth * 4;
+		for (int x = 0; x < dstWidth; x++)
+		{
+			Pixel sum = PixelZero();
+			for (int i = 0; i < vertical.NumTaps; i++)
+				sum = PixelMulAdd(sum, PixelLoad(rows.data() + ((size_t)indices[i] * dstWidth + x) * 4), weights[i]);
+			PixelStore(dstRow + x * 4, sum);
+		}
+	}
+}
+
+unsigned int MipmapGenerator::GetNumLevels(int width, int height)
+{
+	unsigned int numLevels = 1;
+	for (int size = std::max(width, height); size > 1; size /= 2)
+		numLevels++;
+	return numLevels;
+}
+
+void MipmapGenerator::Generate(const unsigned char* pixels, int width, int height, bool srgb, MipmapFilter filter,
+	std::vector<unsigned char>& chain, std::vector<MipLevel>& levels)
+{
+	chain.clear();
+	levels.clear();
+	if (filter != MIPMAP_BOX && filter != MIPMAP_KAISER)
+		return;
+
+	unsigned int numLevels = GetNumLevels(width, height);
+	size_t chainSize = 0;
+	for (unsigned int i = 1; i < numLevels; i++)
+	{
+		MipLevel level;
+		level.Width = std::max(width >> i, 1);
+		level.Height = std::max(height >> i, 1);
+		level.Offset = chainSize;
+		chainSize += (size_t)level.Width * level.Height * 4;
+		levels.push_back(level);
+	}
+	chain.resize(chainSize);
+
+	std::vector<float> previous, current;
+	int srcWidth = width, srcHeight = height;
+	for (const MipLevel& level : levels)
+	{
+		ResampleLevel(previous.empty() ? pixels : nullptr, previous.data(), srcWidth, srcHeight, srgb, level.Width, level.Height, filter, current);
+		EncodeLevel(current.data(), level.Width * level.Height, srgb, chain.data() + level.Offset);
+		previous.swap(current);
+		srcWidth = level.Width;
+		srcHeight = level.Height;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// How a texture's mip chain is built
+enum MipmapFilter {
+	MIPMAP_NONE = 0,	// Level 0 only
+	MIPMAP_GPU,			// glGenerateMipmap() after the upload (driver's filter, usually a box)
+	MIPMAP_BOX,			// Box filter on the CPU
+	MIPMAP_KAISER		// Kaiser windowed sinc on the CPU, keeps more detail in distant levels without aliasing
+};
+
+// Size and position of one level within a mip chain buffer
+struct MipLevel
+{
+	int Width, Height;
+	size_t Offset;
+};
+
+// Builds mip chains for RGBA8 images on the CPU, off the GL thread (see TextureLoader).
+// Filtering happens in linear light for sRGB images, so bright and dark texels average to the right brightness
+// instead of darkening in the distance. Images are resampled separably (rows, then columns) with SSE2 when available,
+// and each level is built from the previous one at full float precision.
+class MipmapGenerator
+{
+public:
+	// Number of levels in a complete chain down to 1x1
+	static unsigned int GetNumLevels(int width, int height);
+
+	// Writes levels 1 to GetNumLevels() - 1 of the image, tightly packed one after the other, into chain.
+	// Level 0 is not copied, it is the source image itself.
+	static void Generate(const unsigned char* pixels, int width, int height, bool srgb, MipmapFilter filter,
+		std::vector<unsigned char>& chain, std::vector<MipLevel>& levels);
+};
@@ -17,205 +17,421 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <map>
+#include <memory>
+#include <set>
+#include <thread>
 #include <vector>
 #include <Shader.h>
 #include <Mesh.h>
+#include <TextureCache.h>
+#include <TextureArray.h>
+#include <CookedModel.h>
+#include <MeshOptimizer.h>
 using namespace std;
 
+// Post processing assimp applies on import, part of the key of the cooked model (see CookedModel).
+// Without JoinIdenticalVertices every corner of every face is a vertex of its own (OBJ files index positions,
+// normals and UVs separately), which leaves nothing for the post-transform cache to reuse.
+#define MODEL_IMPORT_FLAGS (aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_FlipUVs | aiProcess_CalcTangentSpace)
+
 class Model
 {
 public:
 
 	// Constructor
-	Model(const char* path)
+	// keepGeometry: whether the meshes keep a CPU copy of their vertices and indices once they're on the GPU.
+	// Drawing never needs it, only code reading the geometry back (Mesh::GetVertices/GetIndices), and dropping
+	// it halves the memory the model takes.
+	// vertexFormat: MESH_VERTEX_COMPACT uploads 20 byte quantized vertices instead of 56 byte ones, the shaders
+	// drawing the model then have to be built with COMPACT_VERTEX (see res/shaders/include/Vertex.glsl).
+	Model(const char* path, bool keepGeometry = true, MeshVertexFormat vertexFormat = MESH_VERTEX_FULL)
+		: keepGeometry(keepGeometry), vertexFormat(vertexFormat), textureArrayEnabled(false)
 	{
 		loadModel(path);
 	}
 
-	vector<Mesh> GetMeshes() { return meshes; }
-	void SetMeshes(vector<Mesh> newMeshes) { meshes = newMeshes; }
+	const vector<Mesh>& GetMeshes() const { return meshes; }
+	// Model space bounds of every vertex
+	const glm::vec3& GetBoundsMin() const { return boundsMin; }
+	const glm::vec3& GetBoundsMax() const { return boundsMax; }
+	void SetMeshes(vector<Mesh>&& newMeshes) { meshes = move(newMeshes); }
 
-	// Draw all the model's meshes
-	void Draw(Shader* shaderProgram)
+	// Packs the first diffuse texture of every mesh into one texture array (fallbackFilepath stands in for meshes
+	// without one) and gives each mesh its layer as a vertex attribute, so the whole model draws with a single
+	// texture bind. The images must all be the same size, otherwise the model keeps its per-mesh textures and
+	// false is returned. Enables the array on success.
+	bool UseTextureArray(const string& fallbackFilepath)
 	{
+		vector<string> layerPaths;
+		map<string, unsigned int> layerIndices;
+		vector<unsigned int> meshLayers;
+		for (unsigned int i = 0; i < meshes.size(); i++)
+		{
+			string path = fallbackFilepath;
+			for (const ModelTexture& texture : meshes[i].GetTextures())
+			{
+				if (texture.type == "texture_diffuse")
+				{
+					path = directory + '/' + texture.path.C_Str();
+					break;
+				}
+			}
+			auto layer = layerIndices.insert(make_pair(path, (unsigned int)layerPaths.size()));
+			if (layer.second)
+				layerPaths.push_back(path);
+			meshLayers.push_back(layer.first->second);
+		}
+
+		// Same format and orientation as the textures loaded by loadMaterialTextures()
+		unique_ptr<TextureArray> packed(new TextureArray(layerPaths, true, true));
+		if (!packed->IsValid())
+		{
+			cout << "[Warning] Model textures can't share a texture array, drawing with a texture per mesh instead" << endl;
+			return false;
+		}
+		for (unsigned int i = 0; i < meshes.size(); i++)
+			meshes[i].SetTextureLayer((float)meshLayers[i]);
+		textureArray = move(packed);
+		textureArrayEnabled = true;
+		return true;
+	}
+
+	// Switches between the texture array and the per-mesh textures, the shader passed to Draw() and Submit() has to
+	// match: sampler2DArray texture_diffuse_array and the layer at MESH_TEXTURE_LAYER_LOCATION, or texture_diffuseN
+	void SetTextureArrayEnabled(bool enabled) { textureArrayEnabled = enabled && textureArray; }
+	bool IsTextureArrayEnabled() const { return textureArrayEnabled; }
+	const TextureArray* GetTextureArray() const { return textureArray.get(); }
+
+	// Draw all the model's meshes, fallbackTextureID is the specular map of the texture array path (see Submit())
+	void Draw(Shader* shaderProgram, unsigned int fallbackTextureID = 0)
+	{
+		if (textureArrayEnabled)
+		{
+			bindTextureArray(shaderProgram, fallbackTextureID);
+			for (unsigned int i = 0; i < this->meshes.size(); i++)
+				meshes[i].DrawUntextured(shaderProgram);
+			return;
+		}
 		for (unsigned int i = 0; i < this->meshes.size(); i++)
 			meshes[i].Draw(shaderProgram);
 	}
 
 	// Draw all the model's meshes
-	void DrawInstanced(Shader* shaderProgram, unsigned int instanceCount)
+	void DrawInstanced(Shader* shaderProgram, unsigned int instanceCount, unsigned int fallbackTextureID = 0)
 	{
+		if (textureArrayEnabled)
+		{
+			bindTextureArray(shaderProgram, fallbackTextureID);
+			for (unsigned int i = 0; i < this->meshes.size(); i++)
+				meshes[i].DrawUntextured(shaderProgram, instanceCount);
+			return;
+		}
 		for (unsigned int i = 0; i < this->meshes.size(); i++)
 			meshes[i].DrawInstanced(shaderProgram, instanceCount);
 	}
 
+	// Queue all the model's meshes on the renderer, to be drawn by Renderer::Flush()
+	void Submit(Renderer& renderer, Shader* shaderProgram, const glm::mat4& modelMatrix, RenderPass pass, float depth, unsigned int fallbackTextureID = 0)
+	{
+		if (textureArrayEnabled)
+		{
+			// Every mesh gets the same textures, so they share a material and Flush() binds the array once
+			DrawCommand command;
+			command.Pass = pass;
+			command.Depth = depth;
+			command.Program = shaderProgram;
+			command.ModelMatrix = modelMatrix;
+			command.AddTexture(0, GL_TEXTURE_2D_ARRAY, textureArray->GetID(), "texture_diffuse_array");
+			// Always on unit 1, same as bindTextureArray()
+			command.AddTexture(1, GL_TEXTURE_2D, fallbackTextureID, "texture_specular0");
+			for (unsigned int i = 0; i < this->meshes.size(); i++)
+				meshes[i].Submit(renderer, command);
+			return;
+		}
+		for (unsigned int i = 0; i < this->meshes.size(); i++)
+			meshes[i].Submit(renderer, shaderProgram, modelMatrix, pass, depth, fallbackTextureID);
+	}
+
 private:
 
 	// Model Data 
 	vector<Mesh> meshes; 
 	string directory;
-	vector<ModelTexture> textures_loaded;
+	bool keepGeometry;
+	MeshVertexFormat vertexFormat;
+	set<shared_ptr<Texture>> textures_loaded;
 
-	// Import model into memory using assimp
+	// A mesh converted from assimp's format on a worker thread, waiting for its GL upload
+	struct ImportedMesh
+	{
+		vector<Vertex> vertices;
+		vector<unsigned int> indices;
+		vector<string> textureTypes;
+		vector<string> texturePaths;	// Relative to the model's directory
+		bool optimized;
+		MeshOptimizeReport optimizeReport;
+	};
+	glm::vec3 boundsMin, boundsMax;
+	unique_ptr<TextureArray> textureArray; // Built by UseTextureArray()
+	bool textureArrayEnabled;
+
+	// The specular sampler2D moves to unit 1 even without a fallback texture, it can't share unit 0 with the
+	// sampler2DArray (two sampler types on one unit fail the draw with GL_INVALID_OPERATION)
+	void bindTextureArray(Shader* shaderProgram, unsigned int fallbackTextureID)
+	{
+		textureArray->Bind(0);
+		shaderProgram->SetInt("texture_diffuse_array", 0);
+		GLStateCache::ActiveTexture(GL_TEXTURE1);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, fallbackTextureID);
+		GLStateCache::ActiveTexture(GL_TEXTURE0);
+		shaderProgram->SetInt("texture_specular0", 1);
+	}
+
+	// Import model into memory using assimp, or from the cooked copy of an earlier import
 	void loadModel(const string& path)
 	{
+		directory = path.substr(0, path.find_last_of('/'));
+		boundsMin = boundsMax = glm::vec3(0.0f);
+		if (CookedModel::IsEnabled())
+		{
+			CookedModel cooked(path, MODEL_IMPORT_FLAGS, MeshOptimizer::GetFlags(), sizeof(Vertex));
+			if (cooked.IsValid())
+			{
+				loadCookedModel(cooked);
+				return;
+			}
+		}
+
 		Assimp::Importer importer;
-		const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+		const aiScene* scene = importer.ReadFile(path, MODEL_IMPORT_FLAGS);
 		
 		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
 		{
 			cout << "ERROR::ASSIMP::" << importer.GetErrorString() << endl;
 			return;
 		}
-		directory = path.substr(0, path.find_last_of('/'));
 		processNode(scene->mRootNode, scene);
+		computeBounds();
+
+		// So the next load can skip assimp
+		if (CookedModel::IsEnabled())
+			writeCookedModel(path);
+
+		if (!keepGeometry)
+		{
+			for (Mesh& mesh : meshes)
+				mesh.ReleaseGeometry();
+		}
 	}
 
-	// Recursively process assimp mesh nodes, then their children
-	void processNode(aiNode* node, const aiScene* scene)
+	// Creates the meshes straight from the cooked file's mapping. Without keepGeometry the geometry is uploaded from
+	// the mapping and no CPU copy remains once loadModel() returns and unmaps it.
+	void loadCookedModel(const CookedModel& cooked)
 	{
-		// process all of this nodes meshes
-		for (unsigned int i = 0; i < node->mNumMeshes; i++)
+		const CookedModelHeader& header = cooked.GetHeader();
+		const Vertex* cookedVertices = (const Vertex*)cooked.GetVertices();
+		const unsigned int* cookedIndices = cooked.GetIndices();
+		meshes.reserve(header.NumMeshes);
+		for (unsigned int i = 0; i < header.NumMeshes; i++)
+		{
+			const CookedModelMesh& mesh = cooked.GetMesh(i);
+			Span<const Vertex> meshVertices(cookedVertices + mesh.FirstVertex, mesh.NumVertices);
+			Span<const unsigned int> meshIndices(cookedIndices + mesh.FirstIndex, mesh.NumIndices);
+			vector<ModelTexture> meshTextures;
+			for (unsigned int j = 0; j < mesh.NumTextures; j++)
+			{
+				const CookedModelTexture& texture = cooked.GetTexture(mesh.FirstTexture + j);
+				meshTextures.push_back(loadTexture(cooked.GetString(texture.Path), cooked.GetString(texture.Type)));
+			}
+			if (keepGeometry)
+				meshes.push_back(Mesh(vector<Vertex>(meshVertices.begin(), meshVertices.end()), vector<unsigned int>(meshIndices.begin(), meshIndices.end()), move(meshTextures), vertexFormat));
+			else
+				meshes.push_back(Mesh(meshVertices, meshIndices, move(meshTextures), vertexFormat));
+		}
+		boundsMin = glm::vec3(header.BoundsMin[0], header.BoundsMin[1], header.BoundsMin[2]);
+		boundsMax = glm::vec3(header.BoundsMax[0], header.BoundsMax[1], header.BoundsMax[2]);
+	}
+
+	void writeCookedModel(const string& path)
+	{
+		vector<CookedModelMeshSource> sources(meshes.size());
+		for (unsigned int i = 0; i < meshes.size(); i++)
 		{
-			aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-			meshes.push_back(processMesh(mesh, scene));
+			CookedModelMeshSource& source = sources[i];
+			source.Vertices = meshes[i].GetVertices().GetData();
+			source.NumVertices = meshes[i].GetVertices().GetSize();
+			source.Indices = meshes[i].GetIndices().GetData();
+			source.NumIndices = meshes[i].GetIndices().GetSize();
+			for (const ModelTexture& texture : meshes[i].GetTextures())
+			{
+				source.TextureTypes.push_back(texture.type);
+				source.TexturePaths.push_back(texture.path.C_Str());
+			}
+		}
+		CookedModel::Write(path, MODEL_IMPORT_FLAGS, MeshOptimizer::GetFlags(), sizeof(Vertex), glm::value_ptr(boundsMin), glm::value_ptr(boundsMax), sources);
+	}
+
+	void computeBounds()
+	{
+		bool first = true;
+		for (const Mesh& mesh : meshes)
+		{
+			for (const Vertex& vertex : mesh.GetVertices())
+			{
+				boundsMin = first ? vertex.Position : glm::min(boundsMin, vertex.Position);
+				boundsMax = first ? vertex.Position : glm::max(boundsMax, vertex.Position);
+				first = false;
+			}
 		}
-		// then do the same for each of its children
+	}
+
+	// Gathers the meshes of node and then of its children, in the order they're drawn
+	void collectMeshes(const aiNode* node, vector<unsigned int>& meshIndices)
+	{
+		for (unsigned int i = 0; i < node->mNumMeshes; i++)
+			meshIndices.push_back(node->mMeshes[i]);
 		for (unsigned int i = 0; i < node->mNumChildren; i++)
+			collectMeshes(node->mChildren[i], meshIndices);
+	}
+
+	// Converts every mesh under node in two phases: the CPU work on worker threads, then the GL buffers and
+	// textures on this (the context) thread
+	void processNode(aiNode* node, const aiScene* scene)
+	{
+		vector<unsigned int> meshIndices;
+		collectMeshes(node, meshIndices);
+
+		// Meshes are independent of each other, so each thread takes the next one left until there are none
+		// (meshes vary a lot in size, so handing them out one at a time balances better than fixed shares)
+		vector<ImportedMesh> imported(meshIndices.size());
+		atomic<unsigned int> nextMesh(0);
+		auto convertMeshes = [&]()
+		{
+			for (unsigned int i = nextMesh++; i < imported.size(); i = nextMesh++)
+				processMesh(scene->mMeshes[meshIndices[i]], scene, imported[i]);
+		};
+		unsigned int numThreads = min(max(thread::hardware_concurrency(), 1u), (unsigned int)imported.size());
+		vector<thread> threads;
+		for (unsigned int i = 1; i < numThreads; i++)
+			threads.push_back(thread(convertMeshes));
+		convertMeshes();
+		for (thread& worker : threads)
+			worker.join();
+
+		// Printed here rather than by the workers, so the lines don't interleave
+		for (unsigned int i = 0; i < imported.size(); i++)
 		{
-			processNode(node->mChildren[i], scene);
+			if (!imported[i].optimized)
+				continue;
+			const MeshOptimizeReport& report = imported[i].optimizeReport;
+			char line[512];
+			snprintf(line, sizeof(line), "Mesh optimizer: %s/%s, %u triangles: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+				directory.c_str(), scene->mMeshes[meshIndices[i]]->mName.C_Str(), report.NumTriangles,
+				report.Before.ACMR, report.After.ACMR, report.Before.ATVR, report.After.ATVR);
+			cout << line << endl;
+		}
+
+		meshes.reserve(meshes.size() + imported.size());
+		for (ImportedMesh& mesh : imported)
+		{
+			vector<ModelTexture> meshTextures;
+			for (unsigned int i = 0; i < mesh.texturePaths.size(); i++)
+				meshTextures.push_back(loadTexture(mesh.texturePaths[i], mesh.textureTypes[i]));
+			meshes.push_back(Mesh(move(mesh.vertices), move(mesh.indices), move(meshTextures), vertexFormat));
 		}
 	}
 
-	Mesh processMesh(aiMesh* mesh, const aiScene* scene)
+	// Runs on a worker thread, so it only reads the scene and fills in imported (no GL calls or texture loads)
+	void processMesh(const aiMesh* mesh, const aiScene* scene, ImportedMesh& imported)
 	{
 		// 3 sections to processing a mesh:
 		// - retrieving all the vertex data 
-		// - retrieving the meshs indices
+		// - retrieving the meshs indices
 		// - retrieving the relevant material data
-		vector<Vertex> meshVertices;
-		vector<unsigned int> meshIndices;
-		vector<ModelTexture> meshTextures;
-		// For each vertex in the mesh ...
+		// The output arrays are sized up front and written in place
+		imported.vertices.resize(mesh->mNumVertices);
 		for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 		{
-			Vertex meshVertex;
+			Vertex& meshVertex = imported.vertices[i];
 			// process the vertex's positions
-			glm::vec3 posVector;
-			posVector.x = mesh->mVertices[i].x;
-			posVector.y = mesh->mVertices[i].y;
-			posVector.z = mesh->mVertices[i].z;
-			meshVertex.Position = posVector;
+			meshVertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
 			// process the vertex's  normals 
-			glm::vec3 normVector;
-			normVector.x = mesh->mNormals[i].x;
-			normVector.y = mesh->mNormals[i].y;
-			normVector.z = mesh->mNormals[i].z;
-			meshVertex.Normal = normVector;
+			meshVertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
 			// process the vertex's texture coords
 			if (mesh->mTextureCoords[0]) 
-			{
-				glm::vec2 texCoordsVec;
-				texCoordsVec.x = mesh->mTextureCoords[0][i].x;
-				texCoordsVec.y = mesh->mTextureCoords[0][i].y;
-				meshVertex.TexCoords = texCoordsVec;
-			} else {
+				meshVertex.TexCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+			else
 				meshVertex.TexCoords = glm::vec2(0.0f, 0.0f);
+			// Tangents need texture coords to be calculated, otherwise they're left at zero
+			if (mesh->mTangents && mesh->mBitangents)
+			{
+				meshVertex.Tangent = glm::vec3(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z);
+				meshVertex.Bitangent = glm::vec3(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z);
+			}
+			else
+			{
+				meshVertex.Tangent = glm::vec3(0.0f);
+				meshVertex.Bitangent = glm::vec3(0.0f);
 			}
-
-			// push the vertex
-			meshVertices.push_back(meshVertex);
 		}
-		// Process all the mesh's indices
+		// Process all the mesh's indices (3 per face once triangulated, but points and lines can remain)
+		size_t numIndices = 0;
+		for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+			numIndices += mesh->mFaces[i].mNumIndices;
+		imported.indices.resize(numIndices);
+		unsigned int* index = imported.indices.data();
 		for (unsigned int i = 0; i < mesh->mNumFaces; i++)
 		{
-			aiFace face = mesh->mFaces[i];
+			const aiFace& face = mesh->mFaces[i];
 			for (unsigned int j = 0; j < face.mNumIndices; j++)
-				meshIndices.push_back(face.mIndices[j]);
+				*index++ = face.mIndices[j];
 		}
 
-		// Process the mesh's material
+		// Reorder the triangles and vertices for the GPU's caches, which only applies to triangle lists
+		imported.optimized = MeshOptimizer::GetFlags() != 0 && mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE;
+		if (imported.optimized)
+			MeshOptimizer::Optimize(imported.vertices, imported.indices, imported.optimizeReport);
+
+		// Process the mesh's material, the textures themselves are loaded once back on the context thread
 		if (mesh->mMaterialIndex >= 0)
 		{
-			aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-			vector<ModelTexture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-			meshTextures.insert(meshTextures.end(), diffuseMaps.begin(), diffuseMaps.end());
-			vector<ModelTexture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-			meshTextures.insert(meshTextures.end(), specularMaps.begin(), specularMaps.end());
+			const aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+			getMaterialTexturePaths(material, aiTextureType_DIFFUSE, "texture_diffuse", imported);
+			getMaterialTexturePaths(material, aiTextureType_SPECULAR, "texture_specular", imported);
 		}
-		return Mesh(meshVertices, meshIndices, meshTextures);
 	}
 
-	// Loads textures if they're not loaded yet. Data is returned as a ModelTexture struct.
-	vector<ModelTexture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, string typeName)
+	void getMaterialTexturePaths(const aiMaterial* mat, aiTextureType type, const string& typeName, ImportedMesh& imported)
 	{
-		vector<ModelTexture> textures;
 		unsigned int textureCount = mat->GetTextureCount(type);
 		for (unsigned int i = 0; i < textureCount; i++)
 		{
 			aiString str;
 			mat->GetTexture(type, i, &str);
-			bool skip = false;
-			for (unsigned int j = 0; j < textures_loaded.size(); j++)
-			{
-				if (std::strcmp(textures_loaded[j].path.C_Str(), str.C_Str()) == 0)
-				{
-					textures.push_back(textures_loaded[j]);
-					skip = true; // texture is already loaded into memory
-					break;
-				}
-			}
-			if (!skip)
-			{ // Only load if texture hasnt been loaded already
-				ModelTexture texture;
-				texture.id = TextureFromFile(str.C_Str(), directory);
-				texture.type = typeName;
-				texture.path = str;
-				textures.push_back(texture);
-				textures_loaded.push_back(texture); // add to loaded textures
-			}
+			imported.textureTypes.push_back(typeName);
+			imported.texturePaths.push_back(str.C_Str());
 		}
-		return textures;
 	}
 
-	unsigned int TextureFromFile(const char* path, const string& directory)
+	// Loads textures through the TextureCache, so meshes (and models) sharing a file share one GPU copy of it.
+	// Data is returned as a ModelTexture struct, the model holds a handle to each texture to keep it alive.
+	// path is relative to the model's directory, as the material gives it
+	ModelTexture loadTexture(const string& path, const string& typeName)
 	{
-		string filepath = string(path);
-		filepath = directory + '/' + filepath;
-
-		unsigned int textureID;
-		glGenTextures(1, &textureID);
-
-		int texWidth, texHeight, numComponents;
-		unsigned char* data = stbi_load(filepath.c_str(), &texWidth, &texHeight, &numComponents, 0);
-		if (data)
-		{
-			GLenum textureFormat;
-			if (numComponents == 1)
-				textureFormat = GL_RED;
-			else if (numComponents == 3)
-				textureFormat = GL_RGB;
-			else if (numComponents == 4)
-				textureFormat = GL_RGBA;
-
-			glBindTexture(GL_TEXTURE_2D, textureID);
-			glTexImage2D(GL_TEXTURE_2D, 0, textureFormat, texWidth, texHeight, 0, textureFormat, GL_UNSIGNED_BYTE, data);
-			glGenerateMipmap(GL_TEXTURE_2D);
-
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		// Linear RGBA8, flipped like the rest of the textures, with mipmaps since models are seen from any distance
+		shared_ptr<Texture> texture = TextureCache::Get(directory + '/' + path, true, true, MIPMAP_GPU);
+		if (textures_loaded.insert(texture).second)
+			texture->BindAndSetRepeating(0);
 
-			stbi_image_free(data);
-		}
-		else
-		{
-			std::cout << "Texture failed to load at path: " << path << std::endl;
-			stbi_image_free(data);
-		}
-		return textureID;
+		ModelTexture modelTexture;
+		modelTexture.id = texture->GetID();
+		modelTexture.type = typeName;
+		modelTexture.path = aiString(path);
+		return modelTexture;
 	}
 };
 #endif
@@ -1,6 +1,64 @@
 #include "Renderer.h"
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+GLCallSite g_GLCallSite = { "", "", 0 };
+bool g_GLDebugOutputEnabled = false;
+bool g_GLDebugErrorRaised = false;
+
+// Per-frame draw queue, shared by every Renderer so tests can keep creating one on the stack each frame.
+// The vectors are cleared rather than freed on Flush(), so after the first frame submitting doesn't allocate.
+static std::vector<DrawCommand> s_DrawQueue;
+static std::vector<std::pair<unsigned long long, unsigned int>> s_DrawOrder; // (sort key, index into s_DrawQueue)
+static DrawQueueStats s_LastFlushStats = {};
+// Handles of the sampler and uniform names Flush() has set since the last program change
+static std::vector<std::pair<const char*, UniformHandle>> s_FlushHandles;
+
+static void GLAPIENTRY GLDebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
+{
+    const char* severityName = "Notification";
+    switch (severity)
+    {
+        case GL_DEBUG_SEVERITY_HIGH:    severityName = "High"; break;
+        case GL_DEBUG_SEVERITY_MEDIUM:  severityName = "Medium"; break;
+        case GL_DEBUG_SEVERITY_LOW:     severityName = "Low"; break;
+    }
+
+    if (type == GL_DEBUG_TYPE_ERROR)
+    {
+        g_GLDebugErrorRaised = true;
+        std::cout << "[OpenGL Error]: ";
+    }
+    else
+    {
+        std::cout << "[OpenGL Debug]: ";
+    }
+    // Output is synchronous, so the error was raised by (or just after, for calls not wrapped in GLCall) the last recorded call site
+    std::cout << "(" << id << ", severity: " << severityName << ") " << message << std::endl;
+    std::cout << "    near " << g_GLCallSite.Function << ", " << g_GLCallSite.File << ", line: " << g_GLCallSite.Line << std::endl;
+}
+
+bool InitGLDebugOutput()
+{
+    if (!(GLEW_VERSION_4_3 || GLEW_KHR_debug) || glDebugMessageCallback == nullptr)
+    {
+        std::cout << "[Warning] KHR_debug not supported, falling back to glGetError() checks" << std::endl;
+        g_GLDebugOutputEnabled = false;
+        return false;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT);
+    // Synchronous output makes the callback run inside the offending GL call, so g_GLCallSite is accurate
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(GLDebugMessageCallback, nullptr);
+    // Skip the (very chatty) notification messages such as buffer placement info
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    g_GLDebugOutputEnabled = true;
+    return true;
+}
 
 void GLClearError()
 {
@@ -48,3 +106,151 @@ void Renderer::Clear() const
 {
     GLCall(glClear(GL_COLOR_BUFFER_BIT));
 }
+
+// Combines the bound textures into the 24-bit material part of the sort key (FNV-1a).
+// Collisions only cost some extra texture binds, Flush() compares the actual textures.
+static unsigned int MaterialID(const DrawCommand& command)
+{
+    unsigned int hash = 2166136261u;
+    for (unsigned int i = 0; i < command.NumTextures; i++)
+    {
+        hash = (hash ^ command.Textures[i].Slot) * 16777619u;
+        hash = (hash ^ command.Textures[i].ID) * 16777619u;
+    }
+    return (hash ^ (hash >> 24)) & 0xFFFFFF;
+}
+
+// Names are compared by pointer: they're string literals, so a mesh passes the same pointer for every draw
+static UniformHandle GetFlushHandle(const Shader& shader, const char* name)
+{
+    for (const auto& entry : s_FlushHandles)
+    {
+        if (entry.first == name)
+            return entry.second;
+    }
+    UniformHandle handle = shader.GetUniformHandle(name);
+    s_FlushHandles.push_back({ name, handle });
+    return handle;
+}
+
+static bool SameTextures(const DrawCommand& a, const DrawCommand& b)
+{
+    if (a.NumTextures != b.NumTextures)
+        return false;
+    for (unsigned int i = 0; i < a.NumTextures; i++)
+    {
+        if (a.Textures[i].Slot != b.Textures[i].Slot || a.Textures[i].Target != b.Textures[i].Target || a.Textures[i].ID != b.Textures[i].ID)
+            return false;
+    }
+    return true;
+}
+
+unsigned long long Renderer::MakeSortKey(RenderPass pass, unsigned int program, unsigned int material, float depth)
+{
+    // The bit pattern of a positive float increases with its value, so the top 20 bits
+    // (exponent and high mantissa) give a depth that sorts correctly without knowing the far plane
+    if (depth < 0.0f)
+        depth = 0.0f;
+    unsigned int depthBits;
+    memcpy(&depthBits, &depth, sizeof(depthBits));
+    unsigned long long depthKey = (depthBits >> 11) & 0xFFFFF;
+    if (pass == PASS_TRANSPARENT)
+        depthKey = 0xFFFFF - depthKey; // back to front
+
+    return ((unsigned long long)(pass & 0xF) << 60)
+        | ((unsigned long long)(program & 0xFFFF) << 44)
+        | ((unsigned long long)(material & 0xFFFFFF) << 20)
+        | depthKey;
+}
+
+const DrawQueueStats& Renderer::GetLastFlushStats()
+{
+    return s_LastFlushStats;
+}
+
+void Renderer::Submit(const DrawCommand& command)
+{
+    ASSERT(command.Program != nullptr);
+    unsigned long long key = MakeSortKey(command.Pass, command.Program->GetRendererID(), MaterialID(command), command.Depth);
+    s_DrawOrder.push_back({ key, (unsigned int)s_DrawQueue.size() });
+    s_DrawQueue.push_back(command);
+}
+
+void Renderer::Submit(const VertexArray& VA, const IndexBuffer& IB, Shader& shader, const DrawCommand& command)
+{
+    DrawCommand filled = command;
+    filled.Program = &shader;
+    filled.VertexArray = VA.GetRendererID();
+    filled.IndexCount = IB.GetCount();
+    Submit(filled);
+}
+
+void Renderer::Flush()
+{
+    // Ties are broken by submission order, so equal keys keep the order they were submitted in
+    std::sort(s_DrawOrder.begin(), s_DrawOrder.end());
+
+    DrawQueueStats stats = {};
+    const DrawCommand* previous = nullptr;
+    UniformHandle modelHandle;
+    for (const auto& entry : s_DrawOrder)
+    {
+        const DrawCommand& command = s_DrawQueue[entry.second];
+        Shader* shader = command.Program;
+
+        bool programChanged = previous == nullptr || previous->Program != shader;
+        if (programChanged)
+        {
+            shader->Bind();
+            modelHandle = shader->GetUniformHandle("model");
+            s_FlushHandles.clear();
+            stats.ProgramChanges++;
+        }
+        // Sampler uniforms are program state, so they only need setting again when either side changes
+        if (programChanged || !SameTextures(*previous, command))
+        {
+            for (unsigned int i = 0; i < command.NumTextures; i++)
+            {
+                const DrawTexture& texture = command.Textures[i];
+                GLStateCache::BindTextureUnit(texture.Slot, texture.Target, texture.ID);
+                if (texture.SamplerName != nullptr)
+                    shader->SetInt(GetFlushHandle(*shader, texture.SamplerName), texture.Slot);
+            }
+            stats.MaterialChanges++;
+        }
+
+        // Per draw uniforms, set through handles so no std::string is built per draw
+        shader->SetMatrix4f(modelHandle, command.ModelMatrix);
+        for (unsigned int i = 0; i < command.NumUniforms; i++)
+        {
+            const DrawUniform& uniform = command.Uniforms[i];
+            UniformHandle handle = GetFlushHandle(*shader, uniform.Name);
+            switch (uniform.Type)
+            {
+                case UNIFORM_INT:   shader->SetInt(handle, (int)uniform.Value[0][0]); break;
+                case UNIFORM_FLOAT: shader->SetFloat(handle, uniform.Value[0][0]); break;
+                case UNIFORM_VEC3:  shader->SetVec3(handle, glm::vec3(uniform.Value[0])); break;
+                case UNIFORM_VEC4:  shader->SetVec4(handle, uniform.Value[0]); break;
+                case UNIFORM_MAT4:  shader->SetMatrix4f(handle, uniform.Value); break;
+            }
+        }
+
+        GLStateCache::BindVertexArray(command.VertexArray);
+        if (command.InstanceCount > 1)
+        {
+            GLCall(glDrawElementsInstanced(command.Primitive, command.IndexCount, GL_UNSIGNED_INT, nullptr, command.InstanceCount));
+        }
+        else
+        {
+            GLCall(glDrawElements(command.Primitive, command.IndexCount, GL_UNSIGNED_INT, nullptr));
+        }
+        previous = &command;
+    }
+    // Element array bindings are VAO state, an IndexBuffer created after the flush mustn't land in a queued mesh's VAO
+    GLStateCache::BindVertexArray(0);
+
+    stats.Commands = s_DrawOrder.size();
+    s_LastFlushStats = stats;
+    s_DrawQueue.clear();
+    s_DrawOrder.clear();
+}
@@ -5,11 +5,14 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "GLStateCache.h"
+
+#include "glm\glm.hpp"
 
 // Macros
 #define ASSERT(x) if (!(x)) { __debugbreak(); }
 #ifdef _DEBUG // if running in debug mode
-    #define GLCall(x) GLClearError(); x; ASSERT(GLCheckErrors(#x, __FILE__, __LINE__))
+    #define GLCall(x) GLBeginCall(#x, __FILE__, __LINE__); x; ASSERT(GLEndCall(#x, __FILE__, __LINE__))
 #else // else if running in release mode
     #define GLCall(x) x
 #endif
@@ -17,6 +20,139 @@
 void GLClearError();
 bool GLCheckErrors(const char* function, const char* file, int line);
 
+// Debug output (KHR_debug) error reporting
+//
+// When the context supports glDebugMessageCallback, GLCall() only records where the current call came from
+// and the driver reports errors through GLDebugMessageCallback(), so there is no glGetError() round-trip per call.
+// Otherwise GLCall() falls back to clearing and polling glGetError() around every call.
+struct GLCallSite
+{
+    const char* Function;
+    const char* File;
+    int Line;
+};
+
+extern GLCallSite g_GLCallSite;         // Last call made through GLCall()
+extern bool g_GLDebugOutputEnabled;     // True once InitGLDebugOutput() has installed the callback
+extern bool g_GLDebugErrorRaised;       // Set by the callback when the driver reports an error
+
+// Installs the debug message callback if available, returns false if falling back to glGetError()
+bool InitGLDebugOutput();
+
+inline void GLBeginCall(const char* function, const char* file, int line)
+{
+    if (g_GLDebugOutputEnabled)
+    {
+        // Forget errors raised by unwrapped calls since the last GLCall(), so they aren't blamed on this one
+        g_GLCallSite = { function, file, line };
+        g_GLDebugErrorRaised = false;
+    }
+    else
+    {
+        GLClearError();
+    }
+}
+
+inline bool GLEndCall(const char* function, const char* file, int line)
+{
+    if (g_GLDebugOutputEnabled)
+    {
+        bool noError = !g_GLDebugErrorRaised;
+        g_GLDebugErrorRaised = false;
+        return noError;
+    }
+    return GLCheckErrors(function, file, line);
+}
+
+// Draw command queue
+//
+// Instead of drawing straight away, tests can Submit() draw commands and Flush() them once the pass is built.
+// Commands are sorted by a 64-bit key so that draws sharing a program and then a material end up next to each other,
+// which lets GLStateCache skip most of the program and texture changes in between.
+#define RENDERER_MAX_DRAW_TEXTURES 4
+#define RENDERER_MAX_DRAW_UNIFORMS 4
+
+// Most significant part of the sort key, passes are always executed in this order
+enum RenderPass {
+    PASS_SHADOW = 0,
+    PASS_GEOMETRY,
+    PASS_OPAQUE,
+    PASS_TRANSPARENT,   // sorted back to front instead of front to back
+    PASS_OVERLAY
+};
+
+enum DrawUniformType {
+    UNIFORM_INT,
+    UNIFORM_FLOAT,
+    UNIFORM_VEC3,
+    UNIFORM_VEC4,
+    UNIFORM_MAT4
+};
+
+struct DrawTexture
+{
+    unsigned int Slot;
+    unsigned int Target;
+    unsigned int ID;
+    const char* SamplerName;    // Set to Slot when the program or material changes, may be nullptr
+};
+
+struct DrawUniform
+{
+    const char* Name;
+    DrawUniformType Type;
+    glm::mat4 Value;            // Large enough for every type, smaller types use the first column
+};
+
+struct DrawCommand
+{
+    RenderPass Pass;
+    float Depth;                // Distance from the camera, used to sort within a program/material
+    Shader* Program;
+    unsigned int VertexArray;
+    unsigned int IndexCount;
+    unsigned int Primitive;     // GL_TRIANGLES or GL_POINTS
+    unsigned int InstanceCount; // Drawn with glDrawElementsInstanced() when above 1
+    glm::mat4 ModelMatrix;      // Set to the "model" uniform
+    DrawTexture Textures[RENDERER_MAX_DRAW_TEXTURES];
+    unsigned int NumTextures;
+    DrawUniform Uniforms[RENDERER_MAX_DRAW_UNIFORMS];
+    unsigned int NumUniforms;
+
+    DrawCommand()
+        : Pass(PASS_OPAQUE), Depth(0.0f), Program(nullptr), VertexArray(0), IndexCount(0),
+        Primitive(GL_TRIANGLES), InstanceCount(1), ModelMatrix(1.0f), NumTextures(0), NumUniforms(0)
+    {
+    }
+
+    void AddTexture(unsigned int slot, unsigned int target, unsigned int id, const char* samplerName)
+    {
+        ASSERT(NumTextures < RENDERER_MAX_DRAW_TEXTURES);
+        Textures[NumTextures++] = { slot, target, id, samplerName };
+    }
+
+    void AddUniform(const char* name, int value) { AddUniform(name, UNIFORM_INT, glm::mat4(glm::vec4((float)value, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f))); }
+    void AddUniform(const char* name, float value) { AddUniform(name, UNIFORM_FLOAT, glm::mat4(glm::vec4(value, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f))); }
+    void AddUniform(const char* name, const glm::vec3& value) { AddUniform(name, UNIFORM_VEC3, glm::mat4(glm::vec4(value, 0.0f), glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f))); }
+    void AddUniform(const char* name, const glm::vec4& value) { AddUniform(name, UNIFORM_VEC4, glm::mat4(value, glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f))); }
+    void AddUniform(const char* name, const glm::mat4& value) { AddUniform(name, UNIFORM_MAT4, value); }
+
+private:
+    void AddUniform(const char* name, DrawUniformType type, const glm::mat4& value)
+    {
+        ASSERT(NumUniforms < RENDERER_MAX_DRAW_UNIFORMS);
+        Uniforms[NumUniforms++] = { name, type, value };
+    }
+};
+
+// State changes made by the last Flush()
+struct DrawQueueStats
+{
+    unsigned int Commands;
+    unsigned int ProgramChanges;
+    unsigned int MaterialChanges;
+};
+
 class Renderer
 {
 private:
@@ -26,4 +162,13 @@ public:
     void DrawPoints(const VertexArray& VA, const IndexBuffer& IB, const Shader& shader) const;
     void Clear() const;
 
+    // Queues a command for the next Flush(), any texture/uniform names must stay valid until then
+    void Submit(const DrawCommand& command);
+    void Submit(const VertexArray& VA, const IndexBuffer& IB, Shader& shader, const DrawCommand& command);
+    // Sorts and executes every queued command, then empties the queue
+    void Flush();
+
+    // pass (4 bits) | program (16 bits) | material (24 bits) | depth (20 bits)
+    static unsigned long long MakeSortKey(RenderPass pass, unsigned int program, unsigned int material, float depth);
+    static const DrawQueueStats& GetLastFlushStats();
 };
\ No newline at end of file
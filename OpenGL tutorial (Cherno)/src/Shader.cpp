@@ -1,25 +1,46 @@
 #include "Shader.h"
 #include "Renderer.h"
+#include "FrameUniforms.h"
+#include "ShaderCache.h"
+#include "ShaderBatch.h"
+#include "ShaderHotReload.h"
 
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
 
-Shader::Shader(const std::string& filepath)
-	: m_Filepath(filepath), m_RendererID(0)
+Shader::Shader(const std::string& filepath, const std::vector<std::string>& defines)
+	: m_Filepath(filepath), m_RendererID(0), m_Defines(defines), m_LinkPending(false), m_CacheKey(0), m_Generation(0),
+	m_ReloadProgram(0), m_ReloadCacheKey(0)
 {
     ShaderProgramSource shaderSource = ParseShader(filepath);
-    if (shaderSource.GeometrySource == "")
+    // Registered after parsing, so the includes are watched too
+    ShaderHotReload::Register(this);
+
+    // Try the linked binary from a previous run first, which skips compiling entirely
+    if (ShaderCache::IsAvailable())
     {
-        // No geometry shader in file, just use vertex and fragment shaders
-        m_RendererID = CreateShader(shaderSource.VertexSource, shaderSource.FragmentSource);
+        m_CacheKey = ShaderCache::MakeKey(shaderSource);
+        GLCall(m_RendererID = glCreateProgram());
+        if (ShaderCache::Load(m_CacheKey, m_RendererID))
+        {
+            ReflectUniforms();
+            ReflectUniformBlocks();
+            return;
+        }
+        GLCall(glDeleteProgram(m_RendererID));
     }
+
+    // Issue the compiles and the link without waiting for any of their results
+    m_RendererID = CreateProgram(shaderSource);
+    m_LinkPending = true;
+    // Inside a batch the status checks are left until ShaderBatch::End(), so the driver can work on
+    // every program of the batch at once instead of finishing each one before the next is submitted
+    if (ShaderBatch::IsOpen())
+        ShaderBatch::Add(this);
     else
-    {
-        // Geometry shader included
-        m_RendererID = CreateShader(shaderSource.VertexSource, shaderSource.GeometrySource, shaderSource.FragmentSource);
-    }
+        FinishLink();
 
     // Debugging
    /* std::cout << "VERTEX SHADER SOURCE" << std::endl;
@@ -30,53 +51,377 @@ Shader::Shader(const std::string& filepath)
 
 Shader::~Shader()
 {
+    ShaderHotReload::Unregister(this);
+    if (IsLinkPending())
+    {
+        ShaderBatch::Remove(this);
+        for (const auto& stage : m_PendingStages)
+        {
+            GLCall(glDeleteShader(stage.second));
+        }
+    }
+    if (m_ReloadProgram != 0)
+    {
+        GLCall(glDeleteProgram(m_ReloadProgram));
+    }
     GLCall(glDeleteProgram(m_RendererID));
+    GLStateCache::OnProgramDeleted(m_RendererID);
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+unsigned int Shader::CreateProgram(const ShaderProgramSource& source)
 {
     GLCall(unsigned int shaderProgram = glCreateProgram());
-    // Compile each shader individually
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
-    // Link both shaders to shaderProgram
-    GLCall(glAttachShader(shaderProgram, vs));
-    GLCall(glAttachShader(shaderProgram, fs));
+    // Compile each shader individually, the geometry shader is optional
+    m_PendingStages.push_back({ GL_VERTEX_SHADER, CompileShader(GL_VERTEX_SHADER, source.VertexSource) });
+    if (!source.GeometrySource.empty())
+        m_PendingStages.push_back({ GL_GEOMETRY_SHADER, CompileShader(GL_GEOMETRY_SHADER, source.GeometrySource) });
+    m_PendingStages.push_back({ GL_FRAGMENT_SHADER, CompileShader(GL_FRAGMENT_SHADER, source.FragmentSource) });
+    // Link all stages to shaderProgram
+    for (const auto& stage : m_PendingStages)
+    {
+        GLCall(glAttachShader(shaderProgram, stage.second));
+    }
+    // Allow the linked program to be read back for the shader cache
+    if (ShaderCache::IsAvailable())
+    {
+        GLCall(glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
     GLCall(glLinkProgram(shaderProgram));
-    GLCall(glValidateProgram(shaderProgram));
-    // Delete intermediate values
-    GLCall(glDeleteShader(vs));
-    GLCall(glDeleteShader(fs));
     return shaderProgram;
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& geomShader, const std::string& fragmentShader)
+void Shader::FinishLink()
 {
-    GLCall(unsigned int shaderProgram = glCreateProgram());
-    // Compile each shader individually
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int gs = CompileShader(GL_GEOMETRY_SHADER, geomShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
-    // Link both shaders to shaderProgram
-    GLCall(glAttachShader(shaderProgram, vs));
-    GLCall(glAttachShader(shaderProgram, gs));
-    GLCall(glAttachShader(shaderProgram, fs));
-    GLCall(glLinkProgram(shaderProgram));
-    GLCall(glValidateProgram(shaderProgram));
+    if (!IsLinkPending())
+        return;
+    ShaderBatch::Remove(this);
+    if (m_ReloadProgram != 0)
+    {
+        FinishReload();
+        return;
+    }
+    m_LinkPending = false;
+
+    bool linked = CheckLinkStatus(m_RendererID);
+    if (linked && ShaderCache::IsAvailable())
+        ShaderCache::Store(m_CacheKey, m_RendererID);
+    ReflectUniforms();
+    ReflectUniformBlocks();
+}
+
+bool Shader::CheckLinkStatus(unsigned int program)
+{
+    // This is the first query on the program, so it's where we wait for the driver
+    int linked = GL_FALSE;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    if (linked != GL_TRUE)
+    {
+        // Only look at the individual stages when something went wrong
+        for (const auto& stage : m_PendingStages)
+            CheckCompileStatus(stage.first, stage.second);
+        int length = 0;
+        GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+        std::vector<char> message(length + 1, '\0');
+        GLCall(glGetProgramInfoLog(program, length, nullptr, message.data()));
+        std::cout << "[ERROR]: Shader program link failed (" << m_Filepath << ")." << std::endl;
+        std::cout << message.data() << std::endl;
+    }
+#ifdef _DEBUG
+    GLCall(glValidateProgram(program));
+#endif
+
     // Delete intermediate values
-    GLCall(glDeleteShader(vs));
-    GLCall(glDeleteShader(gs));
-    GLCall(glDeleteShader(fs));
-    return shaderProgram;
+    for (const auto& stage : m_PendingStages)
+    {
+        GLCall(glDetachShader(program, stage.second));
+        GLCall(glDeleteShader(stage.second));
+    }
+    m_PendingStages.clear();
+    return linked == GL_TRUE;
+}
+
+bool Shader::IsLinkComplete() const
+{
+    if (!IsLinkPending())
+        return true;
+    // Without the extension there is no way to ask, and the driver may well have compiled synchronously
+    if (!GLEW_KHR_parallel_shader_compile && !GLEW_ARB_parallel_shader_compile)
+        return true;
+    int completed = GL_FALSE;
+    GLCall(glGetProgramiv(m_ReloadProgram != 0 ? m_ReloadProgram : m_RendererID, GL_COMPLETION_STATUS_KHR, &completed));
+    return completed == GL_TRUE;
+}
+
+void Shader::Reload()
+{
+    EnsureLinked();
+    // A reload still in flight is superseded by this one
+    if (m_ReloadProgram != 0)
+    {
+        ShaderBatch::Remove(this);
+        for (const auto& stage : m_PendingStages)
+        {
+            GLCall(glDeleteShader(stage.second));
+        }
+        m_PendingStages.clear();
+        GLCall(glDeleteProgram(m_ReloadProgram));
+        m_ReloadProgram = 0;
+    }
+
+    // Build the new program next to the current one, which stays in use until the new one has linked
+    ShaderProgramSource shaderSource = ParseShader(m_Filepath);
+    m_ReloadProgram = CreateProgram(shaderSource);
+    m_ReloadCacheKey = ShaderCache::IsAvailable() ? ShaderCache::MakeKey(shaderSource) : 0;
+    ShaderBatch::Add(this);
+}
+
+void Shader::FinishReload()
+{
+    unsigned int program = m_ReloadProgram;
+    m_ReloadProgram = 0;
+    if (!CheckLinkStatus(program))
+    {
+        GLCall(glDeleteProgram(program));
+        std::cout << "[Warning] Reloading " << m_Filepath << " failed, keeping the previous program" << std::endl;
+        return;
+    }
+
+    // Swap programs, keeping the old one until its uniform values have been copied over
+    unsigned int previousProgram = m_RendererID;
+    std::vector<ShaderUniform> previousUniforms = m_Uniforms;
+    m_RendererID = program;
+    m_Generation++;
+    m_UniformLocationCache.clear();
+    ReflectUniforms();
+    ReflectUniformBlocks();
+    CopyUniformValues(previousProgram, previousUniforms);
+    GLCall(glDeleteProgram(previousProgram));
+    GLStateCache::OnProgramDeleted(previousProgram);
+    if (ShaderCache::IsAvailable())
+    {
+        m_CacheKey = m_ReloadCacheKey;
+        ShaderCache::Store(m_CacheKey, m_RendererID);
+    }
+    std::cout << "Reloaded " << m_Filepath << std::endl;
 }
 
-unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
+void Shader::CopyUniformValues(unsigned int previousProgram, const std::vector<ShaderUniform>& previousUniforms)
 {
-    unsigned int id = glCreateShader(type);
-    const char* shader_src = source.c_str();
-    glShaderSource(id, 1, &shader_src, nullptr);
-    glCompileShader(id);
+    // ReflectUniforms() kept every previously known uniform at its old index, so previousUniforms[i] and
+    // m_Uniforms[i] are the same uniform. Array elements have entries of their own, so one value per entry is enough.
+    GLStateCache::UseProgram(m_RendererID);
+    for (unsigned int i = 0; i < previousUniforms.size(); i++)
+    {
+        const ShaderUniform& previous = previousUniforms[i];
+        const ShaderUniform& uniform = m_Uniforms[i];
+        if (previous.Location == -1 || uniform.Location == -1 || previous.Type != uniform.Type)
+            continue;
 
+        float floats[16];
+        int ints[4];
+        unsigned int uints[4];
+        switch (uniform.Type)
+        {
+            case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+            case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+                GLCall(glGetUniformfv(previousProgram, previous.Location, floats));
+                break;
+            case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+                GLCall(glGetUniformuiv(previousProgram, previous.Location, uints));
+                break;
+            case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+            case GL_BOOL: case GL_BOOL_VEC2: case GL_BOOL_VEC3: case GL_BOOL_VEC4:
+                GLCall(glGetUniformiv(previousProgram, previous.Location, ints));
+                break;
+            default:
+                // Samplers hold their texture unit, anything else (e.g. non-square matrices) isn't used here
+                if (!uniform.IsSampler)
+                    continue;
+                GLCall(glGetUniformiv(previousProgram, previous.Location, ints));
+                break;
+        }
+
+        switch (uniform.Type)
+        {
+            case GL_FLOAT:              GLCall(glUniform1fv(uniform.Location, 1, floats)); break;
+            case GL_FLOAT_VEC2:         GLCall(glUniform2fv(uniform.Location, 1, floats)); break;
+            case GL_FLOAT_VEC3:         GLCall(glUniform3fv(uniform.Location, 1, floats)); break;
+            case GL_FLOAT_VEC4:         GLCall(glUniform4fv(uniform.Location, 1, floats)); break;
+            case GL_FLOAT_MAT2:         GLCall(glUniformMatrix2fv(uniform.Location, 1, GL_FALSE, floats)); break;
+            case GL_FLOAT_MAT3:         GLCall(glUniformMatrix3fv(uniform.Location, 1, GL_FALSE, floats)); break;
+            case GL_FLOAT_MAT4:         GLCall(glUniformMatrix4fv(uniform.Location, 1, GL_FALSE, floats)); break;
+            case GL_UNSIGNED_INT:       GLCall(glUniform1uiv(uniform.Location, 1, uints)); break;
+            case GL_UNSIGNED_INT_VEC2:  GLCall(glUniform2uiv(uniform.Location, 1, uints)); break;
+            case GL_UNSIGNED_INT_VEC3:  GLCall(glUniform3uiv(uniform.Location, 1, uints)); break;
+            case GL_UNSIGNED_INT_VEC4:  GLCall(glUniform4uiv(uniform.Location, 1, uints)); break;
+            case GL_INT_VEC2: case GL_BOOL_VEC2: GLCall(glUniform2iv(uniform.Location, 1, ints)); break;
+            case GL_INT_VEC3: case GL_BOOL_VEC3: GLCall(glUniform3iv(uniform.Location, 1, ints)); break;
+            case GL_INT_VEC4: case GL_BOOL_VEC4: GLCall(glUniform4iv(uniform.Location, 1, ints)); break;
+            default:                    GLCall(glUniform1iv(uniform.Location, 1, ints)); break;
+        }
+    }
+}
+
+void Shader::ReflectUniforms()
+{
+    std::vector<ShaderUniform> previous;
+    previous.swap(m_Uniforms);
+    m_UniformLookup.clear();
+
+    int numUniforms = 0;
+    int maxNameLength = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &numUniforms));
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength));
+    std::vector<char> nameBuffer(maxNameLength + 1);
+    for (int i = 0; i < numUniforms; i++)
+    {
+        int length = 0;
+        int size = 0;
+        unsigned int type = 0;
+        GLCall(glGetActiveUniform(m_RendererID, i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data()));
+        std::string name(nameBuffer.data(), length);
+        GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
+        // Members of uniform blocks have no location
+        if (location == -1)
+            continue;
+
+        // Arrays are reported once as "name[0]", so register the plain name (the start of the array) and every element
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+        {
+            std::string baseName = name.substr(0, name.size() - 3);
+            AddUniform(baseName, location, type, size);
+            for (int element = 0; element < size; element++)
+            {
+                std::string elementName = baseName + "[" + std::to_string(element) + "]";
+                GLCall(int elementLocation = glGetUniformLocation(m_RendererID, elementName.c_str()));
+                AddUniform(elementName, elementLocation, type, 1);
+            }
+        }
+        else
+        {
+            AddUniform(name, location, type, size);
+        }
+    }
+
+    // After a reload, keep every previously known uniform at its old index so existing UniformHandles stay valid.
+    // Uniforms that no longer exist keep their slot with location -1, which GL silently ignores.
+    if (!previous.empty())
+    {
+        std::unordered_map<std::string, int> previousIndices;
+        for (unsigned int i = 0; i < previous.size(); i++)
+        {
+            previousIndices[previous[i].Name] = i;
+            previous[i].Location = -1;
+        }
+        for (const ShaderUniform& uniform : m_Uniforms)
+        {
+            auto it = previousIndices.find(uniform.Name);
+            if (it != previousIndices.end())
+                previous[it->second] = uniform;
+            else
+                previous.push_back(uniform);
+        }
+        m_Uniforms.swap(previous);
+    }
+
+    for (unsigned int i = 0; i < m_Uniforms.size(); i++)
+        m_UniformLookup.push_back({ m_Uniforms[i].Hash, (int)i });
+    std::sort(m_UniformLookup.begin(), m_UniformLookup.end());
+}
+
+void Shader::AddUniform(const std::string& name, int location, unsigned int type, int arraySize)
+{
+    bool isSampler = false;
+    switch (type)
+    {
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW: case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D:
+            isSampler = true;
+            break;
+    }
+
+    ShaderUniform uniform = { name, HashUniformName(name.c_str()), location, type, arraySize, isSampler };
+    m_Uniforms.push_back(uniform);
+}
+
+void Shader::ReflectUniformBlocks()
+{
+    m_UniformBlocks.clear();
+
+    int numBlocks = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &numBlocks));
+    for (int i = 0; i < numBlocks; i++)
+    {
+        int nameLength = 0;
+        int dataSize = 0;
+        GLCall(glGetActiveUniformBlockiv(m_RendererID, i, GL_UNIFORM_BLOCK_NAME_LENGTH, &nameLength));
+        GLCall(glGetActiveUniformBlockiv(m_RendererID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+        std::vector<char> nameBuffer(nameLength + 1);
+        GLCall(glGetActiveUniformBlockName(m_RendererID, i, (GLsizei)nameBuffer.size(), nullptr, nameBuffer.data()));
+        ShaderUniformBlock block = { std::string(nameBuffer.data()), (unsigned int)i, dataSize };
+        m_UniformBlocks.push_back(block);
+
+        // Attach the shared blocks to their fixed binding points, checking that the C++ mirror has the same layout
+        int binding = -1;
+        int expectedSize = 0;
+        if (block.Name == CAMERA_BLOCK_NAME)
+        {
+            binding = CAMERA_BLOCK_BINDING;
+            expectedSize = sizeof(CameraBlockData);
+        }
+        else if (block.Name == LIGHT_BLOCK_NAME)
+        {
+            binding = LIGHT_BLOCK_BINDING;
+            expectedSize = sizeof(LightBlockData);
+        }
+        else
+        {
+            std::cout << "[Warning] Uniform block " << block.Name << " in " << m_Filepath << " has no known binding point" << std::endl;
+            continue;
+        }
+        if (dataSize != expectedSize)
+            std::cout << "[Warning] Uniform block " << block.Name << " in " << m_Filepath << " is " << dataSize << " bytes, expected " << expectedSize << std::endl;
+        GLCall(glUniformBlockBinding(m_RendererID, block.Index, binding));
+    }
+}
+
+void Shader::PrintReflection() const
+{
+    EnsureLinked();
+    std::cout << "Shader " << m_Filepath << " (program " << m_RendererID << ")" << std::endl;
+    for (const ShaderUniform& uniform : m_Uniforms)
+    {
+        std::cout << "    " << (uniform.IsSampler ? "sampler " : "uniform ") << uniform.Name
+            << " (location " << uniform.Location << ", type 0x" << std::hex << uniform.Type << std::dec;
+        if (uniform.ArraySize > 1)
+            std::cout << ", array of " << uniform.ArraySize;
+        std::cout << ")" << std::endl;
+    }
+    for (const ShaderUniformBlock& block : m_UniformBlocks)
+        std::cout << "    block " << block.Name << " (" << block.DataSize << " bytes)" << std::endl;
+}
+
+unsigned int Shader::CompileShader(unsigned int type, const std::vector<ShaderSourceSpan>& source)
+{
+    // The result is checked later in FinishLink(), querying it here would wait for the compile to finish
+    GLCall(unsigned int id = glCreateShader(type));
+    // Hand the spans over as they are, GL concatenates them
+    std::vector<const char*> strings(source.size());
+    std::vector<int> lengths(source.size());
+    for (unsigned int i = 0; i < source.size(); i++)
+    {
+        strings[i] = source[i].Data;
+        lengths[i] = source[i].Length;
+    }
+    GLCall(glShaderSource(id, (GLsizei)source.size(), strings.data(), lengths.data()));
+    GLCall(glCompileShader(id));
+    return id;
+}
+
+bool Shader::CheckCompileStatus(unsigned int type, unsigned int id) const
+{
     int result;
     GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
     if (result == GL_FALSE) {
@@ -86,65 +431,176 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
         char* message = (char*)alloca(length * sizeof(char)); // dynamic stack allocation
         GLCall(glGetShaderInfoLog(id, length, &length, message));
         if(type == GL_VERTEX_SHADER)
-            std::cout << "[ERROR]: Vertex shader compile failed." << std::endl;
+            std::cout << "[ERROR]: Vertex shader compile failed (" << m_Filepath << ")." << std::endl;
         else if(type == GL_FRAGMENT_SHADER)
-            std::cout << "[ERROR]: Fragment shader compile failed." << std::endl;
+            std::cout << "[ERROR]: Fragment shader compile failed (" << m_Filepath << ")." << std::endl;
         else if(type == GL_GEOMETRY_SHADER)
-            std::cout << "[ERROR]: Geometry shader compile failed." << std::endl;
+            std::cout << "[ERROR]: Geometry shader compile failed (" << m_Filepath << ")." << std::endl;
         std::cout << message << std::endl;
-        GLCall(glDeleteShader(id));
-        return 0;
+        // Line numbers in the log are "source(line)", where source indexes the files read for this shader
+        if (m_SourceFiles.size() > 1)
+        {
+            for (unsigned int i = 0; i < m_SourceFiles.size(); i++)
+                std::cout << "    source " << i << ": " << m_SourceFiles[i] << std::endl;
+        }
+        return false;
     }
+    return true;
+}
 
-    return id;
+// Whether a line starts with the given preprocessor directive (after any indentation)
+static bool IsDirective(const char* line, const char* lineEnd, const char* directive)
+{
+    while (line < lineEnd && (*line == ' ' || *line == '\t'))
+        line++;
+    for (; *directive != '\0'; directive++, line++)
+    {
+        if (line == lineEnd || *line != *directive)
+            return false;
+    }
+    return true;
+}
+
+static bool LineContains(const char* line, const char* lineEnd, const char* word)
+{
+    return std::search(line, lineEnd, word, word + strlen(word)) != lineEnd;
+}
+
+static void AddSpan(std::vector<ShaderSourceSpan>& stage, const char* begin, const char* end)
+{
+    if (end > begin)
+        stage.push_back({ begin, (int)(end - begin) });
+}
+
+static void AddDirective(ShaderProgramSource& source, std::vector<ShaderSourceSpan>& stage, const std::string& text)
+{
+    source.Directives.push_back(text);
+    const std::string& directive = source.Directives.back();
+    AddSpan(stage, directive.data(), directive.data() + directive.size());
 }
 
 ShaderProgramSource Shader::ParseShader(const std::string& filepath)
 {
-    // Read in a single file which contains all shader source codes
-    std::ifstream stream(filepath);
-    enum class ShaderType { NONE = -1, VERTEX = 0, GEOMETRY = 1, FRAGMENT = 2};
-    ShaderType currentType = ShaderType::NONE;
-    std::string currentLine;
-    std::stringstream stringStream[3];
-    while (getline(stream, currentLine))
+    // Map the single file which contains all shader source codes
+    ShaderProgramSource source;
+    m_SourceFiles.assign(1, filepath);
+    source.Files.emplace_back(new MappedFile(filepath));
+    if (!source.Files[0]->IsOpen())
     {
-        if (currentLine.find("#shader") != std::string::npos)
+        std::cout << "[ERROR] Could not open shader file: " << filepath << std::endl;
+        return source;
+    }
+    // Files already included into each stage
+    std::vector<std::string> includedFiles[3];
+    ParseSourceFile(source, 0, -1, includedFiles);
+    return source;
+}
+
+void Shader::ParseSourceFile(ShaderProgramSource& source, int sourceIndex, int stage, std::vector<std::string>* includedFiles)
+{
+    // The .shader file (source 0) switches stages with "#shader" lines, includes go to the stage that included them
+    std::vector<ShaderSourceSpan>* stages[3] = { &source.VertexSource, &source.GeometrySource, &source.FragmentSource };
+    const MappedFile& file = *source.Files[sourceIndex];
+    const char* end = file.GetData() + file.GetSize();
+    // Ordinary lines are never looked at twice: consecutive ones end up in a single span, which is only cut at directives
+    const char* runStart = file.GetData();
+    int lineNumber = 0;
+    for (const char* line = file.GetData(); line < end; )
+    {
+        const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+        const char* next = lineEnd ? lineEnd + 1 : end;
+        lineNumber++;
+        if (sourceIndex == 0 && IsDirective(line, next, "#shader"))
         {
+            if (stage >= 0)
+                AddSpan(*stages[stage], runStart, line);
             // Update the shader type
-            if (currentLine.find("vertex") != std::string::npos)
-            {
-                // Set mode to vertex shader
-                currentType = ShaderType::VERTEX;
-            }
-            else if (currentLine.find("geometry") != std::string::npos)
-            {
-                // Set mode to geometry shader
-                currentType = ShaderType::GEOMETRY;
-            }
-            else if (currentLine.find("fragment") != std::string::npos)
-            {
-                // Set mode to fragment shader
-                currentType = ShaderType::FRAGMENT;
-            }
+            if (LineContains(line, next, "vertex"))
+                stage = 0;
+            else if (LineContains(line, next, "geometry"))
+                stage = 1;
+            else if (LineContains(line, next, "fragment"))
+                stage = 2;
+            runStart = next;
         }
-        else
+        else if (stage >= 0 && sourceIndex == 0 && IsDirective(line, next, "#version"))
         {
-            // Append current line to proper string stream
-            stringStream[(int)currentType] << currentLine << "\n";
+            // Variant keywords have to come after #version, which must be the first statement
+            AddSpan(*stages[stage], runStart, next);
+            std::string directives;
+            for (const std::string& define : m_Defines)
+                directives += "#define " + define + "\n";
+            // Keep compile errors pointing at lines of the .shader file
+            directives += "#line " + std::to_string(lineNumber + 1) + " 0\n";
+            AddDirective(source, *stages[stage], directives);
+            runStart = next;
         }
+        else if (stage >= 0 && IsDirective(line, next, "#include"))
+        {
+            AddSpan(*stages[stage], runStart, line);
+            AppendInclude(source, stage, sourceIndex, line, next, includedFiles);
+            AddDirective(source, *stages[stage], "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceIndex) + "\n");
+            runStart = next;
+        }
+        line = next;
+    }
+    if (stage >= 0)
+    {
+        AddSpan(*stages[stage], runStart, end);
+        // An include without a final newline would run into the #line that follows it
+        if (sourceIndex != 0 && runStart < end && end[-1] != '\n')
+            AddDirective(source, *stages[stage], "\n");
     }
-    return ShaderProgramSource{ stringStream[0].str(), stringStream[1].str(), stringStream[2].str()};
+}
+
+void Shader::AppendInclude(ShaderProgramSource& source, int stage, int includingIndex, const char* line, const char* lineEnd, std::vector<std::string>* includedFiles)
+{
+    // #include "file", relative to the directory of the including file
+    std::string includingFile = m_SourceFiles[includingIndex];
+    const char* nameStart = std::find(line, lineEnd, '"');
+    const char* nameEnd = nameStart == lineEnd ? lineEnd : std::find(nameStart + 1, lineEnd, '"');
+    if (nameEnd == lineEnd)
+    {
+        std::cout << "[ERROR] Malformed include in " << includingFile << ": " << std::string(line, lineEnd) << std::endl;
+        return;
+    }
+    size_t directoryEnd = includingFile.find_last_of("/\\");
+    std::string directory = directoryEnd == std::string::npos ? "" : includingFile.substr(0, directoryEnd + 1);
+    std::string includePath = directory + std::string(nameStart + 1, nameEnd);
+
+    // Every file is only pasted in once per stage, so includes need no guards and can't recurse forever
+    std::vector<std::string>& stageIncludes = includedFiles[stage];
+    if (std::find(stageIncludes.begin(), stageIncludes.end(), includePath) != stageIncludes.end())
+        return;
+    stageIncludes.push_back(includePath);
+
+    // Files included by several stages are only mapped once
+    int sourceIndex = std::find(m_SourceFiles.begin(), m_SourceFiles.end(), includePath) - m_SourceFiles.begin();
+    if (sourceIndex == (int)m_SourceFiles.size())
+    {
+        m_SourceFiles.push_back(includePath);
+        source.Files.emplace_back(new MappedFile(includePath));
+    }
+    if (!source.Files[sourceIndex]->IsOpen())
+    {
+        std::cout << "[ERROR] Could not open shader include " << includePath << " (from " << includingFile << ")" << std::endl;
+        return;
+    }
+    // The source number in #line lets compile errors name the include, see CheckCompileStatus()
+    std::vector<ShaderSourceSpan>* stages[3] = { &source.VertexSource, &source.GeometrySource, &source.FragmentSource };
+    AddDirective(source, *stages[stage], "#line 1 " + std::to_string(sourceIndex) + "\n");
+    ParseSourceFile(source, sourceIndex, stage, includedFiles);
 }
 
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(m_RendererID));
+    EnsureLinked();
+    GLStateCache::UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-    GLCall(glUseProgram(0));
+    GLStateCache::UseProgram(0);
 }
 
 void Shader::SetVec3f(const std::string& name, float v0, float v1, float v2)
@@ -193,21 +649,90 @@ void Shader::SetFloat(const std::string& name, float value)
 	GLCall(glUniform1f(uniformLocation, value));
 }
 
+UniformHandle Shader::GetUniformHandle(const char* name) const
+{
+    EnsureLinked();
+    unsigned int hash = HashUniformName(name);
+    auto it = std::lower_bound(m_UniformLookup.begin(), m_UniformLookup.end(), std::make_pair(hash, -1));
+    // Compare names too, in case two uniforms of this program share a hash
+    for (; it != m_UniformLookup.end() && it->first == hash; ++it)
+    {
+        if (m_Uniforms[it->second].Name == name)
+            return UniformHandle(it->second);
+    }
+    return UniformHandle();
+}
+
+void Shader::SetInt(UniformHandle handle, int value)
+{
+    if (handle.IsValid())
+    {
+        GLCall(glUniform1i(m_Uniforms[handle.Index].Location, value));
+    }
+}
+
+void Shader::SetFloat(UniformHandle handle, float value)
+{
+    if (handle.IsValid())
+    {
+        GLCall(glUniform1f(m_Uniforms[handle.Index].Location, value));
+    }
+}
+
+void Shader::SetVec3(UniformHandle handle, const glm::vec3& vector)
+{
+    if (handle.IsValid())
+    {
+        GLCall(glUniform3f(m_Uniforms[handle.Index].Location, vector.x, vector.y, vector.z));
+    }
+}
+
+void Shader::SetVec3Array(UniformHandle handle, const glm::vec3* vectors, unsigned int count)
+{
+    if (handle.IsValid())
+    {
+        GLCall(glUniform3fv(m_Uniforms[handle.Index].Location, count, &vectors[0].x));
+    }
+}
+
+void Shader::SetVec4(UniformHandle handle, const glm::vec4& vector)
+{
+    if (handle.IsValid())
+    {
+        GLCall(glUniform4f(m_Uniforms[handle.Index].Location, vector.x, vector.y, vector.z, vector.w));
+    }
+}
+
+void Shader::SetMatrix4f(UniformHandle handle, const glm::mat4& matrix4)
+{
+    if (handle.IsValid())
+    {
+        GLCall(glUniformMatrix4fv(m_Uniforms[handle.Index].Location, 1, GL_FALSE, &matrix4[0][0]));
+    }
+}
+
 int Shader::GetUniformLocation(const std::string& name) const
 {
+    EnsureLinked();
     // Caching of uniform locations means we don't have to call glGetUniformLocation() every time we want to set a uniform
-    if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-        return m_UniformLocationCache[name];
+    auto cached = m_UniformLocationCache.find(name);
+    if (cached != m_UniformLocationCache.end())
+        return cached->second;
 
-    GLCall(int uniformLocation = glGetUniformLocation(m_RendererID, name.c_str()));
-    if (uniformLocation == -1)
+    UniformHandle handle = GetUniformHandle(name);
+    int uniformLocation = -1;
+    if (handle.IsValid())
     {
-        std::cout << "[Warning] Uniform named " << name << " does not exist!" << std::endl;
+        uniformLocation = m_Uniforms[handle.Index].Location;
     }
-    else 
+    else
     {
-        // Cacher uniform location only if found
-        m_UniformLocationCache[name] = uniformLocation;
+        GLCall(uniformLocation = glGetUniformLocation(m_RendererID, name.c_str()));
     }
+    if (uniformLocation == -1)
+        std::cout << "[Warning] Uniform named " << name << " does not exist in " << m_Filepath << "!" << std::endl;
+
+    // Misses are cached as well, so a missing uniform only warns once instead of every frame
+    m_UniformLocationCache[name] = uniformLocation;
     return uniformLocation;
 }
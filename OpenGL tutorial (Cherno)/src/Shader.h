@@ -1,28 +1,105 @@
 #pragma once
+#include <deque>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "glm\glm.hpp"
+#include "MappedFile.h"
 
+// A piece of a shader stage's source, passed to glShaderSource() as a (pointer, length) pair
+struct ShaderSourceSpan
+{
+	const char* Data;
+	int Length;
+};
+
+// Parsed sources of a shader file. Nothing is copied while parsing: the spans point straight into the
+// memory mapped .shader file and its includes, or at the few lines generated by the preprocessor.
+// Both are owned here, so the spans are valid for as long as this object is.
 struct ShaderProgramSource {
-	std::string VertexSource;
-	std::string GeometrySource;
-	std::string FragmentSource;
+	std::vector<ShaderSourceSpan> VertexSource;
+	std::vector<ShaderSourceSpan> GeometrySource;
+	std::vector<ShaderSourceSpan> FragmentSource;
+	// Files[i] is the mapping of source number i (see Shader::GetSourceFiles)
+	std::vector<std::unique_ptr<MappedFile>> Files;
+	// Generated #define and #line lines (a deque, so adding one never moves the others)
+	std::deque<std::string> Directives;
 };
+
+// FNV-1a hash of a uniform name, usable at compile time for string literals
+constexpr unsigned int HashUniformName(const char* name, unsigned int hash = 2166136261u)
+{
+	return *name == '\0' ? hash : HashUniformName(name + 1, (hash ^ (unsigned char)*name) * 16777619u);
+}
+
+// Index into a shader's table of active uniforms, resolved once with Shader::GetUniformHandle().
+// Setting a uniform through a handle is an array lookup, with no string hashing or allocation.
+// A handle is only meaningful for the shader it was resolved from.
+struct UniformHandle
+{
+	int Index;
+
+	UniformHandle() : Index(-1) {}
+	explicit UniformHandle(int index) : Index(index) {}
+	inline bool IsValid() const { return Index >= 0; }
+};
+
+// An active uniform found by reflection after linking (each element of an array gets its own entry)
+struct ShaderUniform
+{
+	std::string Name;
+	unsigned int Hash;
+	int Location;
+	unsigned int Type;		// GL type enum, e.g. GL_FLOAT_VEC3 or GL_SAMPLER_2D
+	int ArraySize;			// 1 for non-array uniforms
+	bool IsSampler;
+};
+
+// An active uniform block, see FrameUniforms.h for the shared blocks
+struct ShaderUniformBlock
+{
+	std::string Name;
+	unsigned int Index;
+	int DataSize;			// Size in bytes the program expects the bound buffer range to have
+};
+
 class Shader
 {
 private:
 	std::string m_Filepath;
 	unsigned int m_RendererID;
+	// Keywords defined for this variant, and every file the source was read from (the .shader file first, then its includes)
+	std::vector<std::string> m_Defines;
+	std::vector<std::string> m_SourceFiles;
 	// Caching data structure for uniforms
 	mutable std::unordered_map<std::string, int> m_UniformLocationCache;
+	// Reflection data gathered after linking, plus (hash, index into m_Uniforms) pairs sorted by hash
+	std::vector<ShaderUniform> m_Uniforms;
+	std::vector<std::pair<unsigned int, int>> m_UniformLookup;
+	std::vector<ShaderUniformBlock> m_UniformBlocks;
+	// Compiles/link issued but not checked yet (see ShaderBatch), with the (type, id) of each stage
+	bool m_LinkPending;
+	std::vector<std::pair<unsigned int, unsigned int>> m_PendingStages;
+	unsigned long long m_CacheKey;
+	// Incremented every time the program is replaced by Reload()
+	unsigned int m_Generation;
+	// Program being built by Reload() while the current one stays in use (0 if none), and its cache key
+	unsigned int m_ReloadProgram;
+	unsigned long long m_ReloadCacheKey;
 public:
-	Shader(const std::string& filepath);
+	// Besides the "#shader <stage>" markers, a .shader file may #include "file" (relative to the including file,
+	// each file is included at most once per stage). Every entry of defines is added as "#define <entry>" right
+	// after each stage's #version line, so one file can be built into several variants (see ShaderVariants).
+	Shader(const std::string& filepath, const std::vector<std::string>& defines = std::vector<std::string>());
 	~Shader();
 
 	void Bind() const;
 	void Unbind() const;
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
 	// Set uniforms
 	void SetVec3f(const std::string& name, float v0, float v1, float v2);
 	void SetVec3(const std::string& name, glm::vec3 vector);
@@ -34,10 +111,54 @@ public:
 	void SetBool(const std::string& name, bool value);
 	void SetFloat(const std::string& name, float value);
 
+	// Fast path: look the handle up once (e.g. after creating the shader), then set through it every frame.
+	// Returns an invalid handle if the uniform isn't active, setting an invalid handle does nothing.
+	UniformHandle GetUniformHandle(const char* name) const;
+	UniformHandle GetUniformHandle(const std::string& name) const { return GetUniformHandle(name.c_str()); }
+	void SetInt(UniformHandle handle, int value);
+	void SetFloat(UniformHandle handle, float value);
+	void SetVec3(UniformHandle handle, const glm::vec3& vector);
+	void SetVec3Array(UniformHandle handle, const glm::vec3* vectors, unsigned int count);
+	void SetVec4(UniformHandle handle, const glm::vec4& vector);
+	void SetMatrix4f(UniformHandle handle, const glm::mat4& matrix4);
+
+	// Reflection
+	inline const std::vector<ShaderUniform>& GetUniforms() const { EnsureLinked(); return m_Uniforms; }
+	inline const std::vector<ShaderUniformBlock>& GetUniformBlocks() const { EnsureLinked(); return m_UniformBlocks; }
+	inline const ShaderUniform& GetUniform(UniformHandle handle) const { return m_Uniforms[handle.Index]; }
+	inline const std::string& GetFilepath() const { return m_Filepath; }
+	inline const std::vector<std::string>& GetDefines() const { return m_Defines; }
+	inline const std::vector<std::string>& GetSourceFiles() const { return m_SourceFiles; }
+	// Prints every active uniform, sampler and uniform block
+	void PrintReflection() const;
+
+	// Checks the compile/link results of a program created inside a ShaderBatch, or of a reload. Called by
+	// ShaderBatch::End() or ShaderBatch::Update(), or as soon as the shader is first used (a reload isn't waited
+	// for by using the shader), whichever comes first. Does nothing if already finished.
+	void FinishLink();
+	inline bool IsLinkPending() const { return m_LinkPending || m_ReloadProgram != 0; }
+	// Whether FinishLink() could run without waiting for the driver (always true without parallel shader compile)
+	bool IsLinkComplete() const;
+
+	// Issues the compiles and the link of the shader file again, without waiting for them. The current program
+	// stays in use until ShaderBatch::Update() finds the new one linked, and is only replaced if it links.
+	// Uniform handles stay valid and the values set on the old program are copied to the new one.
+	void Reload();
+	inline unsigned int GetGeneration() const { return m_Generation; }
+
 private:
 	ShaderProgramSource ParseShader(const std::string& filepath);
-	unsigned int CompileShader(unsigned int type, const std::string& source); 
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& geomShader, const std::string& fragmentShader);
+	void ParseSourceFile(ShaderProgramSource& source, int sourceIndex, int stage, std::vector<std::string>* includedFiles);
+	void AppendInclude(ShaderProgramSource& source, int stage, int includingIndex, const char* line, const char* lineEnd, std::vector<std::string>* includedFiles);
+	unsigned int CompileShader(unsigned int type, const std::vector<ShaderSourceSpan>& source);
+	bool CheckCompileStatus(unsigned int type, unsigned int id) const;
+	unsigned int CreateProgram(const ShaderProgramSource& source);
+	bool CheckLinkStatus(unsigned int program);
+	void FinishReload();
+	void CopyUniformValues(unsigned int previousProgram, const std::vector<ShaderUniform>& previousUniforms);
+	inline void EnsureLinked() const { if (m_LinkPending) const_cast<Shader*>(this)->FinishLink(); }
 	int GetUniformLocation(const std::string& name) const;
+	void ReflectUniforms();
+	void ReflectUniformBlocks();
+	void AddUniform(const std::string& name, int location, unsigned int type, int arraySize);
 };
\ No newline at end of file
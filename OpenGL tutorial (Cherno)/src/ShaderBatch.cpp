@@ -0,0 +1,69 @@
+#include "ShaderBatch.h"
+
+#include "Shader.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+bool ShaderBatch::s_Open = false;
+std::vector<Shader*> ShaderBatch::s_PendingShaders;
+
+void ShaderBatch::Begin()
+{
+	// 0xFFFFFFFF lets the implementation pick the number of compiler threads
+	static bool threadsRequested = false;
+	if (!threadsRequested)
+	{
+		if (GLEW_KHR_parallel_shader_compile)
+		{
+			GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+		}
+		else if (GLEW_ARB_parallel_shader_compile)
+		{
+			GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+		}
+		threadsRequested = true;
+	}
+	s_Open = true;
+}
+
+void ShaderBatch::End()
+{
+	s_Open = false;
+	if (s_PendingShaders.empty())
+		return;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	// FinishLink() removes each shader from the list, so work on a copy
+	std::vector<Shader*> pending;
+	pending.swap(s_PendingShaders);
+	for (Shader* shader : pending)
+		shader->FinishLink();
+	double waitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	std::cout << "Shader batch: finished " << pending.size() << " programs, waited " << waitMs << " ms for the driver" << std::endl;
+}
+
+void ShaderBatch::Update()
+{
+	if (s_Open || s_PendingShaders.empty())
+		return;
+
+	std::vector<Shader*> pending = s_PendingShaders;
+	for (Shader* shader : pending)
+	{
+		if (shader->IsLinkComplete())
+			shader->FinishLink();
+	}
+}
+
+void ShaderBatch::Add(Shader* shader)
+{
+	s_PendingShaders.push_back(shader);
+}
+
+void ShaderBatch::Remove(Shader* shader)
+{
+	s_PendingShaders.erase(std::remove(s_PendingShaders.begin(), s_PendingShaders.end(), shader), s_PendingShaders.end());
+}
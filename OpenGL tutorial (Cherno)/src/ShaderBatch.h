@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+class Shader;
+
+// Groups shader creation so the driver can compile and link many programs concurrently.
+// Between Begin() and End(), Shader's constructor only issues its compiles and link. The status queries
+// that would make the driver finish the program are left until End(), or until the shader is first used.
+// Where GL_KHR_parallel_shader_compile (or the ARB version) is available, the driver is also asked to
+// spread the compiles over as many threads as it likes.
+class ShaderBatch
+{
+public:
+	static void Begin();
+	// Waits for every program created since Begin() and reports any compile or link errors
+	static void End();
+	static bool IsOpen() { return s_Open; }
+	// Called once per frame: finishes the pending programs (e.g. those of Shader::Reload) the driver is done
+	// with, and leaves the rest for a later frame instead of waiting for them
+	static void Update();
+
+	// Called by Shader
+	static void Add(Shader* shader);
+	static void Remove(Shader* shader);
+
+private:
+	static bool s_Open;
+	static std::vector<Shader*> s_PendingShaders;
+};
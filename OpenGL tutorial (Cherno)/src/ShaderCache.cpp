@@ -0,0 +1,162 @@
+#include "ShaderCache.h"
+
+#include "Renderer.h"
+#include "Shader.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define MAKE_DIRECTORY(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MAKE_DIRECTORY(path) mkdir(path, 0755)
+#endif
+
+// Bump whenever the entry layout changes, so old entries are ignored
+static const unsigned int SHADER_CACHE_VERSION = 1;
+
+struct ShaderCacheHeader
+{
+	char Magic[4];				// "GLPB"
+	unsigned int Version;
+	unsigned long long Key;
+	unsigned int BinaryFormat;
+	unsigned int BinaryLength;
+};
+
+bool ShaderCache::s_Enabled = true;
+unsigned int ShaderCache::s_NumHits = 0;
+unsigned int ShaderCache::s_NumMisses = 0;
+
+static unsigned long long HashBytes(unsigned long long hash, const char* data, size_t length)
+{
+	// 64-bit FNV-1a
+	for (size_t i = 0; i < length; i++)
+		hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+	return hash;
+}
+
+static unsigned long long HashString(unsigned long long hash, const std::string& string)
+{
+	hash = HashBytes(hash, string.data(), string.size());
+	// Separate consecutive strings so "ab" + "c" and "a" + "bc" differ
+	return (hash ^ 0xFF) * 1099511628211ull;
+}
+
+static unsigned long long HashStage(unsigned long long hash, const std::vector<ShaderSourceSpan>& stage)
+{
+	// Only the concatenated text matters, not where the parser happened to split it
+	for (const ShaderSourceSpan& span : stage)
+		hash = HashBytes(hash, span.Data, span.Length);
+	return (hash ^ 0xFF) * 1099511628211ull;
+}
+
+bool ShaderCache::IsAvailable()
+{
+	if (!s_Enabled)
+		return false;
+	static int numFormats = -1;
+	if (numFormats == -1)
+	{
+		numFormats = 0;
+		if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	}
+	return numFormats > 0;
+}
+
+unsigned long long ShaderCache::MakeKey(const ShaderProgramSource& source)
+{
+	unsigned long long hash = 14695981039346656037ull;
+	hash = HashStage(hash, source.VertexSource);
+	hash = HashStage(hash, source.GeometrySource);
+	hash = HashStage(hash, source.FragmentSource);
+	// A driver update invalidates every binary
+	hash = HashString(hash, (const char*)glGetString(GL_VENDOR));
+	hash = HashString(hash, (const char*)glGetString(GL_RENDERER));
+	hash = HashString(hash, (const char*)glGetString(GL_VERSION));
+	return hash;
+}
+
+std::string ShaderCache::GetEntryPath(unsigned long long key)
+{
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.bin", key);
+	return std::string(SHADER_CACHE_DIRECTORY) + "/" + fileName;
+}
+
+bool ShaderCache::Load(unsigned long long key, unsigned int program)
+{
+	if (!IsAvailable())
+		return false;
+
+	std::ifstream stream(GetEntryPath(key), std::ios::binary);
+	ShaderCacheHeader header;
+	if (!stream.is_open() || !stream.read((char*)&header, sizeof(header))
+		|| memcmp(header.Magic, "GLPB", 4) != 0 || header.Version != SHADER_CACHE_VERSION || header.Key != key)
+	{
+		s_NumMisses++;
+		return false;
+	}
+
+	std::vector<char> binary(header.BinaryLength);
+	if (!stream.read(binary.data(), binary.size()))
+	{
+		s_NumMisses++;
+		return false;
+	}
+
+	// The driver may still reject the binary (e.g. after an update that kept the version string), which isn't an error.
+	// glProgramBinary() isn't wrapped in GLCall() and any error it raises is dropped, since the link status covers it.
+	glProgramBinary(program, header.BinaryFormat, binary.data(), binary.size());
+	GLClearError();
+	g_GLDebugErrorRaised = false;
+	int linked = GL_FALSE;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	if (linked != GL_TRUE)
+	{
+		std::cout << "[Warning] Cached program binary " << GetEntryPath(key) << " was rejected, recompiling" << std::endl;
+		s_NumMisses++;
+		return false;
+	}
+	s_NumHits++;
+	return true;
+}
+
+void ShaderCache::Store(unsigned long long key, unsigned int program)
+{
+	if (!IsAvailable())
+		return;
+
+	// Never cache a program that failed to link
+	int linked = GL_FALSE;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+	int length = 0;
+	GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+	if (linked != GL_TRUE || length <= 0)
+		return;
+
+	ShaderCacheHeader header;
+	memcpy(header.Magic, "GLPB", 4);
+	header.Version = SHADER_CACHE_VERSION;
+	header.Key = key;
+	std::vector<char> binary(length);
+	GLCall(glGetProgramBinary(program, length, nullptr, &header.BinaryFormat, binary.data()));
+	header.BinaryLength = length;
+
+	// Fails harmlessly if the directory already exists
+	MAKE_DIRECTORY(SHADER_CACHE_DIRECTORY);
+	std::ofstream stream(GetEntryPath(key), std::ios::binary | std::ios::trunc);
+	if (!stream.is_open())
+	{
+		std::cout << "[Warning] Could not write program binary " << GetEntryPath(key) << std::endl;
+		return;
+	}
+	stream.write((const char*)&header, sizeof(header));
+	stream.write(binary.data(), binary.size());
+}
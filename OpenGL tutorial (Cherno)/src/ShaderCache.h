@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+struct ShaderProgramSource;
+
+// Directory (relative to the working directory) where linked program binaries are stored
+#define SHADER_CACHE_DIRECTORY "shader_cache"
+
+// On-disk cache of linked programs (glGetProgramBinary/glProgramBinary).
+// Each entry is keyed by a hash of the program's source and the GL vendor, renderer and version strings,
+// since binaries are only valid for the exact driver that produced them. A missing, stale or rejected entry
+// simply falls back to compiling from source, after which the new binary is written out.
+class ShaderCache
+{
+public:
+	// False if disabled or if the context has no binary formats (GL 4.1 / ARB_get_program_binary)
+	static bool IsAvailable();
+	static void SetEnabled(bool enabled) { s_Enabled = enabled; }
+
+	static unsigned long long MakeKey(const ShaderProgramSource& source);
+	// Loads the binary for key into program, returns false (leaving program unlinked) on any mismatch
+	static bool Load(unsigned long long key, unsigned int program);
+	// Writes the binary of a successfully linked program
+	static void Store(unsigned long long key, unsigned int program);
+
+	static unsigned int GetNumHits() { return s_NumHits; }
+	static unsigned int GetNumMisses() { return s_NumMisses; }
+
+private:
+	static std::string GetEntryPath(unsigned long long key);
+
+	static bool s_Enabled;
+	static unsigned int s_NumHits;
+	static unsigned int s_NumMisses;
+};
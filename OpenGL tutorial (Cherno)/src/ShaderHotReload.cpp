@@ -0,0 +1,67 @@
+#include "ShaderHotReload.h"
+
+#include "Shader.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+std::vector<ShaderHotReload::WatchedShader> ShaderHotReload::s_Shaders;
+double ShaderHotReload::s_LastCheckTime = 0.0;
+bool ShaderHotReload::s_Enabled = true;
+
+void ShaderHotReload::Update(double time)
+{
+	if (!s_Enabled || time - s_LastCheckTime < SHADER_HOT_RELOAD_INTERVAL)
+		return;
+	s_LastCheckTime = time;
+
+	for (WatchedShader& watched : s_Shaders)
+	{
+		long long writeTime = GetNewestWriteTime(watched.ShaderProgram);
+		// Files that can't be read right now (e.g. mid-save) keep their old time and are retried next check
+		if (writeTime == 0 || writeTime == watched.LastWriteTime)
+			continue;
+		watched.LastWriteTime = writeTime;
+		watched.ShaderProgram->Reload();
+	}
+}
+
+void ShaderHotReload::Register(Shader* shader)
+{
+	s_Shaders.push_back({ shader, GetNewestWriteTime(shader) });
+}
+
+void ShaderHotReload::Unregister(Shader* shader)
+{
+	for (unsigned int i = 0; i < s_Shaders.size(); i++)
+	{
+		if (s_Shaders[i].ShaderProgram == shader)
+		{
+			s_Shaders.erase(s_Shaders.begin() + i);
+			return;
+		}
+	}
+}
+
+long long ShaderHotReload::GetNewestWriteTime(const Shader* shader)
+{
+	// Saving an include reloads every shader that uses it
+	long long newest = 0;
+	for (const std::string& filepath : shader->GetSourceFiles())
+	{
+		long long writeTime = GetLastWriteTime(filepath);
+		if (writeTime == 0)
+			return 0;
+		if (writeTime > newest)
+			newest = writeTime;
+	}
+	return newest;
+}
+
+long long ShaderHotReload::GetLastWriteTime(const std::string& filepath)
+{
+	struct stat fileInfo;
+	if (stat(filepath.c_str(), &fileInfo) != 0)
+		return 0;
+	return (long long)fileInfo.st_mtime;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+class Shader;
+
+// Seconds between checks of the shader files
+#define SHADER_HOT_RELOAD_INTERVAL 0.5
+
+// Watches the files (including #includes) of every live Shader and reloads it when it is saved, so shaders can be edited
+// while the sandbox keeps running. Only the changed program is rebuilt (see Shader::Reload), every
+// other GL object stays where it is.
+// Files are watched by polling their modification time, which works the same on every platform
+// and costs one stat() per shader file every SHADER_HOT_RELOAD_INTERVAL seconds.
+class ShaderHotReload
+{
+private:
+	struct WatchedShader
+	{
+		Shader* ShaderProgram;
+		long long LastWriteTime;	// Newest of all the shader's source files
+	};
+
+	static std::vector<WatchedShader> s_Shaders;
+	static double s_LastCheckTime;
+	static bool s_Enabled;
+
+public:
+	// Called from the main loop with the current time, does nothing until the interval has passed
+	static void Update(double time);
+	static void SetEnabled(bool enabled) { s_Enabled = enabled; }
+
+	// Called by Shader
+	static void Register(Shader* shader);
+	static void Unregister(Shader* shader);
+
+private:
+	static long long GetNewestWriteTime(const Shader* shader);
+	static long long GetLastWriteTime(const std::string& filepath);
+};
@@ -0,0 +1,45 @@
+#include "ShaderVariants.h"
+
+#include "Renderer.h"
+
+#include <iostream>
+
+ShaderVariants::ShaderVariants(const std::string& filepath, const std::vector<std::string>& keywords)
+	: m_Filepath(filepath), m_Keywords(keywords)
+{
+	ASSERT(m_Keywords.size() <= SHADER_VARIANTS_MAX_KEYWORDS);
+}
+
+ShaderVariants::~ShaderVariants()
+{
+	for (auto& variant : m_Variants)
+		delete variant.second;
+}
+
+Shader* ShaderVariants::Get(unsigned int mask)
+{
+	auto it = m_Variants.find(mask);
+	if (it != m_Variants.end())
+		return it->second;
+
+	std::vector<std::string> defines;
+	for (unsigned int i = 0; i < m_Keywords.size(); i++)
+	{
+		if (mask & (1u << i))
+			defines.push_back(m_Keywords[i]);
+	}
+	Shader* shader = new Shader(m_Filepath, defines);
+	m_Variants[mask] = shader;
+	return shader;
+}
+
+unsigned int ShaderVariants::GetKeywordMask(const std::string& keyword) const
+{
+	for (unsigned int i = 0; i < m_Keywords.size(); i++)
+	{
+		if (m_Keywords[i] == keyword)
+			return 1u << i;
+	}
+	std::cout << "[Warning] Shader keyword " << keyword << " is not declared for " << m_Filepath << std::endl;
+	return 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+// Maximum number of keywords, one bit each in a variant mask
+#define SHADER_VARIANTS_MAX_KEYWORDS 32
+
+// One .shader file built into a separate program per combination of keywords, instead of branching on
+// uniform bools inside a single program. Keyword i of the constructor is bit (1 << i) of a variant mask,
+// and each variant is compiled with "#define <keyword>" for every bit that is set.
+// Variants are compiled the first time they're requested, so request the ones that will be used while a
+// ShaderBatch is open (e.g. in the test's constructor) to avoid compiling in the middle of a frame.
+// Uniform values belong to each variant's own program, so set them again after switching variants.
+class ShaderVariants
+{
+private:
+	std::string m_Filepath;
+	std::vector<std::string> m_Keywords;
+	std::unordered_map<unsigned int, Shader*> m_Variants;
+
+public:
+	ShaderVariants(const std::string& filepath, const std::vector<std::string>& keywords);
+	~ShaderVariants();
+
+	// Returns the program for a combination of keyword bits, compiling it on first use
+	Shader* Get(unsigned int mask);
+	// Bit of a keyword, 0 (with a warning) if the keyword wasn't given to the constructor
+	unsigned int GetKeywordMask(const std::string& keyword) const;
+
+	inline const std::string& GetFilepath() const { return m_Filepath; }
+	inline unsigned int GetNumCompiledVariants() const { return m_Variants.size(); }
+};
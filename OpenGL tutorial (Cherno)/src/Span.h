@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+// Non-owning view of a contiguous array, for handing out geometry without copying it or exposing the container
+// that owns it (std::span is C++20, the project builds as C++14). Only valid while the array it points to is.
+template<typename T>
+class Span
+{
+private:
+	T* m_Data;
+	size_t m_Size;
+
+public:
+	Span() : m_Data(nullptr), m_Size(0) {}
+	Span(T* data, size_t size) : m_Data(data), m_Size(size) {}
+	// Any container with contiguous data() and size(), e.g. a std::vector (but not another Span, which is copied as usual)
+	template<typename Container, typename = typename std::enable_if<!std::is_same<typename std::remove_const<Container>::type, Span>::value>::type>
+	Span(Container& container) : m_Data(container.data()), m_Size(container.size()) {}
+
+	inline T* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+	inline size_t GetSizeInBytes() const { return m_Size * sizeof(T); }
+	inline bool IsEmpty() const { return m_Size == 0; }
+	inline T& operator[](size_t index) const { return m_Data[index]; }
+
+	// For range-based for loops
+	inline T* begin() const { return m_Data; }
+	inline T* end() const { return m_Data + m_Size; }
+};
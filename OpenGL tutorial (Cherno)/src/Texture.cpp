@@ -1,71 +1,180 @@
 #include "Texture.h"
 
+#include "CookedTexture.h"
+#include "TextureLoader.h"
 #include "vendor/stb_image/stb_image.h"
+#include <algorithm>
+#include <cstring>
+#include <future>
 #include <iostream>
+#include <memory>
 
-Texture::Texture(const std::string& filepath, const bool requiresGammaCorrection, const bool flipOnLoad)
-	: m_RendererID(0), m_Filepath(filepath), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BytesPerPixel(0)
+// Shown until the real image has been uploaded
+static const unsigned char PLACEHOLDER_TEXEL[4] = { 128, 128, 128, 255 };
+
+// A decoded cubemap face, always 3 channels since every face is uploaded as GL_RGB
+struct CubemapFace
 {
-	stbi_set_flip_vertically_on_load(flipOnLoad);
+	unsigned char* Pixels;
+	int Width, Height, BytesPerPixel;
+};
 
-	// Load texture from image
-	m_LocalBuffer = stbi_load(filepath.c_str(), &m_Width, &m_Height, &m_BytesPerPixel, 4);
+float Texture::s_DefaultAnisotropy = 1.0f;
 
+Texture::Texture(const std::string& filepath, const bool requiresGammaCorrection, const bool flipOnLoad, const MipmapFilter mipmaps)
+	: m_RendererID(0), m_Target(GL_TEXTURE_2D), m_InternalFormat(0), m_Filepath(filepath), m_Width(0), m_Height(0), m_BytesPerPixel(0), m_IsResident(false),
+	m_Mipmaps(mipmaps), m_NumLevels(1), m_HasStorage(false), m_StorageWidth(0), m_StorageHeight(0),
+	m_IsCompressed(false), m_CompressedFormat(COMPRESSED_BC1)
+{
 	// Generate and bind OpenGL texture
 	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, m_RendererID);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
 	// Set OpenGL texture parameters
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	// The 1x1 placeholder is a complete mip chain by itself, so the mipmapped filter is fine before the upload too
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps != MIPMAP_NONE ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+	// Requires gamma correction: linear RGBA8, otherwise already has gamma correction applied: sRGB
+	unsigned int internalFormat = requiresGammaCorrection ? GL_RGBA8 : GL_SRGB8;
+
+	// A cooked file replaces the image if it was stored the same way up and the driver can sample its format.
+	// Its mips are precomputed, so the mip filter only decides whether they are loaded. The file stays mapped
+	// until the loader has uploaded it.
+	int width = 0, height = 0, numComponents = 0;
+	std::shared_ptr<CookedTexture> cooked;
+	if (CookedTexture::IsEnabled())
+	{
+		cooked = std::make_shared<CookedTexture>(filepath);
+		if (!cooked->IsValid() || cooked->IsFlipped() != flipOnLoad || !CookedTexture::IsFormatSupported(cooked->GetFormat(), !requiresGammaCorrection))
+			cooked.reset();
+	}
+	if (cooked)
+	{
+		m_IsCompressed = cooked->GetFormat() != COOKED_TEXTURE_RGBA8;
+		if (m_IsCompressed)
+			m_CompressedFormat = (CompressedFormat)cooked->GetFormat();
+		internalFormat = CookedTexture::GetGLFormat(cooked->GetFormat(), !requiresGammaCorrection);
+		width = cooked->GetHeader().Width;
+		height = cooked->GetHeader().Height;
+	}
+	m_InternalFormat = internalFormat;
+
+	// Mipmapped textures allocate every level up front, which only needs the image header (read here, the pixels
+	// are still decoded in the background). The last level is 1x1, so the placeholder goes there and sampling is
+	// restricted to it until the upload moves the base level back to 0.
+	if (mipmaps != MIPMAP_NONE && HasTextureStorage() && (cooked || stbi_info(filepath.c_str(), &width, &height, &numComponents)))
+	{
+		m_NumLevels = MipmapGenerator::GetNumLevels(width, height);
+		m_HasStorage = true;
+		m_StorageWidth = width;
+		m_StorageHeight = height;
+		GLCall(glTexStorage2D(GL_TEXTURE_2D, m_NumLevels, internalFormat, width, height));
+		UploadPlaceholder(m_NumLevels - 1);
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, m_NumLevels - 1));
+	}
+	else
+	{
+		UploadPlaceholder(0);
+	}
+	if (s_DefaultAnisotropy > 1.0f)
+		SetAnisotropy(s_DefaultAnisotropy);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
+
+	// Decode on a worker thread, the image replaces the placeholder once it has been uploaded
+	TextureLoader::GetInstance()->Request(this, filepath, internalFormat, flipOnLoad, cooked);
+}
+
+Texture::Texture(const CookedTexture& cooked, const bool requiresGammaCorrection, const MipmapFilter mipmaps)
+	: m_RendererID(0), m_Target(GL_TEXTURE_2D), m_InternalFormat(requiresGammaCorrection ? GL_RGBA8 : GL_SRGB8), m_Filepath(cooked.GetSourcePath()),
+	m_Width(0), m_Height(0), m_BytesPerPixel(0), m_IsResident(true),
+	m_Mipmaps(mipmaps), m_NumLevels(1), m_HasStorage(false), m_StorageWidth(0), m_StorageHeight(0),
+	m_IsCompressed(false), m_CompressedFormat(COMPRESSED_BC1)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, m_RendererID);
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps != MIPMAP_NONE ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
 
-	// Send the local image buffer to the GPU
-	if (requiresGammaCorrection) 
+	if (!cooked.IsValid() || !CookedTexture::IsFormatSupported(cooked.GetFormat(), !requiresGammaCorrection))
 	{
-		// Requires gamma correction
-		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-	} else {
-		// Already has gamma correction applied
-		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
+		std::cout << "[ERROR] Cooked texture can't be loaded: " << CookedTexture::GetPath(cooked.GetSourcePath()) << std::endl;
+		UploadPlaceholder(0);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
+		return;
 	}
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
 
-	// Delete local texture buffer now that we've sent it to the GPU
-	if (m_LocalBuffer)
-		stbi_image_free(m_LocalBuffer);
+	const CookedTextureHeader& header = cooked.GetHeader();
+	m_IsCompressed = cooked.GetFormat() != COOKED_TEXTURE_RGBA8;
+	if (m_IsCompressed)
+		m_CompressedFormat = (CompressedFormat)cooked.GetFormat();
+	m_InternalFormat = CookedTexture::GetGLFormat(cooked.GetFormat(), !requiresGammaCorrection);
+	m_NumLevels = mipmaps != MIPMAP_NONE ? header.NumLevels : 1;
+	if (HasTextureStorage())
+	{
+		m_HasStorage = true;
+		m_StorageWidth = header.Width;
+		m_StorageHeight = header.Height;
+		GLCall(glTexStorage2D(GL_TEXTURE_2D, m_NumLevels, m_InternalFormat, header.Width, header.Height));
+	}
+	UploadCooked(cooked, m_NumLevels);
+	m_Width = header.Width;
+	m_Height = header.Height;
+	m_BytesPerPixel = 4;
+
+	if (s_DefaultAnisotropy > 1.0f)
+		SetAnisotropy(s_DefaultAnisotropy);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
 }
 
 // Load cubemap texture
 Texture::Texture(const std::vector<std::string>& cubemapFilepaths, const bool flipOnLoad)
-	: m_RendererID(0), 
+	: m_RendererID(0), m_Target(GL_TEXTURE_CUBE_MAP), m_InternalFormat(GL_RGB),
 	m_Filepath(cubemapFilepaths[0]), // TODO, currently just stores the first filepath 
-	m_LocalBuffer(nullptr), 
-	m_Width(0), m_Height(0), m_BytesPerPixel(0)
+	m_Width(0), m_Height(0), m_BytesPerPixel(0),
+	m_IsResident(true), m_Mipmaps(MIPMAP_NONE), m_NumLevels(1), m_HasStorage(false), m_StorageWidth(0), m_StorageHeight(0),
+	m_IsCompressed(false), m_CompressedFormat(COMPRESSED_BC1)
 {
-	stbi_set_flip_vertically_on_load(flipOnLoad);
+	// Decode all faces in parallel, each on its own thread (the flip flag is per thread, so the global one is left alone)
+	std::vector<std::future<CubemapFace>> faces;
+	for (unsigned int i = 0; i < cubemapFilepaths.size(); i++)
+	{
+		faces.push_back(std::async(std::launch::async, [&cubemapFilepaths, i, flipOnLoad]()
+		{
+			CubemapFace face;
+			stbi_set_flip_vertically_on_load_thread(flipOnLoad);
+			face.Pixels = stbi_load(cubemapFilepaths[i].c_str(), &face.Width, &face.Height, &face.BytesPerPixel, 3);
+			return face;
+		}));
+	}
 
 	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_CUBE_MAP, m_RendererID));
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, m_RendererID);
 
-	for (unsigned int i = 0; i < cubemapFilepaths.size(); i++)
+	for (unsigned int i = 0; i < faces.size(); i++)
 	{
-		unsigned char* data = stbi_load(cubemapFilepaths[i].c_str(), &m_Width, &m_Height, &m_BytesPerPixel, 0);
+		CubemapFace face = faces[i].get();
 
-		if (data)
+		if (face.Pixels)
 		{
-			GLCall(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, m_Width, m_Height, 0, GL_RGB, GL_UNSIGNED_BYTE, data));
+			m_Width = face.Width;
+			m_Height = face.Height;
+			m_BytesPerPixel = 3;
+			GLCall(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, m_Width, m_Height, 0, GL_RGB, GL_UNSIGNED_BYTE, face.Pixels));
 		}
 		else
 		{
 			std::cout << "[ERROR] Cubemap texture failed to load at path: " << cubemapFilepaths[i] << std::endl;
 		}
 
-		stbi_image_free(data);
+		stbi_image_free(face.Pixels);
 	}
 	GLCall(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
 	GLCall(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
@@ -76,28 +185,120 @@ Texture::Texture(const std::vector<std::string>& cubemapFilepaths, const bool fl
 
 Texture::~Texture()
 {
+	if (!m_IsResident)
+		TextureLoader::GetInstance()->Cancel(this);
 	// Delete texture data on GPU
 	GLCall(glDeleteTextures(1, &m_RendererID));
+	GLStateCache::OnTextureDeleted(m_RendererID);
+}
+
+void Texture::UploadPlaceholder(unsigned int level)
+{
+	if (!m_IsCompressed)
+	{
+		UploadLevel(level, 1, 1, PLACEHOLDER_TEXEL, sizeof(PLACEHOLDER_TEXEL));
+		return;
+	}
+
+	// Even a 1x1 level takes a whole block
+	unsigned char pixels[16 * 4];
+	unsigned char block[16];
+	for (int i = 0; i < 16; i++)
+		memcpy(pixels + i * 4, PLACEHOLDER_TEXEL, 4);
+	TextureCompressor::CompressBlock(m_CompressedFormat, pixels, block);
+	UploadLevel(level, 1, 1, block, TextureCompressor::GetBlockSize(m_CompressedFormat));
+}
+
+void Texture::UploadLevel(unsigned int level, int width, int height, const void* data, size_t size)
+{
+	if (m_IsCompressed)
+	{
+		if (m_HasStorage)
+		{
+			GLCall(glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, m_InternalFormat, size, data));
+		}
+		else
+		{
+			GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, level, m_InternalFormat, width, height, 0, size, data));
+		}
+	}
+	else
+	{
+		if (m_HasStorage)
+		{
+			GLCall(glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data));
+		}
+		else
+		{
+			GLCall(glTexImage2D(GL_TEXTURE_2D, level, m_InternalFormat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data));
+		}
+	}
+}
+
+void Texture::UploadCooked(const CookedTexture& cooked, unsigned int numLevels)
+{
+	// Level data in the file is exactly what GL expects, so the mapping is the source of the upload. Pages not yet
+	// resident are read from the disk while the driver copies them.
+	const CookedTextureHeader& header = cooked.GetHeader();
+	for (unsigned int i = 0; i < numLevels; i++)
+		UploadLevel(i, header.Levels[i].Width, header.Levels[i].Height, cooked.GetLevelData(i), cooked.GetLevelSize(i));
 }
 
 void Texture::Bind(unsigned int textureSlot) const
 {
-	GLCall(glActiveTexture(GL_TEXTURE0 + textureSlot));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLStateCache::ActiveTexture(GL_TEXTURE0 + textureSlot);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, m_RendererID);
 }
 
 void Texture::Unbind() const
 {
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture::BindCubemap(unsigned int textureSlot) const
 {
-	GLCall(glActiveTexture(GL_TEXTURE0 + textureSlot));
-	GLCall(glBindTexture(GL_TEXTURE_CUBE_MAP, m_RendererID));
+	GLStateCache::ActiveTexture(GL_TEXTURE0 + textureSlot);
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, m_RendererID);
 }
 
 void Texture::UnbindCubemap() const
 {
-	GLCall(glBindTexture(GL_TEXTURE_CUBE_MAP, 0));
+	GLStateCache::BindTexture(GL_TEXTURE_CUBE_MAP, 0);
+}
+
+void Texture::SetAnisotropy(float anisotropy)
+{
+	float maxAnisotropy = GetMaxAnisotropy();
+	if (maxAnisotropy <= 1.0f)
+		return;
+	GLStateCache::BindTexture(m_Target, m_RendererID);
+	GLCall(glTexParameterf(m_Target, GL_TEXTURE_MAX_ANISOTROPY, std::min(std::max(anisotropy, 1.0f), maxAnisotropy)));
+}
+
+void Texture::SetMipmapsEnabled(bool enabled)
+{
+	if (m_Mipmaps == MIPMAP_NONE)
+		return;
+	GLStateCache::BindTexture(m_Target, m_RendererID);
+	GLCall(glTexParameteri(m_Target, GL_TEXTURE_MIN_FILTER, enabled ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+}
+
+float Texture::GetMaxAnisotropy()
+{
+	// Core in 4.6, the ARB and EXT extensions share the same enums
+	static float maxAnisotropy = -1.0f;
+	if (maxAnisotropy < 0.0f)
+	{
+		maxAnisotropy = 1.0f;
+		if (GLEW_VERSION_4_6 || GLEW_ARB_texture_filter_anisotropic || GLEW_EXT_texture_filter_anisotropic)
+		{
+			GLCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAnisotropy));
+		}
+	}
+	return maxAnisotropy;
+}
+
+bool Texture::HasTextureStorage()
+{
+	return GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
 }
@@ -1,18 +1,52 @@
 #pragma once
 
 #include "Renderer.h"
+#include "MipmapGenerator.h"
+#include "TextureCompressor.h"
+
+class CookedTexture;
 
 class Texture
 {
 
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Target; // GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+	unsigned int m_InternalFormat;
 	std::string m_Filepath;
-	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BytesPerPixel;
+	// False while a 2D texture is still the 1x1 placeholder (see TextureLoader)
+	bool m_IsResident;
+	MipmapFilter m_Mipmaps;
+	unsigned int m_NumLevels;
+	// Immutable storage (glTexStorage2D) with every level allocated in the constructor
+	bool m_HasStorage;
+	int m_StorageWidth, m_StorageHeight;
+	// Loaded from a cooked file (see CookedTexture) instead of the image itself
+	bool m_IsCompressed;
+	CompressedFormat m_CompressedFormat;
+
+	static float s_DefaultAnisotropy;
+
+	friend class TextureLoader;
+
+	// Fills the 1x1 level with the placeholder, in the texture's own format
+	void UploadPlaceholder(unsigned int level);
+	// Uploads one level of RGBA8 pixels or compressed blocks (from the bound unpack buffer if there is one)
+	void UploadLevel(unsigned int level, int width, int height, const void* data, size_t size);
+	// Uploads the first numLevels levels straight from the cooked file's mapping
+	void UploadCooked(const CookedTexture& cooked, unsigned int numLevels);
 
 public:
-	Texture(const std::string& filepath, const bool requiresGammaCorrection = true, const bool flipOnLoad = true);
+	// The image is loaded in the background: until IsResident() the texture is a 1x1 placeholder, and its size is 0.
+	// A cooked version of the image (<filepath>.ctex, see TextureCooker) is loaded instead if there is one.
+	// Prefer TextureCache::Get(), which shares one texture between every user of the same file.
+	Texture(const std::string& filepath, const bool requiresGammaCorrection = true, const bool flipOnLoad = true, const MipmapFilter mipmaps = MIPMAP_GPU);
+	// Uploads a cooked texture straight from its memory mapping, before returning (nothing is decoded or copied
+	// on the CPU, so this only waits for the file to be read). The texture stays a placeholder if the driver can't
+	// sample the cooked format.
+	Texture(const CookedTexture& cooked, const bool requiresGammaCorrection = true, const MipmapFilter mipmaps = MIPMAP_GPU);
+	// Decodes the six faces in parallel and uploads them straight away. Prefer TextureCache::GetCubemap().
 	Texture(const std::vector<std::string>& cubemapFilepaths, bool flipOnLoad = false);
 	~Texture();
 
@@ -25,6 +59,21 @@ public:
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
 	inline unsigned int GetID() const { return m_RendererID; }
+	inline bool IsResident() const { return m_IsResident; }
+	inline unsigned int GetNumLevels() const { return m_NumLevels; }
+	inline bool IsCompressed() const { return m_IsCompressed; }
+
+	// Anisotropic filtering (1 is off), clamped to what the driver supports. Binds the texture to the active unit.
+	void SetAnisotropy(float anisotropy);
+	// Without mipmaps only level 0 is sampled, used to measure what the mip chain saves. Binds the texture to the active unit.
+	void SetMipmapsEnabled(bool enabled);
+
+	// Applied to every 2D texture loaded from a file afterwards
+	static void SetDefaultAnisotropy(float anisotropy) { s_DefaultAnisotropy = anisotropy; }
+	static float GetDefaultAnisotropy() { return s_DefaultAnisotropy; }
+	// 1 if anisotropic filtering isn't supported
+	static float GetMaxAnisotropy();
+	static bool HasTextureStorage();
 
 	void BindAndSetRepeating(unsigned int textureSlot) const {
 		Bind(textureSlot);
@@ -0,0 +1,111 @@
+#include "TextureArray.h"
+
+#include "MipmapGenerator.h"
+#include "Texture.h"
+#include "vendor/stb_image/stb_image.h"
+#include <algorithm>
+#include <future>
+#include <iostream>
+
+// A decoded layer, always 4 channels since the array is RGBA8
+struct TextureArrayLayer
+{
+	unsigned char* Pixels;
+	int Width, Height;
+};
+
+TextureArray::TextureArray(const std::vector<std::string>& filepaths, const bool requiresGammaCorrection, const bool flipOnLoad)
+	: m_RendererID(0), m_Width(0), m_Height(0), m_NumLayers(0), m_NumLevels(1)
+{
+	// Decode all layers in parallel, each on its own thread (the flip flag is per thread, so the global one is left alone)
+	std::vector<std::future<TextureArrayLayer>> decodes;
+	for (unsigned int i = 0; i < filepaths.size(); i++)
+	{
+		decodes.push_back(std::async(std::launch::async, [&filepaths, i, flipOnLoad]()
+		{
+			TextureArrayLayer layer;
+			int numComponents = 0;
+			stbi_set_flip_vertically_on_load_thread(flipOnLoad);
+			layer.Pixels = stbi_load(filepaths[i].c_str(), &layer.Width, &layer.Height, &numComponents, 4);
+			return layer;
+		}));
+	}
+
+	std::vector<TextureArrayLayer> layers;
+	bool complete = true;
+	for (unsigned int i = 0; i < decodes.size(); i++)
+	{
+		layers.push_back(decodes[i].get());
+		const TextureArrayLayer& layer = layers.back();
+		if (!layer.Pixels)
+		{
+			std::cout << "[ERROR] Texture array layer failed to load at path: " << filepaths[i] << std::endl;
+			complete = false;
+		}
+		else if (layer.Width != layers[0].Width || layer.Height != layers[0].Height)
+		{
+			std::cout << "[Warning] Texture array layer " << filepaths[i] << " is " << layer.Width << "x" << layer.Height
+				<< ", not " << layers[0].Width << "x" << layers[0].Height << " like the first layer" << std::endl;
+			complete = false;
+		}
+	}
+
+	if (complete && !layers.empty())
+	{
+		m_Width = layers[0].Width;
+		m_Height = layers[0].Height;
+		m_NumLayers = layers.size();
+		m_NumLevels = MipmapGenerator::GetNumLevels(m_Width, m_Height);
+		unsigned int internalFormat = requiresGammaCorrection ? GL_RGBA8 : GL_SRGB8;
+
+		GLCall(glGenTextures(1, &m_RendererID));
+		GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+		if (Texture::HasTextureStorage())
+		{
+			GLCall(glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_NumLevels, internalFormat, m_Width, m_Height, m_NumLayers));
+		}
+		else
+		{
+			GLCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, m_Width, m_Height, m_NumLayers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+		}
+		// RGBA8 rows are always 4 byte aligned, so the default unpack alignment is fine
+		for (unsigned int i = 0; i < m_NumLayers; i++)
+		{
+			GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, m_Width, m_Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, layers[i].Pixels));
+		}
+		GLCall(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+
+		GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+		GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+		GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT));
+		GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT));
+		float maxAnisotropy = Texture::GetMaxAnisotropy();
+		if (Texture::GetDefaultAnisotropy() > 1.0f && maxAnisotropy > 1.0f)
+		{
+			GLCall(glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_ANISOTROPY, std::min(Texture::GetDefaultAnisotropy(), maxAnisotropy)));
+		}
+		GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	for (const TextureArrayLayer& layer : layers)
+		stbi_image_free(layer.Pixels);
+}
+
+TextureArray::~TextureArray()
+{
+	if (m_RendererID != 0)
+	{
+		GLCall(glDeleteTextures(1, &m_RendererID));
+		GLStateCache::OnTextureDeleted(m_RendererID);
+	}
+}
+
+void TextureArray::Bind(unsigned int slot) const
+{
+	GLStateCache::BindTextureUnit(slot, GL_TEXTURE_2D_ARRAY, m_RendererID);
+}
+
+void TextureArray::Unbind() const
+{
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
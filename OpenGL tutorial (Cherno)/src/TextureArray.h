@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Renderer.h"
+
+// Same-sized images packed into the layers of one GL_TEXTURE_2D_ARRAY, so meshes that would each bind their own
+// texture can share a single bind and pick their image with a layer index (see Model::UseTextureArray).
+// Layers are decoded in parallel and uploaded before the constructor returns, as RGBA8 with a GPU generated mip
+// chain, the same as the model textures loaded through TextureCache.
+class TextureArray
+{
+private:
+	unsigned int m_RendererID;
+	int m_Width, m_Height;
+	unsigned int m_NumLayers;
+	unsigned int m_NumLevels;
+
+public:
+	// Layer i is filepaths[i]. Every image must have the same size, otherwise (or if one fails to load) nothing is
+	// uploaded and IsValid() is false.
+	TextureArray(const std::vector<std::string>& filepaths, const bool requiresGammaCorrection = true, const bool flipOnLoad = true);
+	~TextureArray();
+
+	void Bind(unsigned int slot = 0) const;
+	void Unbind() const;
+
+	inline bool IsValid() const { return m_NumLayers > 0; }
+	inline unsigned int GetID() const { return m_RendererID; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline unsigned int GetNumLayers() const { return m_NumLayers; }
+	inline unsigned int GetNumLevels() const { return m_NumLevels; }
+};
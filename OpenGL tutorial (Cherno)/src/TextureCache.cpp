@@ -0,0 +1,79 @@
+#include "TextureCache.h"
+
+std::unordered_map<std::string, std::weak_ptr<Texture>> TextureCache::s_Textures;
+unsigned int TextureCache::s_NumHits = 0;
+unsigned int TextureCache::s_NumMisses = 0;
+bool TextureCache::s_MipmapsEnabled = true;
+
+std::shared_ptr<Texture> TextureCache::Get(const std::string& filepath, const bool requiresGammaCorrection, const bool flipOnLoad, const MipmapFilter mipmaps)
+{
+	std::weak_ptr<Texture>& entry = s_Textures[MakeKey(filepath, requiresGammaCorrection, flipOnLoad, mipmaps)];
+	std::shared_ptr<Texture> texture = entry.lock();
+	if (texture)
+	{
+		s_NumHits++;
+		return texture;
+	}
+
+	// Either never loaded, or every previous handle has been released (which deleted the texture)
+	texture = std::make_shared<Texture>(filepath, requiresGammaCorrection, flipOnLoad, mipmaps);
+	if (!s_MipmapsEnabled)
+		texture->SetMipmapsEnabled(false);
+	entry = texture;
+	s_NumMisses++;
+	return texture;
+}
+
+std::shared_ptr<Texture> TextureCache::GetCubemap(const std::vector<std::string>& cubemapFilepaths, const bool flipOnLoad)
+{
+	std::string key;
+	for (const std::string& filepath : cubemapFilepaths)
+		key += filepath + '|';
+	key += flipOnLoad ? 'f' : '-';
+
+	std::weak_ptr<Texture>& entry = s_Textures[key];
+	std::shared_ptr<Texture> texture = entry.lock();
+	if (texture)
+	{
+		s_NumHits++;
+		return texture;
+	}
+
+	texture = std::make_shared<Texture>(cubemapFilepaths, flipOnLoad);
+	entry = texture;
+	s_NumMisses++;
+	return texture;
+}
+
+void TextureCache::SetMipmapsEnabled(bool enabled)
+{
+	s_MipmapsEnabled = enabled;
+	for (const auto& entry : s_Textures)
+	{
+		std::shared_ptr<Texture> texture = entry.second.lock();
+		if (texture)
+			texture->SetMipmapsEnabled(enabled);
+	}
+}
+
+unsigned int TextureCache::GetNumTextures()
+{
+	unsigned int numTextures = 0;
+	for (const auto& entry : s_Textures)
+	{
+		if (!entry.second.expired())
+			numTextures++;
+	}
+	return numTextures;
+}
+
+std::string TextureCache::MakeKey(const std::string& filepath, bool requiresGammaCorrection, bool flipOnLoad, MipmapFilter mipmaps)
+{
+	// '|' can't appear in a path on Windows, so the flags can never be mistaken for part of one
+	std::string key = filepath;
+	key += '|';
+	key += requiresGammaCorrection ? 'g' : '-';
+	key += flipOnLoad ? 'f' : '-';
+	key += (char)('0' + mipmaps);
+	return key;
+}
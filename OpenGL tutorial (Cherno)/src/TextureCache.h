@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.h"
+
+// Shares 2D textures and cubemaps loaded from files between everything that uses them (the tests and Model).
+// Entries are keyed by the file path together with the flags that change what ends up on the GPU
+// (gamma correction, flip, mip filter), so each unique image is decoded and uploaded once. Handles are reference
+// counted: the cache only holds weak references, and a texture is deleted once its last handle is released.
+// Since the GL texture object is shared, so are its sampler parameters (e.g. BindAndSetRepeating()).
+class TextureCache
+{
+public:
+	// Same arguments as Texture's file constructor, returns the existing texture if one is still alive
+	static std::shared_ptr<Texture> Get(const std::string& filepath, const bool requiresGammaCorrection = true, const bool flipOnLoad = true, const MipmapFilter mipmaps = MIPMAP_GPU);
+	// Same arguments as Texture's cubemap constructor, keyed by all six face paths
+	static std::shared_ptr<Texture> GetCubemap(const std::vector<std::string>& cubemapFilepaths, const bool flipOnLoad = false);
+
+	// Switches mipmapping on or off for every cached texture, current and future (for benchmarking)
+	static void SetMipmapsEnabled(bool enabled);
+	static bool AreMipmapsEnabled() { return s_MipmapsEnabled; }
+
+	// Number of textures currently alive, and how many requests were served by them instead of loading the file
+	static unsigned int GetNumTextures();
+	static unsigned int GetNumHits() { return s_NumHits; }
+	static unsigned int GetNumMisses() { return s_NumMisses; }
+
+private:
+	static std::string MakeKey(const std::string& filepath, bool requiresGammaCorrection, bool flipOnLoad, MipmapFilter mipmaps);
+
+	static std::unordered_map<std::string, std::weak_ptr<Texture>> s_Textures;
+	static unsigned int s_NumHits;
+	static unsigned int s_NumMisses;
+	static bool s_MipmapsEnabled;
+};
@@ -0,0 +1,485 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTURE_COMPRESSOR_SSE2
+#endif
+
+// A pixel or palette entry as floats in [0, 255], aligned so SSE2 can load it directly.
+// Channels a format doesn't store are left at 0 on both sides, so they never add to the error.
+struct alignas(16) Colour
+{
+	float c[4];
+};
+
+// Interpolation weights (out of 64) of BC7's 4 bit indices, and as fractions for the endpoint refinement
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+static const float BC7_WEIGHT_FRACTIONS[16] = { 0 / 64.0f, 4 / 64.0f, 9 / 64.0f, 13 / 64.0f, 17 / 64.0f, 21 / 64.0f, 26 / 64.0f, 30 / 64.0f,
+	34 / 64.0f, 38 / 64.0f, 43 / 64.0f, 47 / 64.0f, 51 / 64.0f, 55 / 64.0f, 60 / 64.0f, 64 / 64.0f };
+
+// Writes a block bit by bit, least significant bit first (the block must start zeroed)
+struct BitWriter
+{
+	unsigned char* Data;
+	int Position;
+
+	void Write(unsigned int value, int numBits)
+	{
+		for (int i = 0; i < numBits; i++, Position++)
+		{
+			if ((value >> i) & 1)
+				Data[Position >> 3] |= 1 << (Position & 7);
+		}
+	}
+};
+
+static void LoadBlock(const unsigned char* pixels, int numChannels, Colour* colours)
+{
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 4; c++)
+			colours[i].c[c] = c < numChannels ? (float)pixels[i * 4 + c] : 0.0f;
+	}
+}
+
+// Picks the closest palette entry for each pixel, returns the summed squared error
+static float FitIndices(const Colour* pixels, const Colour* palette, int paletteSize, int* indices)
+{
+	float totalError = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		float bestError = FLT_MAX;
+		int bestIndex = 0;
+#ifdef TEXTURE_COMPRESSOR_SSE2
+		__m128 pixel = _mm_load_ps(pixels[i].c);
+		for (int j = 0; j < paletteSize; j++)
+		{
+			__m128 diff = _mm_sub_ps(pixel, _mm_load_ps(palette[j].c));
+			__m128 error = _mm_mul_ps(diff, diff);
+			// Horizontal sum of the four channels
+			error = _mm_add_ps(error, _mm_shuffle_ps(error, error, _MM_SHUFFLE(1, 0, 3, 2)));
+			error = _mm_add_ss(error, _mm_shuffle_ps(error, error, _MM_SHUFFLE(2, 3, 0, 1)));
+			float errorSum = _mm_cvtss_f32(error);
+			if (errorSum < bestError)
+			{
+				bestError = errorSum;
+				bestIndex = j;
+			}
+		}
+#else
+		for (int j = 0; j < paletteSize; j++)
+		{
+			float errorSum = 0.0f;
+			for (int c = 0; c < 4; c++)
+			{
+				float diff = pixels[i].c[c] - palette[j].c[c];
+				errorSum += diff * diff;
+			}
+			if (errorSum < bestError)
+			{
+				bestError = errorSum;
+				bestIndex = j;
+			}
+		}
+#endif
+		indices[i] = bestIndex;
+		totalError += bestError;
+	}
+	return totalError;
+}
+
+// Fits the endpoints of the block's principal axis (power iteration on the colour covariance),
+// trimmed slightly inwards since the extremes are usually better served by the interpolated entries
+static void PrincipalAxisEndpoints(const Colour* pixels, Colour& start, Colour& end)
+{
+	float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 4; c++)
+			mean[c] += pixels[i].c[c] / 16.0f;
+	}
+
+	float covariance[4][4] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		for (int a = 0; a < 4; a++)
+		{
+			for (int b = 0; b < 4; b++)
+				covariance[a][b] += (pixels[i].c[a] - mean[a]) * (pixels[i].c[b] - mean[b]);
+		}
+	}
+
+	// Start from the channel that varies most
+	float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	int largest = 0;
+	for (int c = 1; c < 4; c++)
+	{
+		if (covariance[c][c] > covariance[largest][largest])
+			largest = c;
+	}
+	axis[largest] = 1.0f;
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float length = 0.0f;
+		for (int a = 0; a < 4; a++)
+		{
+			for (int b = 0; b < 4; b++)
+				next[a] += covariance[a][b] * axis[b];
+			length += next[a] * next[a];
+		}
+		if (length < 1e-12f)
+			break;
+		length = std::sqrt(length);
+		for (int c = 0; c < 4; c++)
+			axis[c] = next[c] / length;
+	}
+
+	float minProjection = FLT_MAX, maxProjection = -FLT_MAX;
+	for (int i = 0; i < 16; i++)
+	{
+		float projection = 0.0f;
+		for (int c = 0; c < 4; c++)
+			projection += (pixels[i].c[c] - mean[c]) * axis[c];
+		minProjection = std::min(minProjection, projection);
+		maxProjection = std::max(maxProjection, projection);
+	}
+	float inset = (maxProjection - minProjection) / 32.0f;
+	minProjection += inset;
+	maxProjection -= inset;
+
+	for (int c = 0; c < 4; c++)
+	{
+		start.c[c] = std::min(std::max(mean[c] + axis[c] * maxProjection, 0.0f), 255.0f);
+		end.c[c] = std::min(std::max(mean[c] + axis[c] * minProjection, 0.0f), 255.0f);
+	}
+}
+
+// Least squares endpoints for fixed indices, where weights[index] is how far along from start to end each entry is.
+// Returns false (leaving the endpoints alone) if every pixel uses the same weight.
+static bool RefineEndpoints(const Colour* pixels, const int* indices, const float* weights, Colour& start, Colour& end)
+{
+	float alpha2 = 0.0f, beta2 = 0.0f, alphaBeta = 0.0f;
+	float alphaX[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, betaX[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		float beta = weights[indices[i]];
+		float alpha = 1.0f - beta;
+		alpha2 += alpha * alpha;
+		beta2 += beta * beta;
+		alphaBeta += alpha * beta;
+		for (int c = 0; c < 4; c++)
+		{
+			alphaX[c] += alpha * pixels[i].c[c];
+			betaX[c] += beta * pixels[i].c[c];
+		}
+	}
+
+	float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+	if (std::fabs(determinant) < 1e-6f)
+		return false;
+	for (int c = 0; c < 4; c++)
+	{
+		start.c[c] = std::min(std::max((alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant, 0.0f), 255.0f);
+		end.c[c] = std::min(std::max((betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant, 0.0f), 255.0f);
+	}
+	return true;
+}
+
+static unsigned short PackRGB565(const Colour& colour)
+{
+	unsigned int r = (unsigned int)(colour.c[0] * 31.0f / 255.0f + 0.5f);
+	unsigned int g = (unsigned int)(colour.c[1] * 63.0f / 255.0f + 0.5f);
+	unsigned int b = (unsigned int)(colour.c[2] * 31.0f / 255.0f + 0.5f);
+	return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+static Colour UnpackRGB565(unsigned short packed)
+{
+	unsigned int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	Colour colour = { { (float)((r << 3) | (r >> 2)), (float)((g << 2) | (g >> 4)), (float)((b << 3) | (b >> 2)), 0.0f } };
+	return colour;
+}
+
+// BC1 colour block, always in 4 colour mode (which BC3 requires). Alpha is ignored.
+static void EncodeColourBlock(const unsigned char* rgba, unsigned char* block)
+{
+	// Palette order is start, end, then the two thirds in between
+	static const float WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+	Colour pixels[16];
+	LoadBlock(rgba, 3, pixels);
+	Colour start, end;
+	PrincipalAxisEndpoints(pixels, start, end);
+
+	float bestError = FLT_MAX;
+	for (int iteration = 0; iteration < 2; iteration++)
+	{
+		unsigned short colour0 = PackRGB565(start), colour1 = PackRGB565(end);
+		// colour0 > colour1 selects 4 colour mode, equal endpoints fall back to 3 colour mode where index 0 is still exact
+		if (colour0 < colour1)
+			std::swap(colour0, colour1);
+
+		Colour palette[4];
+		palette[0] = UnpackRGB565(colour0);
+		palette[1] = UnpackRGB565(colour1);
+		for (int c = 0; c < 4; c++)
+		{
+			palette[2].c[c] = (2.0f * palette[0].c[c] + palette[1].c[c]) / 3.0f;
+			palette[3].c[c] = (palette[0].c[c] + 2.0f * palette[1].c[c]) / 3.0f;
+		}
+		int indices[16];
+		float error = FitIndices(pixels, palette, colour0 == colour1 ? 1 : 4, indices);
+		if (error < bestError)
+		{
+			bestError = error;
+			unsigned int packedIndices = 0;
+			for (int i = 0; i < 16; i++)
+				packedIndices |= (unsigned int)indices[i] << (i * 2);
+			block[0] = colour0 & 0xFF;
+			block[1] = colour0 >> 8;
+			block[2] = colour1 & 0xFF;
+			block[3] = colour1 >> 8;
+			for (int i = 0; i < 4; i++)
+				block[4 + i] = (packedIndices >> (i * 8)) & 0xFF;
+		}
+
+		start = palette[0];
+		end = palette[1];
+		if (error == 0.0f || !RefineEndpoints(pixels, indices, WEIGHTS, start, end))
+			break;
+	}
+}
+
+// Builds a BC4 palette: 8 entries if value0 > value1, otherwise 6 entries plus 0 and 255
+static void BuildBC4Palette(int value0, int value1, Colour* palette)
+{
+	float values[8];
+	values[0] = (float)value0;
+	values[1] = (float)value1;
+	if (value0 > value1)
+	{
+		for (int i = 1; i <= 6; i++)
+			values[i + 1] = (float)(((7 - i) * value0 + i * value1) / 7);
+	}
+	else
+	{
+		for (int i = 1; i <= 4; i++)
+			values[i + 1] = (float)(((5 - i) * value0 + i * value1) / 5);
+		values[6] = 0.0f;
+		values[7] = 255.0f;
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		palette[i].c[0] = values[i];
+		palette[i].c[1] = palette[i].c[2] = palette[i].c[3] = 0.0f;
+	}
+}
+
+// BC4 block for one channel of the pixels
+static void EncodeChannelBlock(const unsigned char* rgba, int channel, unsigned char* block)
+{
+	Colour pixels[16];
+	int minValue = 255, maxValue = 0;
+	int minInner = 255, maxInner = 0; // Ignoring 0 and 255, which 6 entry mode can represent exactly
+	for (int i = 0; i < 16; i++)
+	{
+		int value = rgba[i * 4 + channel];
+		pixels[i].c[0] = (float)value;
+		pixels[i].c[1] = pixels[i].c[2] = pixels[i].c[3] = 0.0f;
+		minValue = std::min(minValue, value);
+		maxValue = std::max(maxValue, value);
+		if (value != 0 && value != 255)
+		{
+			minInner = std::min(minInner, value);
+			maxInner = std::max(maxInner, value);
+		}
+	}
+
+	// Candidate endpoint pairs: the full range, then the inner range in 6 entry mode if the block touches 0 or 255
+	int candidates[2][2] = { { maxValue, minValue }, { minInner, maxInner } };
+	int numCandidates = (minValue == 0 || maxValue == 255) && minInner <= maxInner ? 2 : 1;
+
+	float bestError = FLT_MAX;
+	for (int candidate = 0; candidate < numCandidates; candidate++)
+	{
+		int value0 = candidates[candidate][0], value1 = candidates[candidate][1];
+		Colour palette[8];
+		BuildBC4Palette(value0, value1, palette);
+		int indices[16];
+		float error = FitIndices(pixels, palette, 8, indices);
+		if (error >= bestError)
+			continue;
+
+		bestError = error;
+		unsigned long long packedIndices = 0;
+		for (int i = 0; i < 16; i++)
+			packedIndices |= (unsigned long long)indices[i] << (i * 3);
+		block[0] = (unsigned char)value0;
+		block[1] = (unsigned char)value1;
+		for (int i = 0; i < 6; i++)
+			block[2 + i] = (packedIndices >> (i * 8)) & 0xFF;
+	}
+}
+
+// Rounds an endpoint to 7 bits per channel plus the shared p bit, choosing whichever p bit is closer
+static void QuantizeBC7Endpoint(const Colour& endpoint, unsigned int quantized[4], unsigned int& pBit)
+{
+	float bestError = FLT_MAX;
+	for (unsigned int p = 0; p < 2; p++)
+	{
+		unsigned int candidate[4];
+		float error = 0.0f;
+		for (int c = 0; c < 4; c++)
+		{
+			int value = (int)std::floor((endpoint.c[c] - p) / 2.0f + 0.5f);
+			candidate[c] = (unsigned int)std::min(std::max(value, 0), 127);
+			float diff = endpoint.c[c] - (float)((candidate[c] << 1) | p);
+			error += diff * diff;
+		}
+		if (error < bestError)
+		{
+			bestError = error;
+			pBit = p;
+			for (int c = 0; c < 4; c++)
+				quantized[c] = candidate[c];
+		}
+	}
+}
+
+// BC7 block in mode 6: one RGBA endpoint pair (7 bits per channel + a p bit each) and 4 bit indices
+static void EncodeBC7Block(const unsigned char* rgba, unsigned char* block)
+{
+	Colour pixels[16];
+	LoadBlock(rgba, 4, pixels);
+	Colour start, end;
+	PrincipalAxisEndpoints(pixels, start, end);
+
+	float bestError = FLT_MAX;
+	for (int iteration = 0; iteration < 2; iteration++)
+	{
+		unsigned int quantized[2][4], pBits[2];
+		QuantizeBC7Endpoint(start, quantized[0], pBits[0]);
+		QuantizeBC7Endpoint(end, quantized[1], pBits[1]);
+
+		// Palette exactly as the decoder computes it
+		int endpoints[2][4];
+		for (int e = 0; e < 2; e++)
+		{
+			for (int c = 0; c < 4; c++)
+				endpoints[e][c] = (quantized[e][c] << 1) | pBits[e];
+		}
+		Colour palette[16];
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 4; c++)
+				palette[i].c[c] = (float)(((64 - BC7_WEIGHTS[i]) * endpoints[0][c] + BC7_WEIGHTS[i] * endpoints[1][c] + 32) >> 6);
+		}
+		int indices[16];
+		float error = FitIndices(pixels, palette, 16, indices);
+		if (error < bestError)
+		{
+			bestError = error;
+			// The first index is stored without its top bit, so it must be below 8: if not, swap the endpoints
+			int swapped = indices[0] >= 8 ? 1 : 0;
+			memset(block, 0, 16);
+			BitWriter writer = { block, 0 };
+			writer.Write(1 << 6, 7); // Mode 6
+			for (int c = 0; c < 4; c++)
+			{
+				writer.Write(quantized[swapped][c], 7);
+				writer.Write(quantized[1 - swapped][c], 7);
+			}
+			writer.Write(pBits[swapped], 1);
+			writer.Write(pBits[1 - swapped], 1);
+			for (int i = 0; i < 16; i++)
+				writer.Write(swapped ? 15 - indices[i] : indices[i], i == 0 ? 3 : 4);
+		}
+
+		for (int c = 0; c < 4; c++)
+		{
+			start.c[c] = (float)endpoints[0][c];
+			end.c[c] = (float)endpoints[1][c];
+		}
+		if (error == 0.0f || !RefineEndpoints(pixels, indices, BC7_WEIGHT_FRACTIONS, start, end))
+			break;
+	}
+}
+
+unsigned int TextureCompressor::GetBlockSize(CompressedFormat format)
+{
+	return format == COMPRESSED_BC1 ? 8 : 16;
+}
+
+size_t TextureCompressor::GetCompressedSize(CompressedFormat format, int width, int height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+void TextureCompressor::CompressBlock(CompressedFormat format, const unsigned char* pixels, unsigned char* block)
+{
+	switch (format)
+	{
+	case COMPRESSED_BC1:
+		EncodeColourBlock(pixels, block);
+		break;
+	case COMPRESSED_BC3:
+		EncodeChannelBlock(pixels, 3, block);
+		EncodeColourBlock(pixels, block + 8);
+		break;
+	case COMPRESSED_BC5:
+		EncodeChannelBlock(pixels, 0, block);
+		EncodeChannelBlock(pixels, 1, block + 8);
+		break;
+	case COMPRESSED_BC7:
+		EncodeBC7Block(pixels, block);
+		break;
+	}
+}
+
+void TextureCompressor::Compress(CompressedFormat format, const unsigned char* pixels, int width, int height,
+	std::vector<unsigned char>& compressed, unsigned int numThreads)
+{
+	int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	unsigned int blockSize = GetBlockSize(format);
+	compressed.assign((size_t)blocksX * blocksY * blockSize, 0);
+
+	// Threads take every numThreads-th row of blocks, which keeps their share of detailed and flat areas even
+	if (numThreads == 0)
+		numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	numThreads = std::min(numThreads, (unsigned int)blocksY);
+	auto compressRows = [&](unsigned int firstRow)
+	{
+		unsigned char blockPixels[64];
+		for (int blockY = firstRow; blockY < blocksY; blockY += numThreads)
+		{
+			for (int blockX = 0; blockX < blocksX; blockX++)
+			{
+				// Edge pixels are repeated to fill blocks that hang over the image
+				for (int y = 0; y < 4; y++)
+				{
+					int sourceY = std::min(blockY * 4 + y, height - 1);
+					for (int x = 0; x < 4; x++)
+					{
+						int sourceX = std::min(blockX * 4 + x, width - 1);
+						memcpy(&blockPixels[(y * 4 + x) * 4], &pixels[((size_t)sourceY * width + sourceX) * 4], 4);
+					}
+				}
+				CompressBlock(format, blockPixels, &compressed[((size_t)blockY * blocksX + blockX) * blockSize]);
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1; i < numThreads; i++)
+		threads.push_back(std::thread(compressRows, i));
+	compressRows(0);
+	for (std::thread& thread : threads)
+		thread.join();
+}
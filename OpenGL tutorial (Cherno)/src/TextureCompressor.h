@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Block compressed formats written by the texture cooker (see CookedTexture). Every format encodes 4x4 pixel blocks.
+enum CompressedFormat {
+	COMPRESSED_BC1 = 1,	// RGB, 8 bytes per block (4 bits per pixel)
+	COMPRESSED_BC3,		// RGBA, 16 bytes per block: BC4 alpha followed by BC1 colour
+	COMPRESSED_BC5,		// RG, 16 bytes per block: two BC4 channels, for tangent space normal maps
+	COMPRESSED_BC7		// RGBA, 16 bytes per block, highest quality
+};
+
+// CPU encoder for BC1/BC3/BC5/BC7. Endpoints come from each block's principal axis, then the palette indices and
+// endpoints are refined by least squares. Index fitting (the inner loop) uses SSE2 when available, and images are
+// split into rows of blocks compressed on several threads.
+// BC7 blocks are always written in mode 6 (a single RGBA endpoint pair with 16 palette entries), which every decoder
+// supports and which handles the smooth gradients of photographic textures well. Modes with several subsets, which
+// help with sharp edges between two colours, are not searched.
+class TextureCompressor
+{
+public:
+	static unsigned int GetBlockSize(CompressedFormat format);
+	// Size in bytes of a width x height image in format (partial blocks at the edges count as whole ones)
+	static size_t GetCompressedSize(CompressedFormat format, int width, int height);
+
+	// Encodes one 4x4 block of RGBA8 pixels (row major, 64 bytes) into GetBlockSize(format) bytes
+	static void CompressBlock(CompressedFormat format, const unsigned char* pixels, unsigned char* block);
+	// Encodes a whole RGBA8 image, replicating edge pixels into partial blocks. numThreads 0 uses every core.
+	static void Compress(CompressedFormat format, const unsigned char* pixels, int width, int height,
+		std::vector<unsigned char>& compressed, unsigned int numThreads = 0);
+};
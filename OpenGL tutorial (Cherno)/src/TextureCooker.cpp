@@ -0,0 +1,254 @@
+#include "TextureCooker.h"
+
+#include "MipmapGenerator.h"
+#include "vendor/stb_image/stb_image.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+// File names marking images that hold data rather than colours: their mips are filtered without sRGB decoding
+static const char* DATA_IMAGE_MARKERS[] = { "normal", "height", "depth", "specular", "roughness", "metallic", "ao." };
+
+static double GetTimeMs()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::string ToLower(std::string string)
+{
+	std::transform(string.begin(), string.end(), string.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return string;
+}
+
+static std::string GetFileName(const std::string& path)
+{
+	size_t separator = path.find_last_of("/\\");
+	return separator == std::string::npos ? path : path.substr(separator + 1);
+}
+
+static bool IsImage(const std::string& fileName)
+{
+	std::string name = ToLower(fileName);
+	for (const char* extension : { ".png", ".jpg", ".jpeg", ".tga", ".bmp" })
+	{
+		size_t length = strlen(extension);
+		if (name.size() > length && name.compare(name.size() - length, length, extension) == 0)
+			return true;
+	}
+	return false;
+}
+
+static bool IsDataImage(const std::string& fileName)
+{
+	std::string name = ToLower(fileName);
+	for (const char* marker : DATA_IMAGE_MARKERS)
+	{
+		if (name.find(marker) != std::string::npos)
+			return true;
+	}
+	return false;
+}
+
+static const char* GetFormatName(CookedTextureFormat format)
+{
+	switch (format)
+	{
+	case COOKED_TEXTURE_RGBA8: return "RGBA8";
+	case COOKED_TEXTURE_BC1: return "BC1";
+	case COOKED_TEXTURE_BC3: return "BC3";
+	case COOKED_TEXTURE_BC5: return "BC5";
+	case COOKED_TEXTURE_BC7: return "BC7";
+	}
+	return "?";
+}
+
+static CookedTextureFormat ChooseFormat(const std::string& fileName, const unsigned char* pixels, int width, int height, TextureCookMode mode)
+{
+	if (mode == COOK_RAW)
+		return COOKED_TEXTURE_RGBA8;
+	if (ToLower(fileName).find("normal") != std::string::npos)
+		return COOKED_TEXTURE_BC5;
+	if (mode == COOK_BC7)
+		return COOKED_TEXTURE_BC7;
+	for (size_t i = 3; i < (size_t)width * height * 4; i += 4)
+	{
+		if (pixels[i] != 255)
+			return COOKED_TEXTURE_BC3;
+	}
+	return COOKED_TEXTURE_BC1;
+}
+
+// Encodes one level in the cooked format
+static void EncodeLevel(CookedTextureFormat format, const unsigned char* pixels, int width, int height, std::vector<unsigned char>& level)
+{
+	if (format == COOKED_TEXTURE_RGBA8)
+		level.assign(pixels, pixels + (size_t)width * height * 4);
+	else
+		TextureCompressor::Compress((CompressedFormat)format, pixels, width, height, level);
+}
+
+void TextureCooker::FindImages(const std::string& directory, std::vector<std::string>& images)
+{
+	std::vector<std::string> subdirectories;
+#ifdef _WIN32
+	WIN32_FIND_DATAA entry;
+	HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &entry);
+	if (find == INVALID_HANDLE_VALUE)
+		return;
+	do
+	{
+		std::string name = entry.cFileName;
+		if (name == "." || name == "..")
+			continue;
+		if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			subdirectories.push_back(name);
+		else if (IsImage(name))
+			images.push_back(directory + "/" + name);
+	} while (FindNextFileA(find, &entry));
+	FindClose(find);
+#else
+	DIR* dir = opendir(directory.c_str());
+	if (!dir)
+		return;
+	while (dirent* entry = readdir(dir))
+	{
+		std::string name = entry->d_name;
+		if (name == "." || name == "..")
+			continue;
+		struct stat info;
+		if (stat((directory + "/" + name).c_str(), &info) != 0)
+			continue;
+		if (S_ISDIR(info.st_mode))
+			subdirectories.push_back(name);
+		else if (IsImage(name))
+			images.push_back(directory + "/" + name);
+	}
+	closedir(dir);
+#endif
+
+	// Skyboxes are loaded as cubemaps, which are never cooked
+	for (const std::string& name : subdirectories)
+	{
+		if (ToLower(name).find("skybox") == std::string::npos)
+			FindImages(directory + "/" + name, images);
+	}
+}
+
+bool TextureCooker::Cook(const std::string& sourcePath, TextureCookMode mode, TextureCookReport& report)
+{
+	std::string fileName = GetFileName(sourcePath);
+
+	// Same orientation as Texture's default flipOnLoad, so the blocks can be uploaded as they are
+	double decodeStart = GetTimeMs();
+	stbi_set_flip_vertically_on_load_thread(true);
+	int width = 0, height = 0, numComponents = 0;
+	unsigned char* pixels = stbi_load(sourcePath.c_str(), &width, &height, &numComponents, 4);
+	report.DecodeMs = GetTimeMs() - decodeStart;
+	if (!pixels)
+	{
+		std::cout << "[ERROR] Texture failed to load at path: " << sourcePath << std::endl;
+		return false;
+	}
+
+	CookedTextureHeader header;
+	header.Format = ChooseFormat(fileName, pixels, width, height, mode);
+	header.Width = width;
+	header.Height = height;
+	header.Flags = COOKED_TEXTURE_FLAG_FLIPPED;
+	bool srgb = !IsDataImage(fileName);
+	if (srgb)
+		header.Flags |= COOKED_TEXTURE_FLAG_SRGB_MIPS;
+	if (!CookedTexture::GetSourceInfo(sourcePath, header.SourceSize, header.SourceModifiedTime))
+	{
+		header.SourceSize = 0;
+		header.SourceModifiedTime = 0;
+	}
+
+	std::vector<unsigned char> chain;
+	std::vector<MipLevel> mipLevels;
+	MipmapGenerator::Generate(pixels, width, height, srgb, MIPMAP_KAISER, chain, mipLevels);
+
+	CookedTextureFormat format = (CookedTextureFormat)header.Format;
+	std::vector<std::vector<unsigned char>> levels(mipLevels.size() + 1);
+	EncodeLevel(format, pixels, width, height, levels[0]);
+	for (unsigned int i = 0; i < mipLevels.size(); i++)
+		EncodeLevel(format, chain.data() + mipLevels[i].Offset, mipLevels[i].Width, mipLevels[i].Height, levels[i + 1]);
+	stbi_image_free(pixels);
+
+	if (!CookedTexture::Write(sourcePath, header, levels))
+		return false;
+
+	report.Format = format;
+	report.Width = width;
+	report.Height = height;
+	report.UncompressedSize = (size_t)width * height * 4 + chain.size();
+	report.CookedSize = 0;
+	for (const std::vector<unsigned char>& level : levels)
+		report.CookedSize += level.size();
+
+	// What loading it costs now, the same work TextureLoader's workers do (the file was only just written, so this
+	// measures mapping it from the OS file cache rather than the disk)
+	double readStart = GetTimeMs();
+	CookedTexture cooked(sourcePath);
+	if (!cooked.IsValid())
+	{
+		std::cout << "[ERROR] Cooked texture could not be read back: " << CookedTexture::GetPath(sourcePath) << std::endl;
+		return false;
+	}
+	cooked.Prefetch(cooked.GetHeader().NumLevels);
+	report.ReadMs = GetTimeMs() - readStart;
+	return true;
+}
+
+unsigned int TextureCooker::CookDirectories(const std::vector<std::string>& directories, TextureCookMode mode)
+{
+	std::vector<std::string> images;
+	for (const std::string& directory : directories)
+		FindImages(directory, images);
+
+	unsigned int numCooked = 0;
+	size_t totalUncompressed = 0, totalCooked = 0;
+	double totalDecodeMs = 0.0, totalReadMs = 0.0;
+	for (const std::string& image : images)
+	{
+		TextureCookReport report;
+		if (!Cook(image, mode, report))
+			continue;
+
+		char line[512];
+		snprintf(line, sizeof(line), "%-56s %5dx%-5d %s  %8.2f MB -> %7.2f MB (%4.1fx)  decode %7.1f ms -> read %6.1f ms",
+			image.c_str(), report.Width, report.Height, GetFormatName(report.Format),
+			report.UncompressedSize / (1024.0 * 1024.0), report.CookedSize / (1024.0 * 1024.0),
+			(double)report.UncompressedSize / report.CookedSize, report.DecodeMs, report.ReadMs);
+		std::cout << line << std::endl;
+
+		numCooked++;
+		totalUncompressed += report.UncompressedSize;
+		totalCooked += report.CookedSize;
+		totalDecodeMs += report.DecodeMs;
+		totalReadMs += report.ReadMs;
+	}
+
+	if (numCooked > 0)
+	{
+		char line[256];
+		snprintf(line, sizeof(line), "Cooked %u textures: %.2f MB -> %.2f MB of texture memory (%.1fx), load %.1f ms -> %.1f ms",
+			numCooked, totalUncompressed / (1024.0 * 1024.0), totalCooked / (1024.0 * 1024.0),
+			(double)totalUncompressed / totalCooked, totalDecodeMs, totalReadMs);
+		std::cout << line << std::endl;
+	}
+	return numCooked;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "CookedTexture.h"
+
+// Which formats the cooker writes
+enum TextureCookMode {
+	COOK_BC = 0,	// BC1 for opaque images, BC3 with transparency, BC5 for normal maps
+	COOK_BC7,		// BC7 instead of BC1/BC3
+	COOK_RAW		// Uncompressed RGBA8, lossless and still nothing to decode or filter when loading
+};
+
+// What cooking one image achieved, printed by CookDirectories()
+struct TextureCookReport
+{
+	CookedTextureFormat Format;
+	int Width, Height;
+	size_t UncompressedSize;	// RGBA8 with a full mip chain, as uploaded without cooking
+	size_t CookedSize;			// Every level of the payload
+	double DecodeMs;			// Decoding the source image
+	double ReadMs;				// Mapping the cooked file and paging it in
+};
+
+// Offline tool (Application --cook-textures) turning every image under the texture and model directories into a
+// cooked texture (see CookedTexture) next to it, block compressed or raw depending on the TextureCookMode.
+// Images are cooked the way the tests load them by default, flipped vertically, with a Kaiser filtered mip chain
+// (in linear light for colour images).
+class TextureCooker
+{
+public:
+	// Cooks every image found under directories (skybox faces are skipped, cubemaps aren't cooked).
+	// Returns the number of images cooked.
+	static unsigned int CookDirectories(const std::vector<std::string>& directories, TextureCookMode mode);
+	static bool Cook(const std::string& sourcePath, TextureCookMode mode, TextureCookReport& report);
+
+	// Appends the path of every PNG/JPEG/TGA/BMP image under directory, recursively
+	static void FindImages(const std::string& directory, std::vector<std::string>& images);
+};
@@ -0,0 +1,336 @@
+#include "TextureLoader.h"
+
+#include "Renderer.h"
+#include "Texture.h"
+#include "CookedTexture.h"
+#include "vendor/stb_image/stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// Texture unit used while uploading, so the textures bound to the units the tests use are left alone
+static const unsigned int UPLOAD_TEXTURE_UNIT = GL_STATE_CACHE_MAX_TEXTURE_UNITS - 1;
+
+static double GetTimeSeconds()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TextureLoader::TextureLoader()
+	: m_NumDecoding(0),
+	m_Stopping(false),
+	m_NextUploadBuffer(0),
+	m_Enabled(true),
+	m_NumLoaded(0),
+	m_FirstRequestTime(0.0)
+{
+	for (unsigned int i = 0; i < TEXTURE_LOADER_NUM_UPLOAD_BUFFERS; i++)
+		m_UploadBuffers[i] = 0;
+}
+
+TextureLoader* TextureLoader::GetInstance()
+{
+	// Never destroyed, the worker threads are stopped by Shutdown() instead
+	static TextureLoader* instance = new TextureLoader();
+	return instance;
+}
+
+void TextureLoader::Request(Texture* texture, const std::string& filepath, unsigned int internalFormat, bool flipOnLoad, const std::shared_ptr<CookedTexture>& cooked)
+{
+	std::shared_ptr<LoadRequest> request = std::make_shared<LoadRequest>();
+	request->Target = texture;
+	request->InternalFormat = internalFormat;
+	request->Filepath = filepath;
+	request->FlipOnLoad = flipOnLoad;
+	request->Mipmaps = texture->m_Mipmaps;
+	request->IsSRGB = internalFormat == GL_SRGB8;
+	request->Cooked = cooked;
+	request->NumCookedLevels = 0;
+	request->Cancelled = false;
+	request->Pixels = nullptr;
+	request->Width = 0;
+	request->Height = 0;
+	if (cooked)
+	{
+		// Level 0 only if the texture isn't mipmapped
+		request->NumCookedLevels = request->Mipmaps != MIPMAP_NONE ? cooked->GetHeader().NumLevels : 1;
+		request->Width = cooked->GetHeader().Width;
+		request->Height = cooked->GetHeader().Height;
+	}
+
+	if (!m_Enabled)
+	{
+		Decode(*request);
+		Upload(*request);
+		return;
+	}
+
+	// Leave one core for the GL thread (hardware_concurrency() is 0 when unknown)
+	if (m_Workers.empty())
+	{
+		unsigned int numCores = std::thread::hardware_concurrency();
+		unsigned int numWorkers = numCores > 1 ? numCores - 1 : 1;
+		for (unsigned int i = 0; i < numWorkers; i++)
+			m_Workers.push_back(std::thread(&TextureLoader::WorkerMain, this));
+	}
+
+	if (m_Outstanding.empty())
+		m_FirstRequestTime = GetTimeSeconds();
+	m_Outstanding.push_back(request);
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Pending.push_back(request);
+	}
+	m_WorkAvailable.notify_one();
+}
+
+void TextureLoader::Cancel(Texture* texture)
+{
+	// The worker may still be decoding it, the result is simply dropped when it arrives
+	for (unsigned int i = 0; i < m_Outstanding.size(); i++)
+	{
+		if (m_Outstanding[i]->Target == texture)
+		{
+			m_Outstanding[i]->Target = nullptr;
+			m_Outstanding[i]->Cancelled = true;
+			m_Outstanding.erase(m_Outstanding.begin() + i);
+			return;
+		}
+	}
+}
+
+// Both drain the decoded requests even with none outstanding, since cancelled requests the workers had already
+// picked up still hold their images until UploadDecoded() frees them
+void TextureLoader::Update()
+{
+	UploadDecoded(TEXTURE_LOADER_UPLOAD_BUDGET);
+}
+
+void TextureLoader::Finish()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_WorkDone.wait(lock, [this] { return m_Pending.empty() && m_NumDecoding == 0; });
+	}
+	UploadDecoded((size_t)-1);
+}
+
+void TextureLoader::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_WorkAvailable.notify_all();
+	for (std::thread& worker : m_Workers)
+		worker.join();
+	m_Workers.clear();
+}
+
+void TextureLoader::WorkerMain()
+{
+	while (true)
+	{
+		std::shared_ptr<LoadRequest> request;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkAvailable.wait(lock, [this] { return m_Stopping || !m_Pending.empty(); });
+			if (m_Stopping)
+				return;
+			request = m_Pending.front();
+			m_Pending.pop_front();
+			m_NumDecoding++;
+		}
+
+		if (!request->Cancelled)
+			Decode(*request);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_NumDecoding--;
+			m_Decoded.push_back(request);
+		}
+		m_WorkDone.notify_all();
+	}
+}
+
+void TextureLoader::Decode(LoadRequest& request)
+{
+	// Nothing to decode, just get the file off the disk before the GL thread reads it
+	if (request.Cooked)
+	{
+		request.Cooked->Prefetch(request.NumCookedLevels);
+		return;
+	}
+
+	// The flip flag is per thread, as every decoding thread may want a different one
+	stbi_set_flip_vertically_on_load_thread(request.FlipOnLoad);
+	int bytesPerPixel = 0;
+	request.Pixels = stbi_load(request.Filepath.c_str(), &request.Width, &request.Height, &bytesPerPixel, 4);
+	if (request.Pixels)
+		MipmapGenerator::Generate(request.Pixels, request.Width, request.Height, request.IsSRGB, request.Mipmaps, request.MipChain, request.MipLevels);
+}
+
+size_t TextureLoader::GetUploadSize(const LoadRequest& request)
+{
+	// Cancelled, it is only freed
+	if (request.Target == nullptr)
+		return 0;
+	if (request.Cooked)
+	{
+		size_t size = 0;
+		for (unsigned int i = 0; i < request.NumCookedLevels; i++)
+			size += request.Cooked->GetLevelSize(i);
+		return size;
+	}
+	if (request.Pixels == nullptr)
+		return 0;
+	return (size_t)request.Width * request.Height * 4 + request.MipChain.size();
+}
+
+void TextureLoader::Upload(LoadRequest& request)
+{
+	if (request.Target == nullptr)
+	{
+		// Texture was deleted while loading
+		stbi_image_free(request.Pixels);
+		request.Cooked.reset();
+		return;
+	}
+	if (request.Pixels == nullptr && !request.Cooked)
+	{
+		std::cout << "[ERROR] Texture failed to load at path: " << request.Filepath << std::endl;
+		return;
+	}
+
+	Texture& texture = *request.Target;
+	if (texture.m_HasStorage && (request.Width != texture.m_StorageWidth || request.Height != texture.m_StorageHeight))
+	{
+		// Storage was allocated from the header read in the constructor, the file must have changed since
+		std::cout << "[ERROR] Texture size changed while loading: " << request.Filepath << std::endl;
+		stbi_image_free(request.Pixels);
+		request.Pixels = nullptr;
+		return;
+	}
+
+	unsigned int previousUnit = GLStateCache::GetActiveTexture();
+	GLStateCache::BindTextureUnit(UPLOAD_TEXTURE_UNIT, GL_TEXTURE_2D, texture.GetID());
+	if (request.Cooked)
+	{
+		// The mapping is already in memory (the worker paged it in), so it is the upload's source as it is
+		texture.UploadCooked(*request.Cooked, request.NumCookedLevels);
+		if (!texture.m_HasStorage)
+			texture.m_NumLevels = request.NumCookedLevels;
+	}
+	else
+	{
+		UploadPixels(request);
+		if (!texture.m_HasStorage)
+			texture.m_NumLevels = texture.m_Mipmaps != MIPMAP_NONE ? MipmapGenerator::GetNumLevels(request.Width, request.Height) : 1;
+		if (texture.m_Mipmaps == MIPMAP_GPU)
+		{
+			GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+		}
+	}
+	// Every level is filled in now, so stop sampling only the placeholder
+	if (texture.m_HasStorage)
+	{
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0));
+	}
+	GLStateCache::ActiveTexture(previousUnit);
+
+	texture.m_Width = request.Width;
+	texture.m_Height = request.Height;
+	texture.m_BytesPerPixel = 4;
+	texture.m_IsResident = true;
+	stbi_image_free(request.Pixels);
+	request.Pixels = nullptr;
+	std::vector<unsigned char>().swap(request.MipChain);
+	request.Cooked.reset();
+	m_NumLoaded++;
+}
+
+void TextureLoader::UploadPixels(LoadRequest& request)
+{
+	Texture& texture = *request.Target;
+	size_t baseSize = (size_t)request.Width * request.Height * 4;
+	size_t size = GetUploadSize(request);
+	if (m_UploadBuffers[0] == 0)
+	{
+		GLCall(glGenBuffers(TEXTURE_LOADER_NUM_UPLOAD_BUFFERS, m_UploadBuffers));
+	}
+	unsigned int uploadBuffer = m_UploadBuffers[m_NextUploadBuffer];
+	m_NextUploadBuffer = (m_NextUploadBuffer + 1) % TEXTURE_LOADER_NUM_UPLOAD_BUFFERS;
+
+	// Orphan the buffer's previous storage, so writing never waits for an earlier upload still reading from it
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer));
+	GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW));
+	GLCall(void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	// Offsets into the bound unpack buffer, the mip chain follows level 0
+	const unsigned char* pixelData = nullptr;
+	const unsigned char* mipChainData = reinterpret_cast<const unsigned char*>(baseSize);
+	if (mapped)
+	{
+		memcpy(mapped, request.Pixels, baseSize);
+		if (!request.MipChain.empty())
+			memcpy((unsigned char*)mapped + baseSize, request.MipChain.data(), request.MipChain.size());
+		GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+	}
+	else
+	{
+		// Fall back to a plain upload from client memory
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+		pixelData = request.Pixels;
+		mipChainData = request.MipChain.data();
+	}
+
+	// Sourcing from the buffer lets the upload return straight away, the driver copies to the texture later
+	texture.UploadLevel(0, request.Width, request.Height, pixelData, baseSize);
+	for (unsigned int i = 0; i < request.MipLevels.size(); i++)
+	{
+		const MipLevel& level = request.MipLevels[i];
+		texture.UploadLevel(i + 1, level.Width, level.Height, mipChainData + level.Offset, (size_t)level.Width * level.Height * 4);
+	}
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+}
+
+void TextureLoader::UploadDecoded(size_t budget)
+{
+	std::vector<std::shared_ptr<LoadRequest>> decoded;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		decoded.swap(m_Decoded);
+	}
+
+	size_t uploadedBytes = 0;
+	unsigned int numUploaded = 0, numCompleted = 0;
+	for (; numUploaded < decoded.size(); numUploaded++)
+	{
+		LoadRequest& request = *decoded[numUploaded];
+		size_t size = GetUploadSize(request);
+		if (uploadedBytes > 0 && uploadedBytes + size > budget)
+			break;
+		if (request.Target != nullptr)
+			numCompleted++;
+		Upload(request);
+		uploadedBytes += size;
+		auto it = std::find(m_Outstanding.begin(), m_Outstanding.end(), decoded[numUploaded]);
+		if (it != m_Outstanding.end())
+			m_Outstanding.erase(it);
+	}
+
+	// Anything over the budget goes first next frame
+	if (numUploaded < decoded.size())
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Decoded.insert(m_Decoded.begin(), decoded.begin() + numUploaded, decoded.end());
+	}
+
+	if (numCompleted > 0 && m_Outstanding.empty())
+	{
+		double loadMs = (GetTimeSeconds() - m_FirstRequestTime) * 1000.0;
+		std::cout << "Texture loader: " << m_NumLoaded << " textures resident, last batch took " << loadMs << " ms" << std::endl;
+	}
+}
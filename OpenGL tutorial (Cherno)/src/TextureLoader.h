@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MipmapGenerator.h"
+
+class Texture;
+class CookedTexture;
+
+// Most bytes of decoded images uploaded per call to Update(), so a burst of loads is spread over a few frames.
+// At least one image is always uploaded, so images larger than the budget still get through.
+#define TEXTURE_LOADER_UPLOAD_BUDGET (16 * 1024 * 1024)
+// Pixel unpack buffers used in turn for uploads
+#define TEXTURE_LOADER_NUM_UPLOAD_BUFFERS 4
+
+// Loads 2D textures in the background. Texture's constructor only creates the GL texture (showing a 1x1
+// placeholder) and queues the file here. Worker threads decode the images in parallel, and Update() uploads
+// the finished ones on the GL thread through pixel buffer objects, which lets the driver do the copy to the
+// GPU asynchronously. The texture keeps its GL name throughout, so anything bound or set up while it was still
+// the placeholder picks up the real image by itself.
+// Loading many textures therefore takes about as long as the largest one instead of the sum of all of them.
+// Mip chains filtered on the CPU (MIPMAP_BOX, MIPMAP_KAISER) are built by the workers too, and uploaded along with level 0.
+// Cooked textures (see CookedTexture) skip both: the workers only page in the mapped file, and its levels are
+// uploaded straight from the mapping.
+class TextureLoader
+{
+private:
+	struct LoadRequest
+	{
+		// Set by the GL thread only
+		Texture* Target;
+		unsigned int InternalFormat;
+		// Read by the worker
+		std::string Filepath;
+		bool FlipOnLoad;
+		MipmapFilter Mipmaps;
+		bool IsSRGB;
+		std::shared_ptr<CookedTexture> Cooked;	// Replaces the image if set
+		unsigned int NumCookedLevels;
+		std::atomic<bool> Cancelled;
+		// Written by the worker
+		unsigned char* Pixels;
+		int Width, Height;
+		std::vector<unsigned char> MipChain;	// Levels 1 and up, only for mip chains built on the CPU
+		std::vector<MipLevel> MipLevels;
+	};
+
+	std::vector<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+	std::condition_variable m_WorkDone;
+	std::deque<std::shared_ptr<LoadRequest>> m_Pending;		// Waiting for a worker
+	std::vector<std::shared_ptr<LoadRequest>> m_Decoded;	// Waiting for Update()
+	unsigned int m_NumDecoding;
+	bool m_Stopping;
+
+	// GL thread only
+	std::vector<std::shared_ptr<LoadRequest>> m_Outstanding;
+	unsigned int m_UploadBuffers[TEXTURE_LOADER_NUM_UPLOAD_BUFFERS];
+	unsigned int m_NextUploadBuffer;
+	bool m_Enabled;
+	unsigned int m_NumLoaded;
+	double m_FirstRequestTime;
+
+	TextureLoader();
+
+public:
+	static TextureLoader* GetInstance();
+
+	// Called by Texture
+	void Request(Texture* texture, const std::string& filepath, unsigned int internalFormat, bool flipOnLoad, const std::shared_ptr<CookedTexture>& cooked);
+	void Cancel(Texture* texture);
+
+	// Uploads decoded images within the per-frame budget, called once per frame from the main loop
+	void Update();
+	// Waits for every queued texture and uploads all of them (e.g. before benchmarking a test)
+	void Finish();
+	// Stops the worker threads, called once before exiting
+	void Shutdown();
+
+	// When disabled, textures are decoded and uploaded inside their constructor
+	inline void SetEnabled(bool enabled) { m_Enabled = enabled; }
+	inline bool IsEnabled() const { return m_Enabled; }
+	inline unsigned int GetNumOutstanding() const { return m_Outstanding.size(); }
+
+private:
+	void WorkerMain();
+	static void Decode(LoadRequest& request);
+	static size_t GetUploadSize(const LoadRequest& request);
+	void Upload(LoadRequest& request);
+	// Copies decoded pixels into an unpack buffer and uploads them from there, with the texture bound
+	void UploadPixels(LoadRequest& request);
+	// Hands the decoded requests over to the GL thread, uploading at most budget bytes
+	void UploadDecoded(size_t budget);
+};
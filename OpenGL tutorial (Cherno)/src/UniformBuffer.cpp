@@ -0,0 +1,32 @@
+#include "UniformBuffer.h"
+
+#include "Renderer.h"
+
+UniformBuffer::UniformBuffer(unsigned int size, unsigned int bindingPoint)
+    : m_Size(size), m_BindingPoint(bindingPoint)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+    GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, m_RendererID));
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    ASSERT(offset + size <= m_Size);
+    GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+    if (offset == 0 && size == m_Size)
+    {
+        // Whole buffer update: orphan the old storage so we don't wait on draws still reading last frame's data
+        GLCall(glBufferData(GL_UNIFORM_BUFFER, size, data, GL_DYNAMIC_DRAW));
+    }
+    else
+    {
+        GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+    }
+}
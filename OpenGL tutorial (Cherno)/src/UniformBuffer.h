@@ -0,0 +1,20 @@
+#pragma once
+
+// A GL_UNIFORM_BUFFER permanently attached to one uniform block binding point.
+// Programs are pointed at the same binding point (see Shader::ReflectUniformBlocks), so a single upload is seen by all of them.
+class UniformBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+	unsigned int m_BindingPoint;
+public:
+	UniformBuffer(unsigned int size, unsigned int bindingPoint);
+	~UniformBuffer();
+
+	// Replaces size bytes starting at offset, the data must already follow the std140 layout of the block
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetBindingPoint() const { return m_BindingPoint; }
+};
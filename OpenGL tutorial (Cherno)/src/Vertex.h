@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Vertex as imported, 56 bytes
+struct Vertex {
+	glm::vec3 Position;
+	glm::vec3 Normal;
+	glm::vec2 TexCoords;
+	glm::vec3 Tangent;
+	glm::vec3 Bitangent;
+};
+
+// 20 byte encoding of a Vertex, written by VertexCompressor and decoded by shaders built with COMPACT_VERTEX
+// (res/shaders/include/Vertex.glsl). Members are in attribute location order.
+struct CompactVertex {
+	unsigned short Position[4];		// Unsigned normalized within the mesh's bounding cube (w unused), see VertexCompressor::GetDequantize()
+	short Normal[2];				// Octahedral, signed normalized
+	unsigned short TexCoords[2];	// Half floats
+	unsigned int Tangent;			// GL_INT_2_10_10_10_REV: the tangent in xyz, the bitangent's handedness in the sign of w
+};
+
+// Layout of a mesh's vertex buffer
+enum MeshVertexFormat {
+	MESH_VERTEX_FULL = 0,	// Vertex, every attribute as a float
+	MESH_VERTEX_COMPACT		// CompactVertex, needs the COMPACT_VERTEX variant of the shader
+};
@@ -13,7 +13,11 @@ public:
 	~VertexArray();
 
 	void AddBuffer(const VertexBuffer& VB, const VertexBufferLayout& layout);
+	// Points attributes 0 to n - 1 of the bound vertex array at the bound GL_ARRAY_BUFFER, following layout
+	static void SetAttributes(const VertexBufferLayout& layout);
 
 	void Bind() const;
 	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
@@ -18,10 +18,21 @@ struct VertexBufferElement
 			case GL_FLOAT:			return 4;
 			case GL_UNSIGNED_INT:	return 4;
 			case GL_UNSIGNED_BYTE:	return 1;
+			case GL_SHORT:			return 2;
+			case GL_UNSIGNED_SHORT:	return 2;
+			case GL_HALF_FLOAT:		return 2;
 		}
 		ASSERT(false);
 		return 0;
 	}
+
+	// Bytes taken by the whole attribute (packed types hold all four components in one 32 bit integer)
+	unsigned int GetSize() const
+	{
+		if (type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV)
+			return 4;
+		return count * GetSizeOfType(type);
+	}
 };
 
 class VertexBufferLayout 
@@ -63,6 +74,15 @@ public:
 		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
 	}
+
+	// Any attribute type, for the ones without a C++ type to Push<T>() with: GL_HALF_FLOAT, and the packed
+	// GL_INT_2_10_10_10_REV (count 4). Normalized integers are read as floats in [0,1], or [-1,1] if signed.
+	void PushAttribute(unsigned int type, unsigned int count, bool normalized)
+	{
+		VertexBufferElement element = { type, count, (unsigned char)(normalized ? GL_TRUE : GL_FALSE) };
+		m_Elements.push_back(element);
+		m_Stride += element.GetSize();
+	}
 	
 	inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements;  }
 	inline unsigned int GetStride() const { return m_Stride; }
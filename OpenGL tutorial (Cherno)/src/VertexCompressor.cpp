@@ -0,0 +1,96 @@
+#include "VertexCompressor.h"
+
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Projects the unit sphere onto an octahedron and unfolds it into the [-1,1] square
+static glm::vec2 EncodeOctahedral(const glm::vec3& normal)
+{
+	float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if (length == 0.0f)
+		return glm::vec2(0.0f);
+	glm::vec3 n = normal / length;
+	glm::vec2 encoded(n.x, n.y);
+	// The lower half folds over the diagonals
+	if (n.z < 0.0f)
+	{
+		encoded.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		encoded.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return encoded;
+}
+
+static glm::vec3 DecodeOctahedral(const glm::vec2& encoded)
+{
+	glm::vec3 n(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+	float fold = std::max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -fold : fold;
+	n.y += n.y >= 0.0f ? -fold : fold;
+	return glm::normalize(n);
+}
+
+glm::vec4 VertexCompressor::GetDequantize(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	glm::vec3 extent = boundsMax - boundsMin;
+	float scale = std::max(std::max(extent.x, extent.y), extent.z);
+	return glm::vec4(boundsMin, scale > 0.0f ? scale : 1.0f);
+}
+
+CompactVertex VertexCompressor::Compress(const Vertex& vertex, const glm::vec4& dequantize)
+{
+	CompactVertex compact;
+	glm::vec3 position = (vertex.Position - glm::vec3(dequantize)) / dequantize.w;
+	glm::u64 packedPosition = glm::packUnorm4x16(glm::vec4(position, 0.0f));
+	memcpy(compact.Position, &packedPosition, sizeof(compact.Position));
+
+	glm::uint packedNormal = glm::packSnorm2x16(EncodeOctahedral(vertex.Normal));
+	memcpy(compact.Normal, &packedNormal, sizeof(compact.Normal));
+
+	compact.TexCoords[0] = glm::packHalf1x16(vertex.TexCoords.x);
+	compact.TexCoords[1] = glm::packHalf1x16(vertex.TexCoords.y);
+
+	// Handedness of the tangent frame, so the bitangent can be rebuilt as cross(normal, tangent) * handedness
+	float tangentLength = glm::length(vertex.Tangent);
+	glm::vec3 tangent = tangentLength > 0.0f ? vertex.Tangent / tangentLength : glm::vec3(0.0f);
+	float handedness = glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < 0.0f ? -1.0f : 1.0f;
+	compact.Tangent = glm::packSnorm3x10_1x2(glm::vec4(tangent, handedness));
+	return compact;
+}
+
+void VertexCompressor::Compress(const Vertex* vertices, size_t count, const glm::vec4& dequantize, std::vector<CompactVertex>& compact)
+{
+	compact.resize(count);
+	for (size_t i = 0; i < count; i++)
+		compact[i] = Compress(vertices[i], dequantize);
+}
+
+Vertex VertexCompressor::Decompress(const CompactVertex& compact, const glm::vec4& dequantize)
+{
+	Vertex vertex;
+	glm::u64 packedPosition;
+	memcpy(&packedPosition, compact.Position, sizeof(compact.Position));
+	vertex.Position = glm::vec3(dequantize) + glm::vec3(glm::unpackUnorm4x16(packedPosition)) * dequantize.w;
+
+	glm::uint packedNormal;
+	memcpy(&packedNormal, compact.Normal, sizeof(compact.Normal));
+	vertex.Normal = DecodeOctahedral(glm::unpackSnorm2x16(packedNormal));
+
+	vertex.TexCoords = glm::vec2(glm::unpackHalf1x16(compact.TexCoords[0]), glm::unpackHalf1x16(compact.TexCoords[1]));
+
+	glm::vec4 tangent = glm::unpackSnorm3x10_1x2(compact.Tangent);
+	vertex.Tangent = glm::vec3(tangent);
+	vertex.Bitangent = glm::cross(vertex.Normal, vertex.Tangent) * (tangent.w < 0.0f ? -1.0f : 1.0f);
+	return vertex;
+}
+
+VertexBufferLayout VertexCompressor::GetLayout()
+{
+	VertexBufferLayout layout;
+	layout.PushAttribute(GL_UNSIGNED_SHORT, 4, true);		// Position
+	layout.PushAttribute(GL_SHORT, 2, true);				// Normal
+	layout.PushAttribute(GL_HALF_FLOAT, 2, false);			// Texture coordinates
+	layout.PushAttribute(GL_INT_2_10_10_10_REV, 4, true);	// Tangent and handedness
+	return layout;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+#include "Vertex.h"
+#include "VertexBufferLayout.h"
+
+// Quantizes vertices into CompactVertex for MESH_VERTEX_COMPACT meshes (a bit under 3x smaller than Vertex):
+// - positions as 16 bit unsigned normalized integers in a cube around the mesh. The cube is used rather than the
+//   bounding box so the dequantization is a uniform scale, which leaves normals that are transformed by the model
+//   matrix pointing the right way.
+// - normals octahedral encoded into two 16 bit signed normalized integers
+// - tangents as 10 bit signed normalized integers, the bitangent is rebuilt from the normal, tangent and handedness
+// - texture coordinates as half floats (exact to 1/2048 within [0,1], so heavily tiled UVs lose precision)
+class VertexCompressor
+{
+public:
+	// Offset (xyz) and scale (w) taking a quantized position back to model space: offset + quantized * scale.
+	// Set to the u_MeshDequantize uniform when drawing the mesh.
+	static glm::vec4 GetDequantize(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+	static void Compress(const Vertex* vertices, size_t count, const glm::vec4& dequantize, std::vector<CompactVertex>& compact);
+	static CompactVertex Compress(const Vertex& vertex, const glm::vec4& dequantize);
+	// Inverse of Compress(), to measure the error it introduces
+	static Vertex Decompress(const CompactVertex& compact, const glm::vec4& dequantize);
+
+	// Attribute layout of CompactVertex, locations 0 to 3 like Vertex (which also has the bitangent at 4)
+	static VertexBufferLayout GetLayout();
+};
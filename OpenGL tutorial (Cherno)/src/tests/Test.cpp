@@ -41,7 +41,7 @@ namespace test
 		glfwSetMouseButtonCallback(m_MainWindow, nullptr);
 
 		// Diable face culling
-		GLCall(glDisable(GL_CULL_FACE));
+		GLStateCache::Disable(GL_CULL_FACE);
 
 		// Disable gl_PointSize in vertex shaders
 		GLCall(glDisable(GL_PROGRAM_POINT_SIZE));
@@ -42,6 +42,7 @@ namespace test
 
 		static TestMenu* GetInstance() { return instance; }
 		void SetScreenDimensions(unsigned int width, unsigned int height);
+		const std::vector<std::pair<std::string, test::Test*>>& GetTests() const { return m_Tests; }
 
 		template<typename T>
 		void RegisterTestLambda(const std::string& testName, GLFWwindow* window)
@@ -22,7 +22,7 @@ namespace test
 		m_Camera(Camera(m_CameraPos, 75.0f, glm::vec3(0.0f, 1.0f, 0.0f), 90.0f)),
 		m_CubeShader(new Shader("res/shaders/EnvMapping.shader")),
 		m_SkyboxShader(new Shader("res/shaders/Skybox.shader")),
-		m_CubeTexture(new Texture("res/textures/metal_scratched_texture.png")),
+		m_CubeTexture(TextureCache::Get("res/textures/metal_scratched_texture.png")),
 		m_VA_Cube(new VertexArray()),
 		m_VA_Skybox(new VertexArray())
 	{
@@ -200,7 +200,7 @@ namespace test
 		renderer.DrawTriangles(*m_VA_Cube, *m_IB_Cube, *m_CubeShader);
 
 		// Then render the skybox with depth testing at LEQUAL (and set z component to be (w / w) = 1.0 = max depth in vertex shader)
-		glDepthFunc(GL_LEQUAL);
+		GLStateCache::DepthFunc(GL_LEQUAL);
 		m_SkyboxShader->Bind();
 		// Model, View, Projection matrices
 		modelMatrix = glm::mat4(1.0f);
@@ -210,7 +210,7 @@ namespace test
 		m_SkyboxShader->SetMatrix4f("viewMatrix",  viewMatrix);
 		m_SkyboxShader->SetMatrix4f("projMatrix",  projMatrix);
 		renderer.DrawTriangles(*m_VA_Skybox, *m_IB_Skybox, *m_SkyboxShader);
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 
 	}
 
@@ -240,8 +240,7 @@ namespace test
 		m_SkyboxShader->SetInt("u_SkyboxTexture", 3);
 
 		// Textures
-		delete m_SkyboxTexture;
-		m_SkyboxTexture = new Texture(std::vector<std::string>({ "res/textures/example_skybox/right.jpg",
+		m_SkyboxTexture = TextureCache::GetCubemap(std::vector<std::string>({ "res/textures/example_skybox/right.jpg",
 																"res/textures/example_skybox/left.jpg",
 																"res/textures/example_skybox/top.jpg",
 																"res/textures/example_skybox/bottom.jpg", 
@@ -251,13 +250,13 @@ namespace test
 		m_SkyboxTexture->BindCubemap(3);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		//GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-		GLCall(glBlendFunc(GL_ONE, GL_ZERO));
+		GLStateCache::Enable(GL_BLEND);
+		//GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLStateCache::BlendFunc(GL_ONE, GL_ZERO);
 		
 		// Reset all callbacks
 		// Callback function for mouse cursor movement
@@ -9,6 +9,7 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
 
 namespace test
@@ -22,8 +23,8 @@ namespace test
 		Camera m_Camera;
 		Shader* m_CubeShader;
 		Shader* m_SkyboxShader;
-		Texture* m_CubeTexture;
-		Texture* m_SkyboxTexture;
+		std::shared_ptr<Texture> m_CubeTexture;
+		std::shared_ptr<Texture> m_SkyboxTexture;
 		VertexArray*  m_VA_Cube;
 		VertexBuffer* m_VB_Cube;
 		IndexBuffer*  m_IB_Cube;
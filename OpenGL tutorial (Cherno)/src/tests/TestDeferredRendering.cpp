@@ -18,19 +18,27 @@ namespace test
 	// Init static variable
 	TestDeferredRendering* TestDeferredRendering::instance;
 
+	// Keyword bits of m_GBufferShaderVariants
+	static const unsigned int GBUFFER_VARIANT_TEXTURE_ARRAY = 1 << 0;
+	static const unsigned int GBUFFER_VARIANT_COMPACT_VERTEX = 1 << 1;
+
 	TestDeferredRendering::TestDeferredRendering(GLFWwindow*& mainWindow)
 		: m_MainWindow(mainWindow),
 		modelLoaded(false),
 		m_Model(nullptr),
-		m_GBufferShader(new Shader("res/shaders/GBuffer.shader")),
+		m_CompactModel(nullptr),
+		m_UseCompactVertices(false),
+		m_GBufferShaderVariants(new ShaderVariants("res/shaders/GBuffer.shader", { "TEXTURE_ARRAY", "COMPACT_VERTEX" })),
+		m_GBufferShader(m_GBufferShaderVariants->Get(0)),
+		m_UseTextureArray(true),
 		m_QuadShader(new Shader("res/shaders/DeferredRenderingQuad.shader")),
-		m_GroundTexture(new Texture("res/textures/wooden_floor_texture.png")),
-		m_SecondaryTexture(new Texture("res/textures/metal_scratched_texture.png")),
+		m_GroundTexture(TextureCache::Get("res/textures/wooden_floor_texture.png")),
+		m_SecondaryTexture(TextureCache::Get("res/textures/metal_scratched_texture.png")),
 		m_CameraPos(glm::vec3(12.0f, 8.0f, 26.0f)),
 		m_CameraFront(glm::vec3(0.0f, 0.0f, -1.0f)),
 		m_CameraUp(glm::vec3(0.0f, 1.0f, 0.0f)),
 		m_Camera(Camera(m_CameraPos, 60.0f)),
-		NUM_LIGHTS(200), // need to set the same in shader as well
+		NUM_LIGHTS(200), // at most MAX_POINT_LIGHTS
 		m_NumModelColumns(12),
 		m_NumModelRows(12),
 		m_SpacingAmount(10.0f),
@@ -41,6 +49,10 @@ namespace test
 		m_AlbedoSpecGBuffer(-1)
 	{
 		instance = this;
+		// Compile the model's variants up front rather than when the checkboxes are first toggled
+		m_GBufferShaderVariants->Get(GBUFFER_VARIANT_TEXTURE_ARRAY);
+		m_GBufferShaderVariants->Get(GBUFFER_VARIANT_COMPACT_VERTEX);
+		m_GBufferShaderVariants->Get(GBUFFER_VARIANT_TEXTURE_ARRAY | GBUFFER_VARIANT_COMPACT_VERTEX);
 
 		// Callback function for mouse cursor movement
 		glfwSetCursorPosCallback(m_MainWindow, mouse_callbackDeferredRendering);
@@ -131,6 +143,14 @@ namespace test
 
 		// Bind shader and set any 'per frame' uniforms
 		m_GBufferShader->Bind();
+		Model* model = m_UseCompactVertices ? m_CompactModel : m_Model;
+		model->SetTextureArrayEnabled(m_UseTextureArray);
+		unsigned int modelVariant = 0;
+		if (model->IsTextureArrayEnabled())
+			modelVariant |= GBUFFER_VARIANT_TEXTURE_ARRAY;
+		if (m_UseCompactVertices)
+			modelVariant |= GBUFFER_VARIANT_COMPACT_VERTEX;
+		Shader* modelShader = m_GBufferShaderVariants->Get(modelVariant);
 		//
 		// Create model, view, projection matrices 
 		// Send combined MVP matrix to shader
@@ -138,20 +158,21 @@ namespace test
 		modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0));
 		glm::mat4 viewMatrix = m_Camera.GetViewMatrix();
 		glm::mat4 projMatrix = glm::perspective(glm::radians(m_Camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 200.0f);
-		m_GBufferShader->SetMatrix4f("model", modelMatrix);
-		m_GBufferShader->SetMatrix4f("view", viewMatrix);
-		m_GBufferShader->SetMatrix4f("proj", projMatrix);
-		// Bind ground diffuse texture
+		// Upload the camera and lights once for every program that uses them
+		FrameUniforms* frameUniforms = FrameUniforms::GetInstance();
+		frameUniforms->SetCamera(viewMatrix, projMatrix, m_Camera.Position);
+		frameUniforms->SetPointLights(m_PointLights.data(), m_PointLights.size());
+		// Set the wrap mode of the ground and model textures (the binds themselves happen when the queue is flushed)
 		m_GroundTexture->BindAndSetRepeating(0);
-		m_GBufferShader->SetUniform1i("texture_diffuse0", 0);
-		// Bind ground specular texture
-		m_GroundTexture->BindAndSetRepeating(1); // hack for now -- just using the same texture here
-		m_GBufferShader->SetUniform1i("texture_specular0", 1);
-		// Render the ground
-		renderer.DrawTriangles(*m_VA_Ground, *m_IB_Ground, *m_GBufferShader);
-		// Load model's uniforms and render the loaded backpack models
-		m_SecondaryTexture->BindAndSetRepeating(0); // model's diffuse if not loaded by .obj file
-		m_SecondaryTexture->BindAndSetRepeating(1); // model's spec texture if not loaded by .obj file
+		m_SecondaryTexture->BindAndSetRepeating(1);
+		// Queue the ground, using the ground texture for both diffuse and specular (hack for now)
+		DrawCommand groundCommand;
+		groundCommand.Pass = PASS_GEOMETRY;
+		groundCommand.ModelMatrix = modelMatrix;
+		groundCommand.AddTexture(0, GL_TEXTURE_2D, m_GroundTexture->GetID(), "texture_diffuse0");
+		groundCommand.AddTexture(1, GL_TEXTURE_2D, m_GroundTexture->GetID(), "texture_specular0");
+		renderer.Submit(*m_VA_Ground, *m_IB_Ground, *m_GBufferShader, groundCommand);
+		// Queue the grid of models, the secondary texture is used if the .obj file doesn't provide one
 		for(int i = 0; i < m_NumModelColumns; i++)
 		{
 			for (int j = 0; j < m_NumModelRows; j++)
@@ -162,10 +183,12 @@ namespace test
 					glm::radians((float)(70*i - 40*(j*j))),  // Rotate somewhat randomly 
 					glm::vec3(0.0f, 1.0f, 0.0f));
 				modelMatrix = glm::scale(modelMatrix, glm::vec3(46.0f));
-				m_GBufferShader->SetMatrix4f("model", modelMatrix);
-				m_Model->Draw(m_GBufferShader);
+				float depth = glm::length(glm::vec3(modelMatrix[3]) - m_Camera.Position);
+				model->Submit(renderer, modelShader, modelMatrix, PASS_GEOMETRY, depth, m_SecondaryTexture->GetID());
 			}
 		}
+		// Sort by program, material and depth, then draw everything into the GBuffer
+		renderer.Flush();
 
 
 		// Now the GBuffer has been filled with all necessary information for lighting 
@@ -182,27 +205,16 @@ namespace test
 
 		// Next take its four buffers (world position, normal, albedo, specular) and run a single lighting fragment shader for all lights in the scene
 		m_QuadShader->Bind();
-		m_QuadShader->SetVec3("viewPos", m_Camera.Position);
 		// Bind all three GBuffer attachments to the sampler2D uniforms
-		GLCall(glActiveTexture(GL_TEXTURE0));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_PositionGBuffer));
+		GLStateCache::ActiveTexture(GL_TEXTURE0);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_PositionGBuffer);
 		m_QuadShader->SetInt("gPosition", 0);
-		GLCall(glActiveTexture(GL_TEXTURE1));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_NormalGBuffer));
+		GLStateCache::ActiveTexture(GL_TEXTURE1);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_NormalGBuffer);
 		m_QuadShader->SetInt("gNormal", 1);
-		GLCall(glActiveTexture(GL_TEXTURE2));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_AlbedoSpecGBuffer));
+		GLStateCache::ActiveTexture(GL_TEXTURE2);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_AlbedoSpecGBuffer);
 		m_QuadShader->SetInt("gAlbedoSpec", 2);
-		// Set properties for all pointlights
-		const float linearAttenuation = 0.5;
-		const float quadraticAttenuation = 0.4;
-		for (unsigned int i = 0; i < m_LightPositions.size(); i++)
-		{
-			m_QuadShader->SetVec3("pointLights[" + std::to_string(i) + "].Position", m_LightPositions[i]);
-			m_QuadShader->SetVec3("pointLights[" + std::to_string(i) + "].Colour", m_LightColours[i]);
-			m_QuadShader->SetFloat("pointLights[" + std::to_string(i) + "].Linear", linearAttenuation);
-			m_QuadShader->SetFloat("pointLights[" + std::to_string(i) + "].Quadratic", quadraticAttenuation);
-		}
 		// Draw the completed lighting effects textured quad to the default framebuffer
 		renderer.DrawTriangles(*m_VA_Quad, *m_IB_Quad, *m_QuadShader);
 	}
@@ -217,6 +229,21 @@ namespace test
 		ImGui::Text("- Use WASD keys to move camera");
 		ImGui::Text("- Use scroll wheel to change FOV");
 		ImGui::Text("- Avg %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+		const DrawQueueStats& drawStats = Renderer::GetLastFlushStats();
+		ImGui::Text("- %u queued draws, %u program and %u material changes", drawStats.Commands, drawStats.ProgramChanges, drawStats.MaterialChanges);
+		const TextureArray* textureArray = m_Model != nullptr ? m_Model->GetTextureArray() : nullptr;
+		if (textureArray != nullptr)
+		{
+			// One bind for every mesh of every model instead of one per mesh texture
+			ImGui::Checkbox("Model textures in a texture array", &m_UseTextureArray);
+			ImGui::Text("- %u layers of %ix%i", textureArray->GetNumLayers(), textureArray->GetWidth(), textureArray->GetHeight());
+		}
+		else
+		{
+			ImGui::Text("- Model textures differ in size, no texture array");
+		}
+		// 20 instead of 56 bytes per vertex, positions quantized to the model's bounds
+		ImGui::Checkbox("Compact model vertices", &m_UseCompactVertices);
 	}
 
 	void TestDeferredRendering::OnActivated()
@@ -229,46 +256,55 @@ namespace test
 			stbi_set_flip_vertically_on_load(true);
 			//m_Model = new Model((char*)"res/models/backpack/backpack.obj");
 			//m_Model = new Model((char*)"res/models/donut tutorial/donut_icing.obj");
-			m_Model = new Model((char*)"res/models/donut tutorial/coffee_cup.obj");
+			m_Model = new Model((char*)"res/models/donut tutorial/coffee_cup.obj", false); // Only drawn, so the meshes drop their CPU geometry
+			// Meshes without a diffuse map use the secondary texture, same as the per-mesh path
+			m_Model->UseTextureArray("res/textures/metal_scratched_texture.png");
+			m_CompactModel = new Model((char*)"res/models/donut tutorial/coffee_cup.obj", false, MESH_VERTEX_COMPACT);
+			m_CompactModel->UseTextureArray("res/textures/metal_scratched_texture.png");
 			modelLoaded = true;
 		}
 
 		srand(glfwGetTime()); // random seed
-		m_LightColours.clear();
-		m_LightPositions.clear();
+		m_PointLights.clear();
+		const float linearAttenuation = 0.5;
+		const float quadraticAttenuation = 0.4;
 		for (unsigned int i = 0; i < NUM_LIGHTS; i++)
 		{
+			PointLightData light = {};
 			// calculate slightly random offsets
 			float xPos = ((rand() % 100) / 100.0) * m_NumModelColumns * m_SpacingAmount;
 			float yPos = ((rand() % 100) / 100.0) * 4.0 - 2.0;
 			float zPos = ((rand() % 100) / 100.0) * m_NumModelRows * m_SpacingAmount;
-			m_LightPositions.push_back(glm::vec3(xPos, yPos, zPos));
+			light.Position = glm::vec3(xPos, yPos, zPos);
 			// also calculate random color
 			float rColor = ((rand() % 100) / 200.0f) + 0.5; // between 0.5 and 1.0
 			float gColor = ((rand() % 100) / 200.0f) + 0.5; // between 0.5 and 1.0
 			float bColor = ((rand() % 100) / 200.0f) + 0.5; // between 0.5 and 1.0
-			m_LightColours.push_back(glm::vec3(rColor, gColor, bColor));
+			light.Colour = glm::vec3(rColor, gColor, bColor);
+			light.Linear = linearAttenuation;
+			light.Quadratic = quadraticAttenuation;
+			m_PointLights.push_back(light);
 		}
 
 		// Setup manual framebuffer (GBuffer)
 		m_GBuffer->Bind();
 		// Position 'colour' buffer
 		glGenTextures(1, &m_PositionGBuffer);
-		glBindTexture(GL_TEXTURE_2D, m_PositionGBuffer);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_PositionGBuffer);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_PositionGBuffer, 0);
 		// Normal 'colour' buffer
 		glGenTextures(1, &m_NormalGBuffer);
-		glBindTexture(GL_TEXTURE_2D, m_NormalGBuffer);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_NormalGBuffer);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_NormalGBuffer, 0);
 		// Albedo + Specular 'colour' buffer
 		glGenTextures(1, &m_AlbedoSpecGBuffer);
-		glBindTexture(GL_TEXTURE_2D, m_AlbedoSpecGBuffer);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_AlbedoSpecGBuffer);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -297,8 +333,8 @@ namespace test
 		glfwSetInputMode(m_MainWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 		// Enable face culling
-		glEnable(GL_CULL_FACE);
-		glCullFace(GL_BACK); // cull back faces
+		GLStateCache::Enable(GL_CULL_FACE);
+		GLStateCache::CullFace(GL_BACK); // cull back faces
 		glFrontFace(GL_CCW); // tell OpenGL that front faces have CCW winding order
 
 		// Bind shader program and set uniforms
@@ -310,17 +346,16 @@ namespace test
 		glm::mat4 viewMatrix = m_Camera.GetViewMatrix();
 		glm::mat4 projMatrix = glm::perspective(glm::radians(m_Camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 200.0f);
 		m_GBufferShader->SetMatrix4f("model", modelMatrix);
-		m_GBufferShader->SetMatrix4f("view", viewMatrix);
-		m_GBufferShader->SetMatrix4f("proj", projMatrix);
+		FrameUniforms::GetInstance()->SetCamera(viewMatrix, projMatrix, m_Camera.Position);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		//GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-		GLCall(glBlendFunc(GL_ONE, GL_ZERO));
+		GLStateCache::Enable(GL_BLEND);
+		//GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLStateCache::BlendFunc(GL_ONE, GL_ZERO);
 
 		// Reset all callbacks
 		// Callback function for keyboard inputs
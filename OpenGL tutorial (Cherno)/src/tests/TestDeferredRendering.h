@@ -9,7 +9,10 @@
 #include "IndexBuffer.h"
 #include "FrameBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
+#include "FrameUniforms.h"
+#include "ShaderVariants.h"
 
 #include <memory>
 #include <Model.h>
@@ -24,16 +27,20 @@ namespace test
 		GLFWwindow* m_MainWindow;
 		bool modelLoaded;
 		Model* m_Model;
+		Model* m_CompactModel; // Same model with MESH_VERTEX_COMPACT vertices, to compare against
+		bool m_UseCompactVertices;
 		VertexArray* m_VA_Ground;
 		VertexBuffer* m_VB_Ground;
 		IndexBuffer* m_IB_Ground;
 		VertexArray*  m_VA_Quad;
 		VertexBuffer* m_VB_Quad;
 		IndexBuffer*  m_IB_Quad;
+		ShaderVariants* m_GBufferShaderVariants;
 		Shader* m_GBufferShader;
+		bool m_UseTextureArray;
 		Shader* m_QuadShader;
-		Texture* m_GroundTexture;
-		Texture* m_SecondaryTexture;
+		std::shared_ptr<Texture> m_GroundTexture;
+		std::shared_ptr<Texture> m_SecondaryTexture;
 		glm::vec3 m_CameraPos;
 		glm::vec3 m_CameraFront;
 		glm::vec3 m_CameraUp;
@@ -42,8 +49,7 @@ namespace test
 		const unsigned int NUM_LIGHTS; 
 		const int m_NumModelColumns;
 		const int m_NumModelRows;
-		std::vector<glm::vec3> m_LightPositions;
-		std::vector<glm::vec3> m_LightColours;
+		std::vector<PointLightData> m_PointLights;
 		float m_SpacingAmount;
 		// Deferred Rendering variables
 		FrameBuffer* m_GBuffer;
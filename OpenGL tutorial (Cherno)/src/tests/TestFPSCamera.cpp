@@ -71,7 +71,7 @@ namespace test
 
 		// Bind shader program and set uniforms
 		m_Shader->Bind();
-		m_Texture = std::make_unique<Texture>("res/textures/high_res_world_map_texture.png");
+		m_Texture = TextureCache::Get("res/textures/high_res_world_map_texture.png");
 		m_Texture->Bind(0); // make sure this texture slot is the same as the one set in the next line, which tells the shader where to find the Sampler2D data
 		m_Shader->SetUniform1i("u_Texture0", 0);
 
@@ -138,18 +138,18 @@ namespace test
 	{
 		// Bind shader program and reset any uniforms
 		m_Shader->Bind();
-		m_Texture = std::make_unique<Texture>("res/textures/high_res_world_map_texture.png");
+		m_Texture = TextureCache::Get("res/textures/high_res_world_map_texture.png");
 		m_Texture->Bind(0); // make sure this texture slot is the same as the one set in the next line, which tells the shader where to find the Sampler2D data
 		m_Shader->SetUniform1i("u_Texture0", 0);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		//GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-		GLCall(glBlendFunc(GL_ONE, GL_ZERO));
+		GLStateCache::Enable(GL_BLEND);
+		//GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLStateCache::BlendFunc(GL_ONE, GL_ZERO);
 
 		// Reset all callbacks
 		// Callback function for keyboard inputs
@@ -89,7 +89,7 @@ namespace test
 		{
 			// Flip texture along y axis before loading
 			stbi_set_flip_vertically_on_load(true);
-			m_BackpackModel = new Model((char*)"res/models/backpack/backpack.obj");
+			m_BackpackModel = new Model((char*)"res/models/backpack/backpack.obj", false); // keepGeometry off, nothing reads the vertices back
 			modelLoaded = true;
 		}
 
@@ -100,12 +100,12 @@ namespace test
 		//glEnable(GL_PROGRAM_POINT_SIZE);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		
 		// Reset all callbacks
 		// Callback function for mouse cursor movement
@@ -4,6 +4,7 @@
 #include <tests\TestClearColour.h>
 
 #include "Globals.h"
+#include "GPUProfiler.h"
 
 namespace test
 {
@@ -34,10 +35,10 @@ namespace test
 		m_HDRLightingShader(new Shader("res/shaders/HDRBloomSetup.shader")),
 		m_PointlightsShader(new Shader("res/shaders/PointLights.shader")),
 		m_QuadShader(new Shader("res/shaders/HDRBloom.shader")),
-		m_GroundTexture(new Texture("res/textures/wooden_floor_texture.png")),
-		//m_CubeTexture(new Texture("res/textures/wooden_container_texture.png"))
-		//m_CubeTexture(new Texture("res/textures/metal_border_container_texture.png"))
-		m_CubeTexture(new Texture("res/textures/brick_texture.png")),
+		m_GroundTexture(TextureCache::Get("res/textures/wooden_floor_texture.png")),
+		//m_CubeTexture(TextureCache::Get("res/textures/wooden_container_texture.png"))
+		//m_CubeTexture(TextureCache::Get("res/textures/metal_border_container_texture.png"))
+		m_CubeTexture(TextureCache::Get("res/textures/brick_texture.png")),
 		m_LightIntensity(1.0f),
 		m_LightExposure(1.0f),
 		m_UsingHDR(true),
@@ -260,6 +261,9 @@ namespace test
 		processInputHDRBloom(m_MainWindow);
 
 		Renderer renderer;
+		GPUProfiler* profiler = GPUProfiler::GetInstance();
+		GPUProfileScope testScope("HDR and Bloom");
+		profiler->BeginScope("Scene");
 
 		// Bind shader and set its per frame uniforms
 		m_HDRLightingShader->Bind();
@@ -283,7 +287,7 @@ namespace test
 							clearColour[2] * m_LightIntensity / darknessFactor, 
 							clearColour[3] * m_LightIntensity / darknessFactor));
 		GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT)); // not using the stencil buffer
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		m_HDRLightingShader->Bind();
 		// Changing pointlight properties
 		// Pointlight #1
@@ -317,7 +321,7 @@ namespace test
 		renderer.DrawTriangles(*m_VA_Cube, *m_IB_Cube, *m_PointlightsShader);
 
 		// Then render the skybox with depth testing at LEQUAL (and set z component to be (w / w) = 1.0 = max depth in vertex shader)
-		glDepthFunc(GL_LEQUAL);
+		GLStateCache::DepthFunc(GL_LEQUAL);
 		m_SkyboxShader->Bind();
 		// Model, View, Projection matrices
 		model = glm::mat4(1.0f);
@@ -327,25 +331,28 @@ namespace test
 		m_SkyboxShader->SetMatrix4f("viewMatrix", view);
 		m_SkyboxShader->SetMatrix4f("projMatrix", proj);
 		renderer.DrawTriangles(*m_VA_Skybox, *m_IB_Skybox, *m_SkyboxShader);
-		glDepthFunc(GL_LESS);
-
+		GLStateCache::DepthFunc(GL_LESS);
+		profiler->EndScope(); // Scene
 
 		// Now that we've filled the HDR and bloom colour buffers, Gaussian blur for the bloom effect
+		profiler->BeginScope("Blur ping-pong");
 		bool horizontal = true;
 		bool first_iteration = true;
 		m_BlurShader->Bind();
 		for (unsigned int i = 0; i < m_NumBlurPasses; i++)
 		{
-			glBindFramebuffer(GL_FRAMEBUFFER, m_PingpongFramebuffers[horizontal]);
+			GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, m_PingpongFramebuffers[horizontal]);
 			m_BlurShader->SetBool("horizontal", horizontal);
-			glBindTexture(GL_TEXTURE_2D, first_iteration ? m_BloomBuffer : m_PingpongColourBuffers[!horizontal]);
+			GLStateCache::BindTexture(GL_TEXTURE_2D, first_iteration ? m_BloomBuffer : m_PingpongColourBuffers[!horizontal]);
 			renderer.DrawTriangles(*m_VA_Quad, *m_IB_Quad, *m_BlurShader);
 			horizontal = !horizontal;
 			if (first_iteration)
 				first_iteration = false;
 		}
+		profiler->EndScope(); // Blur ping-pong
 
 		// Now render the scene to the default framebuffer and use the rendered framebuffer as a texture
+		profiler->BeginScope("Composite");
 		// Rebind default framebuffer
 		m_ManualFramebuffer->Unbind();
 		// Clear depth buffer and colour buffer attachments
@@ -357,16 +364,17 @@ namespace test
 
 		m_QuadShader->Bind();
 		// Bind both HDR and blurred Bloom colour buffers
-		GLCall(glActiveTexture(GL_TEXTURE2));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_HDRBuffer));
+		GLStateCache::ActiveTexture(GL_TEXTURE2);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_HDRBuffer);
 		m_QuadShader->SetInt("hdrImageTexture", 2);
-		GLCall(glActiveTexture(GL_TEXTURE3));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_PingpongColourBuffers[!horizontal]));
+		GLStateCache::ActiveTexture(GL_TEXTURE3);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_PingpongColourBuffers[!horizontal]);
 		m_QuadShader->SetInt("bloomImageTexture", 3);
 		m_QuadShader->SetBool("u_UsingHDR", m_UsingHDR);
 		m_QuadShader->SetFloat("u_Exposure", m_LightExposure);
 		// Draw the mixed HDR/Bloom effects textured quad to the default framebuffer
 		renderer.DrawTriangles(*m_VA_Quad, *m_IB_Quad, *m_QuadShader); 
+		profiler->EndScope(); // Composite
 	}
 
 	void TestHDRBloom::OnImGuiRender()
@@ -386,6 +394,7 @@ namespace test
 		ImGui::Text("- Use scroll wheel to change FOV");
 		ImGui::Text("- Press '1' and '2' to toggle wireframe mode");
 		ImGui::Text("- Avg %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+		GPUProfiler::GetInstance()->OnImGuiRender();
 	}
 
 	void TestHDRBloom::OnActivated()
@@ -414,8 +423,7 @@ namespace test
 		m_HDRLightingShader->SetFloat("pointLights[1].quadratic", quadratic);
 
 		// Skybox shader
-		delete m_SkyboxTexture;
-		m_SkyboxTexture = new Texture(std::vector<std::string>({ "res/textures/night_skybox_alt/right.jpg",
+		m_SkyboxTexture = TextureCache::GetCubemap(std::vector<std::string>({ "res/textures/night_skybox_alt/right.jpg",
 																 "res/textures/night_skybox_alt/left.jpg",
 																 "res/textures/night_skybox_alt/top.jpg",
 																 "res/textures/night_skybox_alt/bottom.jpg",
@@ -433,7 +441,7 @@ namespace test
 			// Next, create and attach any framebuffer attachments (colour/depth/stecil buffers and others)
 			// Create an empty HDR colour buffer for typical rendering using lighting 
 			GLCall(glGenTextures(1, &m_HDRBuffer));
-			GLCall(glBindTexture(GL_TEXTURE_2D, m_HDRBuffer));
+			GLStateCache::BindTexture(GL_TEXTURE_2D, m_HDRBuffer);
 			// Floating point framebuffer attachment with 16 bits per colour component
 			// With a floating point colour buffer, we can now render the scene and colour values won't get clamped between 0.0 and 1.0
 			GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL));
@@ -446,7 +454,7 @@ namespace test
 			//
 			// Also create a Bloom colour buffer that will just store pixels over a certain brightness level
 			GLCall(glGenTextures(1, &m_BloomBuffer));
-			GLCall(glBindTexture(GL_TEXTURE_2D, m_BloomBuffer));
+			GLStateCache::BindTexture(GL_TEXTURE_2D, m_BloomBuffer);
 			// Floating point framebuffer attachment with 16 bits per colour component
 			// With a floating point colour buffer, we can now render the scene and colour values won't get clamped between 0.0 and 1.0
 			GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL));
@@ -482,8 +490,8 @@ namespace test
 			GLCall(glGenTextures(2, m_PingpongColourBuffers));
 			for (unsigned int i = 0; i < 2; i++)
 			{
-				GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_PingpongFramebuffers[i]));
-				GLCall(glBindTexture(GL_TEXTURE_2D, m_PingpongColourBuffers[i]));
+				GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, m_PingpongFramebuffers[i]);
+				GLStateCache::BindTexture(GL_TEXTURE_2D, m_PingpongColourBuffers[i]);
 				GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL));
 				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -494,12 +502,12 @@ namespace test
 		}
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// Reset all callbacks
 		// Callback function for keyboard inputs
@@ -9,6 +9,7 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
 
 namespace test
@@ -35,8 +36,8 @@ namespace test
 		Shader* m_HDRLightingShader;
 		Shader* m_PointlightsShader;
 		Shader* m_QuadShader;
-		Texture* m_GroundTexture;
-		Texture* m_CubeTexture;
+		std::shared_ptr<Texture> m_GroundTexture;
+		std::shared_ptr<Texture> m_CubeTexture;
 		unsigned int m_HDRBuffer;
 		unsigned int m_BloomBuffer;
 		glm::vec3 m_PointLightPositions[2];
@@ -51,7 +52,7 @@ namespace test
 		unsigned int m_NumBlurPasses;
 		// Skybox data
 		Shader* m_SkyboxShader;
-		Texture* m_SkyboxTexture;
+		std::shared_ptr<Texture> m_SkyboxTexture;
 		VertexArray* m_VA_Skybox;
 		VertexBuffer* m_VB_Skybox;
 		IndexBuffer* m_IB_Skybox;
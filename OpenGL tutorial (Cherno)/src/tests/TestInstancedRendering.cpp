@@ -20,7 +20,7 @@ namespace test
 		modelsLoaded(false),
 		m_PlanetModel(nullptr),
 		m_AsteroidModel(nullptr),
-		m_AsteroidTexture(new Texture("res/models/rock/rock.png")),
+		m_AsteroidTexture(TextureCache::Get("res/models/rock/rock.png")),
 		m_AsteroidCount(50000),
 		m_AsteroidModelMatrices(new glm::mat4[m_AsteroidCount]),
 		m_CameraPos(glm::vec3(-10.0f, 40.0f, 100.0f)),
@@ -171,7 +171,7 @@ namespace test
 		
 
 		// Then render the skybox with depth testing at LEQUAL (and set z component to be (w / w) = 1.0 = max depth in vertex shader)
-		glDepthFunc(GL_LEQUAL);
+		GLStateCache::DepthFunc(GL_LEQUAL);
 		m_SkyboxShader->Bind();
 		// Model, View, Projection matrices
 		modelMatrix = glm::mat4(1.0f);
@@ -180,7 +180,7 @@ namespace test
 		m_SkyboxShader->SetMatrix4f("viewMatrix", viewMatrix);
 		m_SkyboxShader->SetMatrix4f("projMatrix", projMatrix);
 		renderer.DrawTriangles(*m_VA_Skybox, *m_IB_Skybox, *m_SkyboxShader);
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 	}
 
 	void TestInstancedRendering::OnActivated()
@@ -190,9 +190,9 @@ namespace test
 		{
 			// Flip textures along y axis before loading
 			stbi_set_flip_vertically_on_load(true);
-			m_PlanetModel = new Model((char*)"res/models/planet/planet.obj");
+			m_PlanetModel = new Model((char*)"res/models/planet/planet.obj", false); // Neither model keeps a CPU copy of its geometry
 			//m_PlanetModel = new Model((char*)"res/models/backpack/backpack.obj");
-			m_AsteroidModel = new Model((char*)"res/models/rock/rock.obj");
+			m_AsteroidModel = new Model((char*)"res/models/rock/rock.obj", false);
 			modelsLoaded = true;
 		}
 
@@ -236,11 +236,11 @@ namespace test
 		// Fill buffer with the data
 		glBufferData(GL_ARRAY_BUFFER, m_AsteroidCount * sizeof(glm::mat4), &m_AsteroidModelMatrices[0], GL_STATIC_DRAW);
 		// For each mesh in the asteroid model, get its Vertex Array and setup attribute pointers
-		std::vector<Mesh> asteroidMeshes = m_AsteroidModel->GetMeshes();
+		const std::vector<Mesh>& asteroidMeshes = m_AsteroidModel->GetMeshes();
 		for (unsigned int i = 0; i < asteroidMeshes.size(); i++)
 		{
 			unsigned int VAO = asteroidMeshes[i].GetVAO();
-			glBindVertexArray(VAO);
+			GLStateCache::BindVertexArray(VAO);
 			std::size_t vec4Size = sizeof(glm::vec4);
 			// Maximum attribute size is vec4, so we must use 4 of them to store each mat4
 			glEnableVertexAttribArray(3);
@@ -257,7 +257,7 @@ namespace test
 			glVertexAttribDivisor(5, 1);
 			glVertexAttribDivisor(6, 1);
 
-			glBindVertexArray(0);
+			GLStateCache::BindVertexArray(0);
 		}
 
 		// Hide and capture mouse cursor
@@ -266,8 +266,7 @@ namespace test
 		//  Reset all uniforms
 		//
 		// Skybox shader
-		delete m_SkyboxTexture;
-		m_SkyboxTexture = new Texture(std::vector<std::string>({ "res/textures/night_skybox_alt/right.jpg",
+		m_SkyboxTexture = TextureCache::GetCubemap(std::vector<std::string>({ "res/textures/night_skybox_alt/right.jpg",
 																 "res/textures/night_skybox_alt/left.jpg",
 																 "res/textures/night_skybox_alt/top.jpg",
 																 "res/textures/night_skybox_alt/bottom.jpg",
@@ -278,12 +277,12 @@ namespace test
 		m_SkyboxShader->SetInt("u_SkyboxTexture", 4);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		
 		// Reset all callbacks
 		// Callback function for mouse cursor movement
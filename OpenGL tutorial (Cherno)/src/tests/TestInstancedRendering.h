@@ -9,6 +9,7 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
 #include <Model.h>
 
@@ -22,7 +23,7 @@ namespace test
 		bool modelsLoaded;
 		Model* m_PlanetModel;
 		Model* m_AsteroidModel;
-		Texture* m_AsteroidTexture;
+		std::shared_ptr<Texture> m_AsteroidTexture;
 		unsigned int m_AsteroidCount;
 		glm::mat4* m_AsteroidModelMatrices;
 		glm::vec3 m_CameraPos;
@@ -32,7 +33,7 @@ namespace test
 		bool m_UsingInstancing;
 		// Skybox data
 		Shader* m_SkyboxShader;
-		Texture* m_SkyboxTexture;
+		std::shared_ptr<Texture> m_SkyboxTexture;
 		VertexArray* m_VA_Skybox;
 		VertexBuffer* m_VB_Skybox;
 		IndexBuffer* m_IB_Skybox;
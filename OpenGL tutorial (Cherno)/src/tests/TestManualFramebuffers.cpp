@@ -35,9 +35,9 @@ namespace test
 		m_IB_Cube(new IndexBuffer()),
 		m_Shader(new Shader("res/shaders/Basic.shader")),
 		m_QuadShader(new Shader("res/shaders/FramebufferTest.shader")),
-		m_WaterTexture(new Texture("res/textures/shallow_water_texture.png")),
-		//m_CubeTexture(new Texture("res/textures/wooden_container_texture.png"))
-		m_CubeTexture(new Texture("res/textures/metal_border_container_texture.png"))
+		m_WaterTexture(TextureCache::Get("res/textures/shallow_water_texture.png")),
+		//m_CubeTexture(TextureCache::Get("res/textures/wooden_container_texture.png"))
+		m_CubeTexture(TextureCache::Get("res/textures/metal_border_container_texture.png"))
 	{
 		instance = this;
 
@@ -162,7 +162,7 @@ namespace test
 		// Next, create and attach any framebuffer attachments (colour/depth/stecil buffers and others)
 		// Create an empty 'texture' the same size as the window, to attach to the framebuffer & to render into
 		GLCall(glGenTextures(1, &m_FramebufferTexture));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_FramebufferTexture));
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_FramebufferTexture);
 		GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL)); // TODO use GL_RGBA?
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -238,7 +238,7 @@ namespace test
 		GLCall(glClearColor(clearColour[0] / (darknessFactor * 1.1f), clearColour[1] / (darknessFactor * 1.1f),
 			clearColour[2] / (darknessFactor * 1.1f), clearColour[3] / (darknessFactor * 1.1f)));
 		GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT)); // not using the stencil buffer
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		m_Shader->Bind();
 		m_WaterTexture->Bind(0); // make sure this texture slot is the same as the one set in the next line, which tells the shader where to find the Sampler2D data
 		m_Shader->SetInt("u_Texture0", 0);
@@ -260,8 +260,8 @@ namespace test
 		GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT)); // not using the stencil buffer
 
 		m_QuadShader->Bind();
-		GLCall(glActiveTexture(GL_TEXTURE2));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_FramebufferTexture));
+		GLStateCache::ActiveTexture(GL_TEXTURE2);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_FramebufferTexture);
 		m_QuadShader->SetInt("framebufferTexture", 2);
 		// Draw the rear-view framebuffer textured quad to the default framebuffer
 		renderer.DrawTriangles(*m_VA_Quad, *m_IB_Quad, *m_QuadShader); 
@@ -309,12 +309,12 @@ namespace test
 		m_Shader->SetInt("u_Texture1", 1);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// Reset all callbacks
 		// Callback function for keyboard inputs
@@ -9,6 +9,7 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
 
 namespace test
@@ -35,8 +36,8 @@ namespace test
 		IndexBuffer* m_IB_Cube;
 		Shader* m_Shader;
 		Shader* m_QuadShader;
-		Texture* m_WaterTexture;
-		Texture* m_CubeTexture;
+		std::shared_ptr<Texture> m_WaterTexture;
+		std::shared_ptr<Texture> m_CubeTexture;
 		unsigned int m_FramebufferTexture;
 
 	public: 
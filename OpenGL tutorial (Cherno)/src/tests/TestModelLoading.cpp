@@ -22,6 +22,7 @@ namespace test
 		modelLoaded(false),
 		m_BackpackModel(nullptr),
 		m_Shader(new Shader("res/shaders/Backpack.shader")),
+		m_Material(m_Shader),
 		m_CameraPos(glm::vec3(0.0f, 0.0f, 4.0f)),
 		m_CameraFront(glm::vec3(0.0f, 0.0f, -1.0f)),
 		m_CameraUp(glm::vec3(0.0f, 1.0f, 0.0f)),
@@ -120,24 +121,19 @@ namespace test
 		m_Shader->SetMatrix4f("proj", projMatrix);
 
 		// Update camera's viewing position each frame
-		m_Shader->SetVec3f("viewPos", m_Camera.Position.x, m_Camera.Position.y, m_Camera.Position.z);
+		m_Material.SetVec3("viewPos", m_Camera.Position);
 
-		// Flashlight's properties
+		// Flashlight's properties (constant attenuation and cutoffs are set once in OnActivated)
 		//
-		m_Shader->SetBool("u_Flashlight.on", m_IsFlashlightOn);
-		m_Shader->SetVec3("u_Flashlight.ambient", m_fl_ambientColour);
-		m_Shader->SetVec3("u_Flashlight.diffuse", m_fl_diffuseColour);
-		m_Shader->SetVec3("u_Flashlight.specular", m_fl_specularIntensity);
-		// Flashlight attenuation properties
-		m_Shader->SetFloat("u_Flashlight.constant", 1.0f);
-		m_Shader->SetFloat("u_Flashlight.linear", 0.06f);
-		m_Shader->SetFloat("u_Flashlight.quadratic", 0.005f);
+		m_Material.SetBool("u_Flashlight.on", m_IsFlashlightOn);
+		m_Material.SetVec3("u_Flashlight.ambient", m_fl_ambientColour);
+		m_Material.SetVec3("u_Flashlight.diffuse", m_fl_diffuseColour);
+		m_Material.SetVec3("u_Flashlight.specular", m_fl_specularIntensity);
 		// Flashlight position and direction
-		m_Shader->SetVec3f("u_Flashlight.position", m_Camera.Position.x, m_Camera.Position.y, m_Camera.Position.z);
-		m_Shader->SetVec3f("u_Flashlight.direction", m_Camera.Front.x, m_Camera.Front.y, m_Camera.Front.z);
-		// Flashlight cutoff angle
-		m_Shader->SetFloat("u_Flashlight.cutOff", glm::cos(glm::radians(5.0f)));
-		m_Shader->SetFloat("u_Flashlight.outerCutOff", glm::cos(glm::radians(50.0f)));
+		m_Material.SetVec3("u_Flashlight.position", m_Camera.Position);
+		m_Material.SetVec3("u_Flashlight.direction", m_Camera.Front);
+		// Upload only the values that changed since last frame
+		m_Material.Apply();
 		// Bind ground texture
 		m_GroundTexture->BindAndSetRepeating(0); // make sure this texture slot is the same as the one set in the next line, which tells the shader where to find the Sampler2D data
 		m_Shader->SetUniform1i("texture_diffuse0", 0);
@@ -165,7 +161,7 @@ namespace test
 		{
 			// Flip texture along y axis before loading
 			stbi_set_flip_vertically_on_load(true);
-			 m_BackpackModel = new Model((char*)"res/models/backpack/backpack.obj");
+			 m_BackpackModel = new Model((char*)"res/models/backpack/backpack.obj", false);
 			//m_BackpackModel = new Model((char*)"res/models/nature/BlenderNatureAsset.obj");
 			//m_BackpackModel = new Model((char*)"res/models/Pathfinder crew/pathfinder_crew.obj");
 			modelLoaded = true;
@@ -174,13 +170,23 @@ namespace test
 		// Hide and capture mouse cursor
 		glfwSetInputMode(m_MainWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-		// Load ground texture
-		m_GroundTexture = std::make_unique<Texture>("res/textures/dirt_ground_texture.png");
+		// Load ground texture. The ground is a huge plane seen at grazing angles, which is where a sharper (Kaiser filtered)
+		// mip chain and anisotropic filtering make the most difference.
+		m_GroundTexture = TextureCache::Get("res/textures/dirt_ground_texture.png", true, true, MIPMAP_KAISER);
+		m_GroundTexture->SetAnisotropy(Texture::GetMaxAnisotropy());
 
 		// Bind shader program and set uniforms
 		m_Shader->Bind();
-		m_Shader->SetVec3f("u_Material.specular", 0.5f, 0.5f, 0.5f);
-		m_Shader->SetFloat("u_Material.shininess", 16.0f);
+		m_Material.SetVec3("u_Material.specular", glm::vec3(0.5f));
+		m_Material.SetFloat("u_Material.shininess", 16.0f);
+		// Flashlight attenuation properties
+		m_Material.SetFloat("u_Flashlight.constant", 1.0f);
+		m_Material.SetFloat("u_Flashlight.linear", 0.06f);
+		m_Material.SetFloat("u_Flashlight.quadratic", 0.005f);
+		// Flashlight cutoff angle
+		m_Material.SetFloat("u_Flashlight.cutOff", glm::cos(glm::radians(5.0f)));
+		m_Material.SetFloat("u_Flashlight.outerCutOff", glm::cos(glm::radians(50.0f)));
+		m_Material.Apply();
 		// Reset MVP matrices on activation
 		glm::mat4 modelMatrix = glm::mat4(1.0);
 		modelMatrix = glm::translate(modelMatrix, glm::vec3(50.0, 0.0, 36.0));
@@ -192,18 +198,18 @@ namespace test
 		m_Shader->SetMatrix4f("proj", projMatrix);
 
 		// Enable face culling
-		glEnable(GL_CULL_FACE);
-		//glCullFace(GL_FRONT); // cull front faces
-		glCullFace(GL_BACK); // cull back faces
+		GLStateCache::Enable(GL_CULL_FACE);
+		//GLStateCache::CullFace(GL_FRONT); // cull front faces
+		GLStateCache::CullFace(GL_BACK); // cull back faces
 		glFrontFace(GL_CCW); // tell OpenGL that front faces have CCW winding order
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// Reset all callbacks
 		// Callback function for keyboard inputs
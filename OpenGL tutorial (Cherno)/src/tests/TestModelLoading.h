@@ -8,7 +8,9 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
+#include "MaterialParameters.h"
 
 #include <memory>
 #include <Model.h>
@@ -27,7 +29,8 @@ namespace test
 		std::unique_ptr<VertexBuffer> m_VB;
 		std::unique_ptr<IndexBuffer> m_IB;
 		Shader* m_Shader;
-		std::unique_ptr<Texture> m_GroundTexture;
+		MaterialParameters m_Material;
+		std::shared_ptr<Texture> m_GroundTexture;
 		glm::vec3 m_CameraPos;
 		glm::vec3 m_CameraFront;
 		glm::vec3 m_CameraUp;
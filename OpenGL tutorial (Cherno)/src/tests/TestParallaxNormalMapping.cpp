@@ -16,24 +16,31 @@ namespace test
 	// Init static variable
 	TestParallaxNormalMapping* TestParallaxNormalMapping::instance;
 
+	// Keyword bits of m_QuadParallaxShaderVariants
+	static const unsigned int QUAD_VARIANT_PARALLAX = 1 << 0;
+
 	TestParallaxNormalMapping::TestParallaxNormalMapping(GLFWwindow*& mainWindow)
 		: m_MainWindow(mainWindow),
 		m_CameraPos(glm::vec3(0.0f, 0.0f, 10.0f)),
 		m_Camera(Camera(m_CameraPos, 75.0f)),
-		m_QuadParallaxShader(new Shader("res/shaders/ParallaxNormalMapping.shader")),
+		m_QuadParallaxShaderVariants(new ShaderVariants("res/shaders/ParallaxNormalMapping.shader", { "PARALLAX" })),
+		m_QuadParallaxShader(m_QuadParallaxShaderVariants->Get(QUAD_VARIANT_PARALLAX)),
 		m_VA_Quad(new VertexArray()),
-		m_QuadTexture0(new Texture("res/textures/bricks_texture_parallax.png", true, false)),
-		m_QuadNormalMap0(new Texture("res/textures/bricks_normal_parallax.png", true, false)),
-		m_QuadHeightMap0(new Texture("res/textures/bricks_heightmap_parallax.png", true, false)),
-		m_QuadTexture1(new Texture("res/textures/wooden_floor_texture.png", true, false)),
-		m_QuadNormalMap1(new Texture("res/textures/parallax_indents_normal_map.png", true, false)),
-		m_QuadHeightMap1(new Texture("res/textures/parallax_indents_depth_map.png", true, false)),
+		m_QuadTexture0(TextureCache::Get("res/textures/bricks_texture_parallax.png", true, false)),
+		m_QuadNormalMap0(TextureCache::Get("res/textures/bricks_normal_parallax.png", true, false)),
+		m_QuadHeightMap0(TextureCache::Get("res/textures/bricks_heightmap_parallax.png", true, false)),
+		m_QuadTexture1(TextureCache::Get("res/textures/wooden_floor_texture.png", true, false)),
+		m_QuadNormalMap1(TextureCache::Get("res/textures/parallax_indents_normal_map.png", true, false)),
+		m_QuadHeightMap1(TextureCache::Get("res/textures/parallax_indents_depth_map.png", true, false)),
 		m_UsingParallaxMapping(true),
 		m_ParallaxHeightScale(0.1f),
 		m_ActiveTextureIndex(1)
 	{
 		instance = this;
 
+		// Compile the variant without parallax mapping up front too, inside the application's ShaderBatch
+		m_QuadParallaxShaderVariants->Get(0);
+
 		// Quad data
 		glm::vec3 pos1(-0.5, -0.5, 0.5);
 		glm::vec3 pos2( 0.5,  0.5, 0.5);
@@ -93,7 +100,16 @@ namespace test
 	void TestParallaxNormalMapping::ToggleParallaxMapping(const bool flag)
 	{
 		m_UsingParallaxMapping = flag;
-		m_QuadParallaxShader->SetBool("u_UsingParallaxMapping", m_UsingParallaxMapping);
+		// Switch programs, and set the samplers since uniform values belong to each variant
+		m_QuadParallaxShader = m_QuadParallaxShaderVariants->Get(m_UsingParallaxMapping ? QUAD_VARIANT_PARALLAX : 0);
+		m_QuadParallaxShader->Bind();
+		// Diffuse texture
+		m_QuadParallaxShader->SetInt("diffuseMap", 1);
+		// Normal map
+		m_QuadParallaxShader->SetInt("normalMap", 2);
+		// Height map for Parallax texture (only used by the parallax variant)
+		if (m_UsingParallaxMapping)
+			m_QuadParallaxShader->SetInt("depthMap", 3);
 	}
 
 	void TestParallaxNormalMapping::ParallaxHeightScaling(int dir)
@@ -172,7 +188,8 @@ namespace test
 		m_QuadParallaxShader->SetMatrix4f("projection", projMatrix);
 		m_QuadParallaxShader->SetVec3("viewPos", m_Camera.Position);
 		//m_QuadParallaxShader->SetVec3("lightPos", ...);
-		m_QuadParallaxShader->SetFloat("height_scale", m_ParallaxHeightScale);
+		if (m_UsingParallaxMapping)
+			m_QuadParallaxShader->SetFloat("height_scale", m_ParallaxHeightScale);
 		
 		renderer.DrawTriangles(*m_VA_Quad, *m_IB_Quad, *m_QuadParallaxShader);
 	}
@@ -201,24 +218,17 @@ namespace test
 		glfwSetInputMode(m_MainWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 		//  Reset all uniforms
-		m_QuadParallaxShader->Bind();
-		m_QuadParallaxShader->SetBool("u_UsingParallaxMapping", m_UsingParallaxMapping);
+		ToggleParallaxMapping(m_UsingParallaxMapping);
 		// Bind all texture maps
 		SwitchTexture(m_ActiveTextureIndex);
-		// Diffuse texture
-		m_QuadParallaxShader->SetInt("diffuseMap", 1);
-		// Normal map
-		m_QuadParallaxShader->SetInt("normalMap", 2);
-		// Height map for Parallax texture
-		m_QuadParallaxShader->SetInt("depthMap", 3);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		
 		// Reset all callbacks
 		// Callback function for mouse cursor movement
@@ -9,7 +9,9 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
+#include "ShaderVariants.h"
 
 namespace test
 {
@@ -20,16 +22,17 @@ namespace test
 		GLFWwindow* m_MainWindow;
 		glm::vec3 m_CameraPos;
 		Camera m_Camera;
-		Shader* m_QuadParallaxShader;
+		ShaderVariants* m_QuadParallaxShaderVariants;
+		Shader* m_QuadParallaxShader; // Variant currently in use (owned by m_QuadParallaxShaderVariants)
 		VertexArray* m_VA_Quad;
 		VertexBuffer* m_VB_Quad;
 		IndexBuffer* m_IB_Quad;
-		Texture* m_QuadTexture0;
-		Texture* m_QuadNormalMap0;
-		Texture* m_QuadHeightMap0;
-		Texture* m_QuadTexture1;
-		Texture* m_QuadNormalMap1;
-		Texture* m_QuadHeightMap1;
+		std::shared_ptr<Texture> m_QuadTexture0;
+		std::shared_ptr<Texture> m_QuadNormalMap0;
+		std::shared_ptr<Texture> m_QuadHeightMap0;
+		std::shared_ptr<Texture> m_QuadTexture1;
+		std::shared_ptr<Texture> m_QuadNormalMap1;
+		std::shared_ptr<Texture> m_QuadHeightMap1;
 		bool m_UsingParallaxMapping;
 		float m_ParallaxHeightScale;
 		int m_ActiveTextureIndex;
@@ -21,10 +21,14 @@ namespace test
 	// Init static variable
 	TestPhongLighting* TestPhongLighting::instance;
 
+	// Keyword bits of m_GroundShaderVariants
+	static const unsigned int GROUND_VARIANT_NORMAL_MAP = 1 << 0;
+
 	TestPhongLighting::TestPhongLighting(GLFWwindow*& mainWindow)
 		: m_MainWindow(mainWindow), 
 		m_PointLights(std::vector<PointLight>()),
-		m_GroundShader(new Shader("res/shaders/BasicPhongModel.shader")),
+		m_GroundShaderVariants(new ShaderVariants("res/shaders/BasicPhongModel.shader", { "NORMAL_MAP" })),
+		m_GroundShader(m_GroundShaderVariants->Get(0)),
 	    m_PointLightsShader(new Shader("res/shaders/PointLights.shader")),
 		m_CameraPos(glm::vec3(0.0f, 0.0f, 3.0f)), 
 		m_CameraFront(glm::vec3(0.0f, 0.0f, -1.0f)), 
@@ -49,6 +53,9 @@ namespace test
 	{
 		instance = this;
 
+		// Compile the normal mapped variant up front too, inside the application's ShaderBatch
+		m_GroundShaderVariants->Get(GROUND_VARIANT_NORMAL_MAP);
+
 		float skyboxVertices[] = {
 			//   Positions        
 			   1.0f,  1.0f, -1.0f,
@@ -272,7 +279,7 @@ namespace test
 		renderer.DrawTriangles(*m_VA_Ground, *m_IB_Ground, *m_GroundShader); 
 
 		// Then render the skybox with depth testing at LEQUAL (and set z component to be (w / w) = 1.0 = max depth in vertex shader)
-		glDepthFunc(GL_LEQUAL);
+		GLStateCache::DepthFunc(GL_LEQUAL);
 		m_SkyboxShader->Bind();
 		// Model, View, Projection matrices
 		modelMatrix = glm::mat4(1.0f);
@@ -282,7 +289,7 @@ namespace test
 		m_SkyboxShader->SetMatrix4f("viewMatrix", viewMatrix);
 		m_SkyboxShader->SetMatrix4f("projMatrix", projMatrix);
 		renderer.DrawTriangles(*m_VA_Skybox, *m_IB_Skybox, *m_SkyboxShader);
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 	}
 
 	void processMovingLights(std::vector<PointLight>& pointLights, float deltaTime)
@@ -401,23 +408,21 @@ namespace test
 		// Bind shader programs and set uniforms
 		m_GroundShader->Bind();
 		m_GroundShader->SetInt("numPointLights", m_PointLights.size());
-		m_WoodenGroundTexture = new Texture("res/textures/wooden_floor_texture.png", false);
+		m_WoodenGroundTexture = TextureCache::Get("res/textures/wooden_floor_texture.png", false);
 		m_WoodenGroundTexture->BindAndSetRepeating(1);
-		//m_RockyGroundTexture = new Texture("res/textures/dirt_ground_texture.png", false);
-		m_BrickGroundTexture = new Texture("res/textures/brick_texture.png", false);
-		m_BrickGroundNormalMap = new Texture("res/textures/brick_normal_map.png", false);
+		//m_RockyGroundTexture = TextureCache::Get("res/textures/dirt_ground_texture.png", false);
+		m_BrickGroundTexture = TextureCache::Get("res/textures/brick_texture.png", false);
+		m_BrickGroundNormalMap = TextureCache::Get("res/textures/brick_normal_map.png", false);
 		m_BrickGroundTexture->BindAndSetRepeating(0);
 		if (m_WoodenGroundEnabled)
 		{
 			m_WoodenGroundTexture->Bind(1);
 			m_GroundShader->SetInt("u_MaterialDiffuse", 1); 
-			m_GroundShader->SetBool("u_UsingNormalMap", false); 
 		}
 		else
 		{
 			m_BrickGroundTexture->Bind(0);
 			m_GroundShader->SetInt("u_MaterialDiffuse", 0);
-			m_GroundShader->SetBool("u_UsingNormalMap", true);
 		}
 		m_GroundShader->SetVec3f("u_Material.specular", 0.5f, 0.5f, 0.5f);
 		m_GroundShader->SetFloat("u_Material.shininess", 12.0f);
@@ -432,8 +437,7 @@ namespace test
 		m_GroundShader->SetMatrix4f("proj", projMatrix);
 
 		// Skybox shader
-		delete m_SkyboxTexture;
-		m_SkyboxTexture = new Texture(std::vector<std::string>({ "res/textures/night_skybox_alt/right.jpg",
+		m_SkyboxTexture = TextureCache::GetCubemap(std::vector<std::string>({ "res/textures/night_skybox_alt/right.jpg",
 																 "res/textures/night_skybox_alt/left.jpg",
 																 "res/textures/night_skybox_alt/top.jpg",
 																 "res/textures/night_skybox_alt/bottom.jpg",
@@ -447,12 +451,12 @@ namespace test
 		ToggleGroundTexture(false);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// Reset all callbacks
 		// Callback function for keyboard inputs
@@ -483,7 +487,11 @@ namespace test
 
 	void TestPhongLighting::ToggleGroundTexture(bool woodenGroundTextureFlag)
 	{
+		// Only the brick ground is normal mapped. The variants are separate programs, so the uniforms that
+		// aren't set every frame have to be set again on the one being switched to.
+		m_GroundShader = m_GroundShaderVariants->Get(woodenGroundTextureFlag ? 0 : GROUND_VARIANT_NORMAL_MAP);
 		m_GroundShader->Bind();
+		m_GroundShader->SetInt("numPointLights", m_PointLights.size());
 		if (woodenGroundTextureFlag)
 		{
 			m_WoodenGroundTexture->Bind(1); 
@@ -500,7 +508,6 @@ namespace test
 			m_GroundShader->SetFloat("u_Material.shininess", 2.0f);
 			m_BrickGroundNormalMap->Bind(5);
 			m_GroundShader->SetInt("u_NormalMap", 5);
-			m_GroundShader->SetBool("u_UsingNormalMap", true);
 			glm::mat4 normalMapRotMatrix = glm::mat4(1.0f);
 			normalMapRotMatrix = glm::rotate(normalMapRotMatrix, glm::radians(-78.0f), glm::vec3(1.0, 0.0, -0.25));
 			m_GroundShader->SetMatrix4f("u_NormalMapRotMatrix", normalMapRotMatrix);
@@ -8,7 +8,9 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
+#include "ShaderVariants.h"
 
 #include <memory>
 
@@ -34,11 +36,12 @@ namespace test
 		VertexArray* m_VA_PointLight;
 		VertexBuffer* m_VB_PointLight;
 		IndexBuffer* m_IB_PointLight;
-		Shader* m_GroundShader;
+		ShaderVariants* m_GroundShaderVariants;
+		Shader* m_GroundShader; // Variant currently in use (owned by m_GroundShaderVariants)
 		Shader* m_PointLightsShader;
-		Texture* m_BrickGroundTexture;
-		Texture* m_BrickGroundNormalMap;
-		Texture* m_WoodenGroundTexture;
+		std::shared_ptr<Texture> m_BrickGroundTexture;
+		std::shared_ptr<Texture> m_BrickGroundNormalMap;
+		std::shared_ptr<Texture> m_WoodenGroundTexture;
 		glm::vec3 m_CameraPos;
 		glm::vec3 m_CameraFront;
 		glm::vec3 m_CameraUp;
@@ -64,7 +67,7 @@ namespace test
 		bool m_WoodenGroundEnabled;
 		// Skybox data
 		Shader* m_SkyboxShader;
-		Texture* m_SkyboxTexture;
+		std::shared_ptr<Texture> m_SkyboxTexture;
 		VertexArray* m_VA_Skybox;
 		VertexBuffer* m_VB_Skybox;
 		IndexBuffer* m_IB_Skybox;
@@ -3,6 +3,7 @@
 #include "Renderer.h"
 #include <tests\TestClearColour.h>
 #include "Globals.h"
+#include "GPUProfiler.h"
 
 namespace test
 {
@@ -24,12 +25,12 @@ namespace test
 		m_Camera(Camera(m_CameraPos, 75.0f)),
 		m_Shader(new Shader("res/shaders/BasicShadowMapping.shader")),
 		m_ShadowDepthMapShader(new Shader("res/shaders/ShadowMapping.shader")),
-		m_ContainerTexture(new Texture("res/textures/metal_border_container_texture.png", false)),
-		//m_BrickTexture(new Texture("res/textures/brick_texture.png", false)),
-		m_BrickTexture(new Texture("res/textures/metal_border_container_texture.png", false)),
-		m_BrickNormalMap(new Texture("res/textures/brick_normal_map.png", false)),
+		m_ContainerTexture(TextureCache::Get("res/textures/metal_border_container_texture.png", false)),
+		//m_BrickTexture(TextureCache::Get("res/textures/brick_texture.png", false)),
+		m_BrickTexture(TextureCache::Get("res/textures/metal_border_container_texture.png", false)),
+		m_BrickNormalMap(TextureCache::Get("res/textures/brick_normal_map.png", false)),
 		m_UsingNormalMap(true),
-		m_GroundTexture(new Texture("res/textures/wooden_floor_texture.png", false)),
+		m_GroundTexture(TextureCache::Get("res/textures/wooden_floor_texture.png", false)),
 		m_VA_Cube(new VertexArray()),
 		m_VA_Ground(new VertexArray()),
 		// Flashlight properties
@@ -164,6 +165,8 @@ namespace test
 		processInputPointShadowMapping(m_MainWindow);
 
 		Renderer renderer;
+		GPUProfiler* profiler = GPUProfiler::GetInstance();
+		GPUProfileScope testScope("Perspective Shadow Mapping");
 
 		// Flashlight position and direction
 		glm::vec3 flashlightPosition = m_Camera.Position;
@@ -175,12 +178,13 @@ namespace test
 
 		// First render to the flashlight's (perspective) shadow depth map 
 		//
+		profiler->BeginScope("Depth pass");
 		// Bind shadow map framebuffer
 		glViewport(0, 0, m_ShadowMapWidth, m_ShadowMapHeight);
-		glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
 		glClear(GL_DEPTH_BUFFER_BIT);
 		// Cull front faces while filling the shadow depth buffer to avoid Peter Panning of shadows
-		glCullFace(GL_FRONT); // TODO not necessary for perspective shadow mapping?
+		GLStateCache::CullFace(GL_FRONT); // TODO not necessary for perspective shadow mapping?
 		// Configure matrices and shader
 		m_ShadowDepthMapShader->Bind();
 		float near_plane = 0.1f, far_plane = 400.0f;
@@ -225,21 +229,23 @@ namespace test
 		renderer.DrawTriangles(*m_VA_Cube, *m_IB_Cube, *m_ShadowDepthMapShader);
 		// Then draw the ground
 		renderer.DrawTriangles(*m_VA_Ground, *m_IB_Ground, *m_ShadowDepthMapShader);
+		profiler->EndScope(); // Depth pass
 
 		// Then pass the perspective shadow depth map to the other shader
 		m_Shader->Bind();
 		// Bind shadow depth map texture to shader
-		GLCall(glActiveTexture(GL_TEXTURE3));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_ShadowDepthMap));
+		GLStateCache::ActiveTexture(GL_TEXTURE3);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_ShadowDepthMap);
 		m_Shader->SetInt("shadowMapPerspective", 3);
 
 		// Then return to the default framebuffer and render the scene as normal, using the depth map to create shadows
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		profiler->BeginScope("Main pass");
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 		glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT); 
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		// Return to culling back faces
-		glCullFace(GL_BACK);
+		GLStateCache::CullFace(GL_BACK);
 
 		// Set per-frame uniforms
 		m_Shader->Bind();
@@ -299,6 +305,7 @@ namespace test
 		m_GroundTexture->BindAndSetRepeating(0);
 		m_Shader->SetInt("u_Material.diffuse", 0);
 		renderer.DrawTriangles(*m_VA_Ground, *m_IB_Ground, *m_Shader);
+		profiler->EndScope(); // Main pass
 	}
 
 	void TestPointShadowMapping::OnImGuiRender()
@@ -314,6 +321,7 @@ namespace test
 		ImGui::Text("- Use scroll wheel to change FOV");
 		ImGui::Text("- Press '1' and '2' to toggle wireframe mode");
 		ImGui::Text("- Avg %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+		GPUProfiler::GetInstance()->OnImGuiRender();
 	}
 
 	void TestPointShadowMapping::OnActivated()
@@ -336,7 +344,7 @@ namespace test
 		glGenFramebuffers(1, &m_DepthMapFBO);
 		// 2D buffer for storing depth values
 		glGenTextures(1, &m_ShadowDepthMap);
-		glBindTexture(GL_TEXTURE_2D, m_ShadowDepthMap);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_ShadowDepthMap);
 		// We only need the depth information when rendering the scene from the light's perspective, so no need for a colour or stencil buffer
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, m_ShadowMapWidth, m_ShadowMapHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -346,21 +354,21 @@ namespace test
 		float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
 		glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
 		// Attach the shadow map buffer to the framebuffer
-		glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_ShadowDepthMap, 0);
 		//A framebuffer is not 'complete' without a colour buffer so we need to explicitly set OpenGL to not render any colour data
 		glDrawBuffer(GL_NONE);
 		glReadBuffer(GL_NONE);
 		// Reset to default framebuffer
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// Reset all callbacks
 		// Callback function for mouse cursor movement
@@ -9,6 +9,7 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
 
 namespace test
@@ -22,11 +23,11 @@ namespace test
 		Camera m_Camera;
 		Shader* m_Shader;
 		Shader* m_ShadowDepthMapShader;
-		Texture* m_ContainerTexture;
-		Texture* m_BrickTexture;
-		Texture* m_BrickNormalMap;
+		std::shared_ptr<Texture> m_ContainerTexture;
+		std::shared_ptr<Texture> m_BrickTexture;
+		std::shared_ptr<Texture> m_BrickNormalMap;
 		bool m_UsingNormalMap;
-		Texture* m_GroundTexture;
+		std::shared_ptr<Texture> m_GroundTexture;
 		VertexArray* m_VA_Cube;
 		VertexBuffer* m_VB_Cube;
 		IndexBuffer* m_IB_Cube;
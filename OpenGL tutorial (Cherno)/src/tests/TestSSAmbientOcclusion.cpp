@@ -3,6 +3,8 @@
 #include "Renderer.h"
 #include <tests\TestClearColour.h>
 #include "Globals.h"
+#include "GPUProfiler.h"
+#include "FrameUniforms.h"
 #include <vendor\stb_image\stb_image.h>
 #include <random>
 
@@ -27,8 +29,8 @@ namespace test
 		m_SSAOShader(new Shader("res/shaders/SSAO.shader")),
 		m_BlurShader(new Shader("res/shaders/SSAOBlur.shader")),
 		m_QuadShader(new Shader("res/shaders/SSAOQuad.shader")),
-		m_GroundTexture(new Texture("res/textures/wooden_floor_texture.png")),
-		m_SecondaryTexture(new Texture("res/textures/metal_scratched_texture.png")),
+		m_GroundTexture(TextureCache::Get("res/textures/wooden_floor_texture.png")),
+		m_SecondaryTexture(TextureCache::Get("res/textures/metal_scratched_texture.png")),
 		m_CameraPos(glm::vec3(-4.0f, -7.0f, 7.0f)),
 		m_CameraFront(glm::vec3(0.0f, 0.0f, -1.0f)),
 		m_CameraUp(glm::vec3(0.0f, 1.0f, 0.0f)),
@@ -56,6 +58,9 @@ namespace test
 	{
 		instance = this;
 
+		// Resolve the kernel uniform once, the whole array is then uploaded with a single call each frame
+		m_SamplesHandle = m_SSAOShader->GetUniformHandle("samples");
+
 		// Create vertice positions
 		float groundVertices[] = {
 			//       positions         --     normals    --    tex coords    
@@ -129,9 +134,12 @@ namespace test
 		Renderer renderer;
 		float* clearColour = test::TestClearColour::GetClearColour();
 		float darknessFactor = 2.0f;
+		GPUProfiler* profiler = GPUProfiler::GetInstance();
+		GPUProfileScope testScope("SSAO");
 
 		// Step 1. Geometry pass: Render geometry/colour data into GBuffer
 		// ----------------------------------------------------------------
+		profiler->BeginScope("G-buffer");
 		// Bind manually created framebuffer with the special attachment components that we want to write to
 		m_GBufferSSAO->Bind();
 		GLCall(glClearColor(clearColour[0] / darknessFactor,
@@ -148,64 +156,58 @@ namespace test
 		modelMatrix = glm::scale(modelMatrix, glm::vec3(2.0f));
 		glm::mat4 viewMatrix = m_Camera.GetViewMatrix();
 		glm::mat4 projMatrix = glm::perspective(glm::radians(m_Camera.Zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 200.0f);
-		m_GeometryPassShader->SetMatrix4f("model", modelMatrix);
-		m_GeometryPassShader->SetMatrix4f("view", viewMatrix);
-		m_GeometryPassShader->SetMatrix4f("proj", projMatrix);
-		// Bind ground diffuse texture
+		FrameUniforms::GetInstance()->SetCamera(viewMatrix, projMatrix, m_Camera.Position);
+		// Set the wrap mode of the ground and coffee cup textures (the binds themselves happen when the queue is flushed)
 		m_GroundTexture->BindAndSetRepeating(0);
-		m_GeometryPassShader->SetUniform1i("texture_diffuse0", 0);
-		// Bind ground specular texture
-		m_GroundTexture->BindAndSetRepeating(1); // hack for now -- just using the same texture here
-		m_GeometryPassShader->SetUniform1i("texture_specular0", 1);
-		// Render the ground and side walls
+		m_SecondaryTexture->BindAndSetRepeating(1);
+		// Queue the ground and walls, using the ground texture for both diffuse and specular (hack for now)
+		DrawCommand wallCommand;
+		wallCommand.Pass = PASS_GEOMETRY;
+		wallCommand.AddTexture(0, GL_TEXTURE_2D, m_GroundTexture->GetID(), "texture_diffuse0");
+		wallCommand.AddTexture(1, GL_TEXTURE_2D, m_GroundTexture->GetID(), "texture_specular0");
+		// Ground and side walls
 		for (int i = 0; i < 4; i++)
 		{
 			modelMatrix = glm::rotate(modelMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-			m_GeometryPassShader->SetMatrix4f("model", modelMatrix);
-			renderer.DrawTriangles(*m_VA_Ground, *m_IB_Ground, *m_GeometryPassShader);
+			wallCommand.ModelMatrix = modelMatrix;
+			renderer.Submit(*m_VA_Ground, *m_IB_Ground, *m_GeometryPassShader, wallCommand);
 		}
-		// Render the back wall
+		// Back wall
 		modelMatrix = glm::rotate(modelMatrix, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		m_GeometryPassShader->SetMatrix4f("model", modelMatrix);
-		renderer.DrawTriangles(*m_VA_Ground, *m_IB_Ground, *m_GeometryPassShader);
-		// Render the front wall
+		wallCommand.ModelMatrix = modelMatrix;
+		renderer.Submit(*m_VA_Ground, *m_IB_Ground, *m_GeometryPassShader, wallCommand);
+		// Front wall
 		modelMatrix = glm::rotate(modelMatrix, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		m_GeometryPassShader->SetMatrix4f("model", modelMatrix);
-		renderer.DrawTriangles(*m_VA_Ground, *m_IB_Ground, *m_GeometryPassShader);
-		// Load model's uniforms and render the loaded backpack model twice
-		// Change position of the backpack model
+		wallCommand.ModelMatrix = modelMatrix;
+		renderer.Submit(*m_VA_Ground, *m_IB_Ground, *m_GeometryPassShader, wallCommand);
+		// Queue the backpack model twice, the ground texture stands in for its specular map
 		modelMatrix = glm::mat4(1.0f);
 		glm::vec3 modelPosition = glm::vec3(-4.0f, -9.0f, -3.0f);
 		modelMatrix = glm::translate(modelMatrix, modelPosition);
 		modelMatrix = glm::rotate(modelMatrix, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f)); // lay flat on ground
 		modelMatrix = glm::rotate(modelMatrix, glm::radians(70.0f), glm::vec3(0.0f, 0.0f, 1.0f)); // rotate around y axis
-		m_GeometryPassShader->SetMatrix4f("model", modelMatrix);
-		// Render first backpack
-		m_BackpackModel->Draw(m_GeometryPassShader);
+		m_BackpackModel->Submit(renderer, m_GeometryPassShader, modelMatrix, PASS_GEOMETRY, glm::length(modelPosition - m_Camera.Position), m_GroundTexture->GetID());
 		// Change position of the backpack model
 		modelMatrix = glm::mat4(1.0f);
 		modelPosition = glm::vec3(5.0f, -9.0f, 6.0f);
 		modelMatrix = glm::translate(modelMatrix, modelPosition);
 		modelMatrix = glm::rotate(modelMatrix, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f)); // lay flat on ground
 		modelMatrix = glm::rotate(modelMatrix, glm::radians(-45.0f), glm::vec3(0.0f, 0.0f, 1.0f)); // rotate around y axis
-		m_GeometryPassShader->SetMatrix4f("model", modelMatrix);
-		// Render second backpack
-		m_BackpackModel->Draw(m_GeometryPassShader);
-		// Load model's uniforms and render the loaded coffee cup model
+		m_BackpackModel->Submit(renderer, m_GeometryPassShader, modelMatrix, PASS_GEOMETRY, glm::length(modelPosition - m_Camera.Position), m_GroundTexture->GetID());
+		// Queue the coffee cup model with the secondary texture as its diffuse
 		modelMatrix = glm::mat4(1.0f);
 		modelPosition = glm::vec3(5.0f, -10.1f, -6.0f);
 		modelMatrix = glm::translate(modelMatrix, modelPosition);
 		modelMatrix = glm::scale(modelMatrix, glm::vec3(26.0f));
-		m_GeometryPassShader->SetMatrix4f("model", modelMatrix);
-		// Bind coffee cup diffuse texture
-		m_SecondaryTexture->BindAndSetRepeating(0);
-		m_GeometryPassShader->SetUniform1i("texture_diffuse0", 0);
-		// Render coffee cup
-		m_TeacupModel->Draw(m_GeometryPassShader);
+		m_TeacupModel->Submit(renderer, m_GeometryPassShader, modelMatrix, PASS_GEOMETRY, glm::length(modelPosition - m_Camera.Position), m_SecondaryTexture->GetID());
+		// Sort by program, material and depth, then draw everything into the GBuffer
+		renderer.Flush();
 		// At this point, the GBuffer has been filled with all necessary information for SSAO (Screen-Space Ambient Occlusion)
+		profiler->EndScope(); // G-buffer
 
 		// Step 2. Generate SSAO texture using GBuffer data
 		// ------------------------------------------------
+		profiler->BeginScope("SSAO generation");
 		// Next render the scene to the SSAO framebuffer 
 		m_SSAOFramebuffer->Bind();
 		// Clear depth buffer and colour buffer attachments
@@ -218,18 +220,17 @@ namespace test
 		m_SSAOShader->Bind();
 		// m_SSAOShader->SetVec3("viewPos", m_Camera.Position); // don't need because viewPos is origin of viewing coords
 		// Bind all three GBuffer attachments to the sampler2D uniforms
-		GLCall(glActiveTexture(GL_TEXTURE0));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_PositionGBuffer));
+		GLStateCache::ActiveTexture(GL_TEXTURE0);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_PositionGBuffer);
 		m_SSAOShader->SetInt("gPosition", 0);
-		GLCall(glActiveTexture(GL_TEXTURE1));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_NormalGBuffer));
+		GLStateCache::ActiveTexture(GL_TEXTURE1);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_NormalGBuffer);
 		m_SSAOShader->SetInt("gNormal", 1);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, m_NoiseTextureID);
+		GLStateCache::ActiveTexture(GL_TEXTURE2);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_NoiseTextureID);
 		m_SSAOShader->SetInt("texNoise", 2);		
 		// Pass SSAO kernel and noise (random rotation) textures to the SSAO shader
-		for (unsigned int i = 0; i < m_MaxSamples; ++i)
-			m_SSAOShader->SetVec3("samples[" + std::to_string(i) + "]", m_SSAOKernel[i]);
+		m_SSAOShader->SetVec3Array(m_SamplesHandle, m_SSAOKernel.data(), m_MaxSamples);
 		m_SSAOShader->SetMatrix4f("projMatrix", projMatrix);
 		m_SSAOShader->SetInt("u_Screen_Width", SCREEN_WIDTH);
 		m_SSAOShader->SetInt("u_Screen_Height", SCREEN_HEIGHT);
@@ -241,24 +242,28 @@ namespace test
 		renderer.DrawTriangles(*m_VA_Quad, *m_IB_Quad, *m_SSAOShader);
 		m_SSAOFramebuffer->Unbind();
 		// At this point, the m_SSAOColourBuffer should be filled with the noisy ambient occlusion
+		profiler->EndScope(); // SSAO generation
 
 		// Step 3. Blur the created SSAO texture to remove noise
 		// ------------------------------------------------------
+		profiler->BeginScope("Blur");
 		m_SSAOBlurFramebuffer->Bind();
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		m_BlurShader->Bind();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_SSAOColourBuffer);
+		GLStateCache::ActiveTexture(GL_TEXTURE0);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_SSAOColourBuffer);
 		m_BlurShader->SetInt("ssaoTexture", 0);
 		// Draw call for blurring effect shader
 		renderer.DrawTriangles(*m_VA_Quad, *m_IB_Quad, *m_BlurShader);
 		m_SSAOBlurFramebuffer->Unbind();
 		// At this point, the m_SSAOBlurColourBuffer should have the completed SS ambient occlusion texture which we can use in the final lighting step
+		profiler->EndScope(); // Blur
 
 		// Step 4. Lighting pass: Deferred Blinn-Phong lighting using the SSAO texture from m_SSAOBlurColourBuffer
 		// -------------------------------------------------------------------------------------------------------
+		profiler->BeginScope("Lighting");
 		// Rebind default framebuffer
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		m_QuadShader->Bind();
 		// Set properties for all pointlights
@@ -272,24 +277,25 @@ namespace test
 			m_QuadShader->SetFloat("pointLights[" + std::to_string(i) + "].Linear", linearAttenuation);
 			m_QuadShader->SetFloat("pointLights[" + std::to_string(i) + "].Quadratic", quadraticAttenuation);
 		}
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_PositionGBuffer);
+		GLStateCache::ActiveTexture(GL_TEXTURE0);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_PositionGBuffer);
 		m_QuadShader->SetInt("gPosition", 0);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, m_NormalGBuffer);
+		GLStateCache::ActiveTexture(GL_TEXTURE1);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_NormalGBuffer);
 		m_QuadShader->SetInt("gNormal", 1);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, m_AlbedoSpecGBuffer);
+		GLStateCache::ActiveTexture(GL_TEXTURE2);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_AlbedoSpecGBuffer);
 		m_QuadShader->SetInt("gAlbedoSpec", 2);
-		glActiveTexture(GL_TEXTURE3); // pass completed SSAO texture to lighting shader
-		glBindTexture(GL_TEXTURE_2D, m_SSAOBlurColourBuffer);
-		//glBindTexture(GL_TEXTURE_2D, m_SSAOColourBuffer); // testing
+		GLStateCache::ActiveTexture(GL_TEXTURE3); // pass completed SSAO texture to lighting shader
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_SSAOBlurColourBuffer);
+		//GLStateCache::BindTexture(GL_TEXTURE_2D, m_SSAOColourBuffer); // testing
 		m_QuadShader->SetInt("ssaoTexture", 3);
 		// Pass clear colour as ambient colour
 		m_QuadShader->SetVec3f("clearColour", clearColour[0], clearColour[1], clearColour[2]);
 		m_QuadShader->SetBool("u_OnlyAO", m_AmbientOcclusionMode);
 		m_QuadShader->SetBool("u_UsingLighting", m_UsingLighting);
 		renderer.DrawTriangles(*m_VA_Quad, *m_IB_Quad, *m_QuadShader);
+		profiler->EndScope(); // Lighting
 	}
 
 	void TestSSAO::OnImGuiRender()
@@ -305,6 +311,9 @@ namespace test
 		ImGui::Text("- Use scroll wheel to change FOV");
 		ImGui::Text("- Press '1' and '2' to toggle wireframe mode");
 		ImGui::Text("- Avg %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+		const DrawQueueStats& drawStats = Renderer::GetLastFlushStats();
+		ImGui::Text("- %u queued draws, %u program and %u material changes", drawStats.Commands, drawStats.ProgramChanges, drawStats.MaterialChanges);
+		GPUProfiler::GetInstance()->OnImGuiRender();
 	}
 
 	void TestSSAO::OnActivated()
@@ -314,10 +323,10 @@ namespace test
 		{
 			// Flip texture along y axis before loading
 			stbi_set_flip_vertically_on_load(true);
-			m_BackpackModel = new Model((char*)"res/models/backpack/backpack.obj");
+			m_BackpackModel = new Model((char*)"res/models/backpack/backpack.obj", false); // Only drawn, so no CPU geometry
 			//m_Model = new Model((char*)"res/models/donut tutorial/donut_icing.obj");
 			//m_Model = new Model((char*)"res/models/donut tutorial/coffee_cup.obj");
-			m_TeacupModel = new Model((char*)"res/models/donut tutorial/coffee_cup.obj");
+			m_TeacupModel = new Model((char*)"res/models/donut tutorial/coffee_cup.obj", false);
 			modelsLoaded = true;
 		}
 
@@ -346,7 +355,7 @@ namespace test
 		m_GBufferSSAO->Bind();
 		// Position 'colour' buffer
 		glGenTextures(1, &m_PositionGBuffer);
-		glBindTexture(GL_TEXTURE_2D, m_PositionGBuffer);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_PositionGBuffer);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -355,14 +364,14 @@ namespace test
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_PositionGBuffer, 0);
 		// Normal 'colour' buffer
 		glGenTextures(1, &m_NormalGBuffer);
-		glBindTexture(GL_TEXTURE_2D, m_NormalGBuffer);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_NormalGBuffer);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_NormalGBuffer, 0);
 		// Albedo + Specular 'colour' buffer
 		glGenTextures(1, &m_AlbedoSpecGBuffer);
-		glBindTexture(GL_TEXTURE_2D, m_AlbedoSpecGBuffer);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_AlbedoSpecGBuffer);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -389,7 +398,7 @@ namespace test
 		// SSAO framebuffer
 		m_SSAOFramebuffer->Bind();
 		glGenTextures(1, &m_SSAOColourBuffer);
-		glBindTexture(GL_TEXTURE_2D, m_SSAOColourBuffer);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_SSAOColourBuffer);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RED, GL_FLOAT, NULL); // just a single float per window pixel
 		//glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL); // Testing
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -408,7 +417,7 @@ namespace test
 		// SSAO blurring stage framebuffer
 		m_SSAOBlurFramebuffer->Bind();
 		glGenTextures(1, &m_SSAOBlurColourBuffer);
-		glBindTexture(GL_TEXTURE_2D, m_SSAOBlurColourBuffer);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_SSAOBlurColourBuffer);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RED, GL_FLOAT, NULL); // just a single float per window pixel
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -424,7 +433,7 @@ namespace test
 		}
 
 		// Rebind default framebuffer
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 		// Ambient Occlusion hemisphere sampling kernel setup
 		std::uniform_real_distribution<float> randomFloats(0.0, 1.0); // random floats between [0.0, 1.0]
@@ -454,7 +463,7 @@ namespace test
 		}
 		// Generate repeating 4x4 texture of above noise kernel rotations
 		glGenTextures(1, &m_NoiseTextureID);
-		glBindTexture(GL_TEXTURE_2D, m_NoiseTextureID);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_NoiseTextureID);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 4, 4, 0, GL_RGB, GL_FLOAT, &ssaoNoise[0]);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -465,18 +474,18 @@ namespace test
 		glfwSetInputMode(m_MainWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 		// Enable face culling
-		glEnable(GL_CULL_FACE);
-		glCullFace(GL_BACK); // cull back faces
+		GLStateCache::Enable(GL_CULL_FACE);
+		GLStateCache::CullFace(GL_BACK); // cull back faces
 		glFrontFace(GL_CCW); // tell OpenGL that front faces have CCW winding order
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		//GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-		GLCall(glBlendFunc(GL_ONE, GL_ZERO));
+		GLStateCache::Enable(GL_BLEND);
+		//GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		GLStateCache::BlendFunc(GL_ONE, GL_ZERO);
 
 		// Reset all callbacks
 		// Callback function for keyboard inputs
@@ -490,12 +499,12 @@ namespace test
 		glfwSetMouseButtonCallback(m_MainWindow, mouse_button_callbackSSAO);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_ONE, GL_ZERO));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_ONE, GL_ZERO);
 	}
 
 	void TestSSAO::ToggleAOMode(const bool flag)
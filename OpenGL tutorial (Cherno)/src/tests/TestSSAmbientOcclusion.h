@@ -11,6 +11,7 @@
 #include "FrameBuffer.h"
 #include "Model.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
 
 namespace test
@@ -33,8 +34,8 @@ namespace test
 		Shader* m_SSAOShader;
 		Shader* m_BlurShader;
 		Shader* m_QuadShader;
-		Texture* m_GroundTexture;
-		Texture* m_SecondaryTexture;
+		std::shared_ptr<Texture> m_GroundTexture;
+		std::shared_ptr<Texture> m_SecondaryTexture;
 		glm::vec3 m_CameraPos;
 		glm::vec3 m_CameraFront;
 		glm::vec3 m_CameraUp;
@@ -53,6 +54,7 @@ namespace test
 		unsigned int m_MaxSamples;
 		unsigned int m_NoiseTextureID;
 		std::vector<glm::vec3> m_SSAOKernel;
+		UniformHandle m_SamplesHandle;
 		bool m_AmbientOcclusionMode;
 		bool m_UsingLighting;
 		// Point lights parameters
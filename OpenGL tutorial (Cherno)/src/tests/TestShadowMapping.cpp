@@ -21,8 +21,8 @@ namespace test
 		m_Camera(Camera(m_CameraPos, 75.0f)),
 		m_Shader(new Shader("res/shaders/BasicShadowMapping.shader")),
 		m_ShadowDepthMapShader(new Shader("res/shaders/ShadowMapping.shader")),
-		m_CubeTexture(new Texture("res/textures/metal_border_container_texture.png", false)), // TODO
-		m_GroundTexture(new Texture("res/textures/wooden_floor_texture.png", false)),
+		m_CubeTexture(TextureCache::Get("res/textures/metal_border_container_texture.png", false)), // TODO
+		m_GroundTexture(TextureCache::Get("res/textures/wooden_floor_texture.png", false)),
 		m_VA_Cube(new VertexArray()),
 		m_VA_Ground(new VertexArray()),
 		// Flashlight properties
@@ -176,10 +176,10 @@ namespace test
 		//
 		// Bind shadow map framebuffer
 		glViewport(0, 0, m_ShadowMapWidth, m_ShadowMapHeight);
-		glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
 		glClear(GL_DEPTH_BUFFER_BIT);
 		// Cull front faces while filling the shadow depth buffer to avoid Peter Panning of shadows
-		glCullFace(GL_FRONT);
+		GLStateCache::CullFace(GL_FRONT);
 		// Configure matrices and shader
 		m_ShadowDepthMapShader->Bind();
 		float near_plane = 0.1f, far_plane = 400.0f;
@@ -218,17 +218,17 @@ namespace test
 		// Then pass the orthographic shadow depth map to the other shader
 		m_Shader->Bind();
 		// Bind shadow depth map texture to shader
-		GLCall(glActiveTexture(GL_TEXTURE3));
-		GLCall(glBindTexture(GL_TEXTURE_2D, m_ShadowDepthMap));
+		GLStateCache::ActiveTexture(GL_TEXTURE3);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_ShadowDepthMap);
 		m_Shader->SetInt("shadowMapOrthographic", 3);
 
 		// Then return to the default framebuffer and render the scene as normal, using the depth map to create shadows
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 		glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT); 
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		// Return to culling back faces
-		glCullFace(GL_BACK);
+		GLStateCache::CullFace(GL_BACK);
 
 		// Set per-frame uniforms
 		m_Shader->Bind();
@@ -314,7 +314,7 @@ namespace test
 		glGenFramebuffers(1, &m_DepthMapFBO);
 		// 2D buffer for storing depth values
 		glGenTextures(1, &m_ShadowDepthMap);
-		glBindTexture(GL_TEXTURE_2D, m_ShadowDepthMap);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_ShadowDepthMap);
 		// We only need the depth information when rendering the scene from the light's perspective, so no need for a colour or stencil buffer
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, m_ShadowMapWidth, m_ShadowMapHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -324,21 +324,21 @@ namespace test
 		float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
 		glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
 		// Attach the shadow map buffer to the framebuffer
-		glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_ShadowDepthMap, 0);
 		//A framebuffer is not 'complete' without a colour buffer so we need to explicitly set OpenGL to not render any colour data
 		glDrawBuffer(GL_NONE);
 		glReadBuffer(GL_NONE);
 		// Reset to default framebuffer
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// Reset all callbacks
 		// Callback function for mouse cursor movement
@@ -20,7 +20,7 @@ namespace test
 		m_CameraPos(glm::vec3(0.0f, 0.0f, 3.0f)),
 		m_Camera(Camera(m_CameraPos, 75.0f)),
 		m_Shader(new Shader("res/shaders/Basic.shader")),
-		m_CubeTexture(new Texture("res/textures/metal_border_container_texture.png")),
+		m_CubeTexture(TextureCache::Get("res/textures/metal_border_container_texture.png")),
 		m_VA_Cube(new VertexArray())
 	{
 		instance = this;
@@ -160,12 +160,12 @@ namespace test
 		glfwSetMouseButtonCallback(m_MainWindow, mouse_button_callbackTemplate);
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	}
 
 	void scroll_callbackTemplate(GLFWwindow* window, double xOffset, double yOffset)
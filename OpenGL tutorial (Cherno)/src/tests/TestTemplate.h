@@ -9,6 +9,7 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 #include "Camera.h"
 
 namespace test
@@ -21,7 +22,7 @@ namespace test
 		glm::vec3 m_CameraPos;
 		Camera m_Camera;
 		Shader* m_Shader;
-		Texture* m_CubeTexture;
+		std::shared_ptr<Texture> m_CubeTexture;
 		VertexArray* m_VA_Cube;
 		VertexBuffer* m_VB_Cube;
 		IndexBuffer* m_IB_Cube;
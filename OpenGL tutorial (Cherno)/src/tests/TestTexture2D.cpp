@@ -86,8 +86,8 @@ namespace test
 		m_Shader = std::make_unique<Shader>("res/shaders/Basic.shader");
 
 		// Load/create textures
-		m_Textures[0] = std::make_unique<Texture>("res/textures/tree_render_texture.png");
-		m_Textures[1] = std::make_unique<Texture>("res/textures/tree_render_texture2.png");
+		m_Textures[0] = TextureCache::Get("res/textures/tree_render_texture.png");
+		m_Textures[1] = TextureCache::Get("res/textures/tree_render_texture2.png");
 		
 		// Bind shader program and set uniforms
 		m_Shader->Bind();
@@ -181,12 +181,12 @@ namespace test
 		}
 
 		// Enable OpenGL z-buffer depth comparisons
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::Enable(GL_DEPTH_TEST);
 		// Render only those fragments with lower depth values
-		glDepthFunc(GL_LESS);
+		GLStateCache::DepthFunc(GL_LESS);
 		// Enable blending
-		GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLStateCache::Enable(GL_BLEND);
+		GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	}
 }
 
@@ -8,6 +8,7 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "TextureCache.h"
 
 #include <memory>
 
@@ -21,7 +22,7 @@ namespace test
 		std::unique_ptr<VertexBuffer> m_VB;
 		std::unique_ptr<IndexBuffer> m_IB;
 		std::unique_ptr<Shader> m_Shader;
-		std::unique_ptr<Texture> m_Textures[2];
+		std::shared_ptr<Texture> m_Textures[2];
 		int m_ActiveTexture;
 		glm::vec3 m_ModelTranslation;
 		float m_ModelRotationX, m_ModelRotationY, m_ModelRotationZ, m_ModelScale;